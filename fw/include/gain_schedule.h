@@ -0,0 +1,29 @@
+/**
+ * @file gain_schedule.h
+ * @brief Input voltage loop PI gain schedule, see sw/design_procedures/gain_schedule.py.
+ * @note Generated by sw/design_procedures. Do not edit by hand.
+ */
+#ifndef GAIN_SCHEDULE_H
+#define GAIN_SCHEDULE_H
+
+#include <stdint.h>
+
+#define GAIN_SCHEDULE_N_IN       (4)              /* V_IN breakpoints */
+#define GAIN_SCHEDULE_N_OUT      (3)              /* V_OUT breakpoints */
+#define GAIN_SCHEDULE_BASE_IN    (705)            /* ADC counts, first V_IN */
+#define GAIN_SCHEDULE_BASE_OUT   (2321)           /* ADC counts, first V_OUT */
+#define GAIN_SCHEDULE_SHIFT_IN   (10)             /* log2 V_IN spacing */
+#define GAIN_SCHEDULE_SHIFT_OUT  (10)             /* log2 V_OUT spacing */
+#define GAIN_SCHEDULE_FRAC       (21)             /* Q-format of B = B0 = B1 */
+#define GAIN_SCHEDULE_INTEG_BITS (32)             /* Integrator word length */
+#define GAIN_SCHEDULE_PWM_PERIOD (769)            /* Timer counts per period */
+#define GAIN_SCHEDULE_F_C        (46.7182634f)    /* Hz, target crossover */
+
+static const int16_t GAIN_SCHEDULE_B[4][3] = {
+    {-1305, -906, -888},
+    {-1305, -906, -888},
+    {-1307, -907, -889},
+    {-1317, -913, -894}
+};
+
+#endif /* GAIN_SCHEDULE_H */
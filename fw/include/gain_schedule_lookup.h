@@ -0,0 +1,53 @@
+/**
+ * @file gain_schedule_lookup.h
+ * @brief Branch free lookup of the input voltage loop gain schedule in
+ *        gain_schedule.h. Mirrored bit exactly by lookup_gain_schedule in
+ *        sw/design_procedures/gain_schedule.py.
+ */
+#ifndef GAIN_SCHEDULE_LOOKUP_H
+#define GAIN_SCHEDULE_LOOKUP_H
+
+#include <stdint.h>
+
+#include "gain_schedule.h"
+
+/* The interpolation rounds a signed product down with >>, which C leaves
+ * implementation defined for negative values. */
+_Static_assert((-3 >> 1) == -2, "arithmetic right shift required");
+
+static inline int32_t gain_schedule_clamp(int32_t x, int32_t lo, int32_t hi)
+{
+    x = x < lo ? lo : x;
+    return x > hi ? hi : x;
+}
+
+static inline int32_t gain_schedule_interp(
+    const int16_t table[][GAIN_SCHEDULE_N_OUT], int32_t i, int32_t j, int32_t fx, int32_t fy)
+{
+    const int32_t sx = 1 << GAIN_SCHEDULE_SHIFT_IN;
+    const int32_t sy = 1 << GAIN_SCHEDULE_SHIFT_OUT;
+    int32_t c0 = (table[i][j] * (sx - fx) + table[i + 1][j] * fx) >> GAIN_SCHEDULE_SHIFT_IN;
+    int32_t c1 = (table[i][j + 1] * (sx - fx) + table[i + 1][j + 1] * fx) >> GAIN_SCHEDULE_SHIFT_IN;
+    return (c0 * (sy - fy) + c1 * fy) >> GAIN_SCHEDULE_SHIFT_OUT;
+}
+
+/**
+ * @brief Get the PI coefficient B = B0 = B1 (Q GAIN_SCHEDULE_FRAC) at the
+ *        measured V_IN and V_OUT (ADC counts). Outside the table the edge
+ *        values hold.
+ */
+static inline int32_t gain_schedule_lookup(int32_t adc_v_in, int32_t adc_v_out)
+{
+    /* Saturate before shifting so the cell index is never negative. */
+    int32_t x = gain_schedule_clamp(
+        adc_v_in - GAIN_SCHEDULE_BASE_IN, 0, (GAIN_SCHEDULE_N_IN - 1) << GAIN_SCHEDULE_SHIFT_IN);
+    int32_t y = gain_schedule_clamp(
+        adc_v_out - GAIN_SCHEDULE_BASE_OUT, 0, (GAIN_SCHEDULE_N_OUT - 1) << GAIN_SCHEDULE_SHIFT_OUT);
+    int32_t i = gain_schedule_clamp(x >> GAIN_SCHEDULE_SHIFT_IN, 0, GAIN_SCHEDULE_N_IN - 2);
+    int32_t j = gain_schedule_clamp(y >> GAIN_SCHEDULE_SHIFT_OUT, 0, GAIN_SCHEDULE_N_OUT - 2);
+    int32_t fx = x - (i << GAIN_SCHEDULE_SHIFT_IN);
+    int32_t fy = y - (j << GAIN_SCHEDULE_SHIFT_OUT);
+    return gain_schedule_interp(GAIN_SCHEDULE_B, i, j, fx, fy);
+}
+
+#endif /* GAIN_SCHEDULE_LOOKUP_H */
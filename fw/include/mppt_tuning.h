@@ -0,0 +1,17 @@
+/**
+ * @file mppt_tuning.h
+ * @brief Perturb and observe tracker parameters, see sw/design_procedures/mppt_tuning.py.
+ * @note Generated by sw/design_procedures. Do not edit by hand.
+ */
+#ifndef MPPT_TUNING_H
+#define MPPT_TUNING_H
+
+#define MPPT_STEP         (0.725f)         /* V, base V_IN reference step */
+#define MPPT_PERIOD       (0.01f)          /* s, perturbation period */
+#define MPPT_AVG_FRACTION (0.25f)          /* Fraction of the period averaged */
+#define MPPT_ADAPT_GAIN   (0.0f)           /* V, adaptive step at full slope */
+#define MPPT_I_NORM       (5.84f)          /* A, dP/dV of a full slope */
+#define MPPT_V_REF_MIN    (20.0069137f)    /* V, lowest V_IN reference */
+#define MPPT_V_REF_MAX    (80.0276548f)    /* V, highest V_IN reference */
+
+#endif /* MPPT_TUNING_H */
@@ -0,0 +1,13 @@
+/**
+ * @file soft_start.h
+ * @brief Soft-start duty ramp, see sw/design_procedures/startup_analysis.py.
+ * @note Generated by sw/design_procedures. Do not edit by hand.
+ */
+#ifndef SOFT_START_H
+#define SOFT_START_H
+
+#define SOFT_START_RAMP_RATE (100.0f)         /* Duty cycle per second */
+#define SOFT_START_D_MAX     (0.9f)           /* Maximum duty cycle */
+#define SOFT_START_DELAY     (0.0037f)        /* s, after contactor close */
+
+#endif /* SOFT_START_H */
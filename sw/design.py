@@ -32,18 +32,24 @@
 """
 
 import argparse
+import math as m
 import sys
 
 import matplotlib.pyplot as plt
+from design_procedures.gate_driver_design import (get_aux_rail_losses,
+                                                  get_bootstrap_sizing,
+                                                  get_gate_drive_losses)
 from design_procedures.nonideal_model import model_nonideal_cell
-from design_procedures.passives_design import (get_inductor_core_loss,
+from design_procedures.passives_design import (get_core_loss_density,
+                                               get_inductor_core_loss,
                                                get_inductor_sizing,
                                                get_passive_sizing)
 from design_procedures.switch_design import (get_switch_duty_cycle_map,
                                              get_switch_op_fs,
                                              get_switch_op_fs_map,
                                              get_switch_requirements)
-from design_procedures.thermal_design import get_switch_thermals
+from design_procedures.thermal_design import (get_heatsink_search,
+                                              get_switch_thermals)
 
 SKIP_FOM_SEARCH = True
 SKIP_THERMAL_SEARCH = False
@@ -258,10 +264,30 @@ if __name__ == "__main__":
         print(f"Determine thermal parameters:")
         t_amb = 60
         t_max = 100
+        v_air = 0.0  # Parked, no airflow over the board
+        orientation = "horizontal_up"
         r_jb = float(input("R_JB (C/W): "))
         r_jc = float(input("R_JC (C/W): "))
-        area_hs = float(input("Area of heatsink (mm^2): ")) * 1e-6
-        r_sa = float(input("R_SA (C/W): "))
+
+        # Search the heatsink catalogue instead of picking a part by hand.
+        heatsinks = get_heatsink_search(
+            t_amb, t_max, p_sw_bud, r_jb, r_jc, 250, v_air, orientation
+        )
+        print(f"\nHeatsinks at {v_air :.1f} m/s, {orientation}:")
+        for hs in heatsinks:
+            print(
+                f"\t{hs['name']:<20} R_SA {hs['r_sa'] :6.1f} C/W, "
+                f"copper {hs['area'] * 1e6 :8.1f} mm^2"
+            )
+        # Infeasible parts (area NaN) sort last, so a NaN first means none fit.
+        if m.isnan(heatsinks[0]["area"]):
+            raise Exception(
+                f"No heatsink holds the switch at {t_max} C from {t_amb} C with "
+                f"{p_sw_bud :.3f} W; raise the loss budget or add airflow."
+            )
+        area_hs = heatsinks[0]["area_hs"]
+        r_sa = heatsinks[0]["r_sa"]
+        print(f"Selected {heatsinks[0]['name']}.")
 
         print(f"Displaying thermal area budget.\n")
         therm_area = get_switch_thermals(
@@ -273,6 +299,25 @@ if __name__ == "__main__":
             f"{t_max} C: {therm_area * 10000 :.3f} cm^2 ({therm_area * 1000000 :.3f} mm^2)."
         )
 
+    # Step 3c. The gate driver and the auxiliary rails run from the +12V bus,
+    # outside the power path, but still count against the loss budget.
+    print(f"----------------------------------------")
+    print(f"STEP 3C")
+    print(f"Determine gate drive and auxiliary supply losses:")
+    q_g = float(input("Q_G (nC): ")) * 10**-9
+
+    gate_loss = get_gate_drive_losses({"q_g": q_g}, f_sw)
+    rails = get_aux_rail_losses(i_extra={"12v": gate_loss["i_in"]})
+    duty_min = max(1 - v_in_range[2] / v_out_range[0], 0)
+    boot = get_bootstrap_sizing({"q_g": q_g}, f_sw, duty_min)
+    print(
+        f"Gate drive loss: {gate_loss['total'] :.3f} W"
+        f"\nAuxiliary rails, gate drive included: {rails['p_bus'] :.3f} W "
+        f"({rails['p_bus'] / p_loss * 100 :.1f} % of the budget)"
+        f"\nBootstrap: {boot['v_min'] :.3f} V minimum, "
+        f"C_BOOT >= {boot['c_min'] * 1E9 :.3f} nF"
+    )
+
     # Step 4. Generate a duty cycle map.
     print(f"----------------------------------------")
     print(f"STEP 4")
@@ -288,7 +333,16 @@ if __name__ == "__main__":
     print(f"STEP 5")
     print(f"Deriving capacitor requirements:")
 
-    (ci_min, co_min, l_min, ci_vdc_min, co_vdc_min, l_a_min) = get_passive_sizing(
+    (
+        ci_min,
+        co_min,
+        l_min,
+        ci_vdc_min,
+        co_vdc_min,
+        l_a_min,
+        ci_rms_min,
+        co_rms_min,
+    ) = get_passive_sizing(
         v_in_range,
         v_out_range,
         f_sw,
@@ -305,9 +359,11 @@ if __name__ == "__main__":
         f"\nExpected requirements for input capacitor:"
         f"\n\tC\t>= {ci_min * 1E6:.3f} uF"
         f"\n\tV\t>= {ci_vdc_min :.3f} V"
+        f"\n\tI_RMS\t>= {ci_rms_min :.3f} A"
         f"\nExpected requirements for output capacitor:"
         f"\n\tC\t>= {co_min * 1E6:.3f} uF"
         f"\n\tV\t>= {co_vdc_min :.3f} V"
+        f"\n\tI_RMS\t>= {co_rms_min :.3f} A"
         f"\nExpected requirements for inductor:"
         f"\n\tL\t>= {l_min * 1E6:.3f} uH"
         f"\n\tI\t>= {l_a_min :.3f} A"
@@ -334,8 +390,15 @@ if __name__ == "__main__":
         f"\nConduction loss: {p_cond :.3f} W"
     )
 
-    print(f"\nUsing TDK N97 material datasheet, choose a P_V given F_SW, B_AC.")
-    p_v = float(input("P_V (kW/m^3): "))
+    p_v = get_core_loss_density(f_sw, b_ac)
+    print(
+        f"\nCalibrated core loss model: {p_v :.3f} kW/m^3 at F_SW, B_AC."
+        f"\nTo override it, choose a P_V given F_SW, B_AC from the TDK N97"
+        f" material datasheet, or press enter to keep it."
+    )
+    p_v_override = input("P_V (kW/m^3): ")
+    if p_v_override.strip():
+        p_v = float(p_v_override)
 
     p_core = get_inductor_core_loss(p_v)
     print(f"\nCore loss: {p_core :.3f} W")
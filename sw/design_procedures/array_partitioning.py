@@ -0,0 +1,516 @@
+"""_summary_
+@file       array_partitioning.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      How many MPPTs per array: split the series string into K
+            sub-strings, each with its own boost converter to the battery.
+
+            For every K the converter is resized through the design flow of
+            design.py for a sub-string of ceil(N / K) cells:
+            - the input range from the cells per sub-string,
+            - the switch requirements and the highest switching frequency
+              that keeps the switch losses within budget over the V_IN x V_OUT
+              map (get_switch_losses_batch, linear in F_SW). The sub-strings
+              carry the full string current, so the switch keeps the absolute
+              per switch budget of the single converter (the same part and
+              thermal design) rather than a share of the smaller power,
+            - the passives (get_passive_sizing) at that frequency.
+
+            The array is then evaluated under the shading and mismatch
+            scenarios. A sub-string is a series string with a bypass diode
+            across each cluster of cells; its P-I curve is swept on a current
+            grid with the cell voltage of the single diode model (the shunt
+            resistance only in reverse bias), and two trackers are reported:
+            the global maximum, and the first local maximum reached from open
+            circuit, where a perturb and observe tracker settles. The
+            converter losses at the operating point of every sub-string come
+            from component_stress: switch conduction and switching, inductor
+            DCR, capacitor ESR, and the gate drive and auxiliary rails of
+            every converter (gate_driver_design).
+
+            Every (K, scenario) pair is independent and evaluated in a
+            process pool.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import concurrent.futures
+import math as m
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.cell_temperature import get_air_speed, get_cell_temperature
+from design_procedures.converter_model import (
+    default_boost_design,
+    default_cell,
+    default_design_criteria,
+    default_v_out_range,
+)
+from design_procedures.loss_calibration import get_loss_breakdown
+from design_procedures.nonideal_model import (
+    k_b,
+    model_nonideal_cell,
+    model_nonideal_cell_vec,
+    q,
+)
+from design_procedures.passives_design import get_inductor_sizing, get_passive_sizing
+from design_procedures.shading_model import (
+    get_cell_irradiance,
+    get_clear_sky_components,
+    get_example_route,
+    get_example_vehicle,
+)
+from design_procedures.solar_position import (
+    get_extraterrestrial,
+    get_poa_irradiance,
+    get_solar_position,
+    get_world_normals,
+)
+from design_procedures.switch_design import (
+    get_switch_losses_batch,
+    get_switch_requirements,
+)
+from design_procedures.transient_analysis import r_byp, r_sh, v_byp
+
+partition_range = [1, 2, 3, 4, 6]  # Sub-strings per array
+cells_per_bypass = 12  # Cells per bypass diode cluster
+num_points = 128  # Current grid of the sub-string P-I sweep
+mismatch = 0.015  # 1 sigma of the cell to cell I_SC spread
+b_sat = 0.41  # T, TDK N97 at 100 C
+v_bat = 105.0  # V, battery during the scenarios
+
+# Rough low volume cost, in USD.
+cost_fixed = 30.0  # Board, controller, sensing, connectors per converter
+cost_switch = 5.5  # Per EPC2307
+cost_inductor = (2.0, 1.5)  # Base, and per mJ of 1/2 L I_PK^2
+cost_capacitor = (0.5, 10.0)  # Base, and per J of 1/2 C V^2
+
+
+def get_partition_design(num_cells, p_sw_bud=None, f_grid=35):
+    """_summary_
+    Resize the converter for a sub-string through the design.py flow.
+
+    Args:
+        num_cells (int): Cells in the sub-string
+        p_sw_bud (float, optional): Switch loss budget (W). Defaults to the
+            share of the sub-string power of design.py.
+        f_grid (int, optional): Points per axis of the V_IN x V_OUT map.
+            Defaults to 35.
+
+    Returns:
+        dict: Input range, switch requirements, F_SW, passives, and the loss
+            model parameters (l, r_dcr, n_l, c_i, r_ci, c_o, r_co, r_ds_on,
+            c_oss)
+            and cost (USD).
+    """
+    v_oc, i_sc, v_mpp, i_mpp = (
+        default_cell[key] for key in ("v_oc", "i_sc", "v_mpp", "i_mpp")
+    )
+    le_top_pct, ue_top_pct, r_co_v, r_l_a, sf, eff, sw_1_p_dist = (
+        default_design_criteria[key]
+        for key in (
+            "le_top_pct",
+            "ue_top_pct",
+            "r_co_v",
+            "r_l_a",
+            "sf",
+            "eff",
+            "sw_1_p_dist",
+        )
+    )
+    v_out_range = default_v_out_range
+    v_in_range = [
+        num_cells * v_mpp * (1 - le_top_pct),
+        num_cells * v_mpp,
+        num_cells * v_mpp + (v_oc - v_mpp) * ue_top_pct * num_cells,
+    ]
+    p_transfer = v_in_range[1] * i_mpp
+    v_ds_min, i_ds_min, p_sw_min, p_sw_share = get_switch_requirements(
+        v_out_range[2], i_sc, p_transfer, sf=sf, eff_dist=sw_1_p_dist * (1 - eff)
+    )
+    p_sw_bud = p_sw_share if p_sw_bud is None else p_sw_bud
+
+    # The switch losses are linear in F_SW for a fixed relative ripple.
+    design = default_boost_design
+    r_l = r_l_a / i_sc / 2
+    v_in, v_out = np.meshgrid(
+        np.linspace(v_in_range[0], v_in_range[2], f_grid),
+        np.linspace(v_out_range[0], v_out_range[2], f_grid),
+    )
+    i_in = model_nonideal_cell_vec(1000, 298.15, 0, r_sh, v_in / num_cells)[0]
+    _, _, p_0, _ = get_switch_losses_batch(
+        v_in, i_in, v_out, 0.0, design["r_ds_on"], design["c_oss"], r_l, dynamic=False
+    )
+    _, _, p_1, _ = get_switch_losses_batch(
+        v_in, i_in, v_out, 1.0, design["r_ds_on"], design["c_oss"], r_l, dynamic=False
+    )
+    f_max = (p_sw_bud - p_0) / (p_1 - p_0)
+    f_sw = m.floor(f_max.min() / 1e3) * 1e3
+    if f_sw <= 0:
+        raise ValueError(f"No F_SW keeps {num_cells} cells within {p_sw_bud} W")
+
+    (
+        ci_min,
+        co_min,
+        l_min,
+        ci_vdc_min,
+        co_vdc_min,
+        l_a_min,
+        ci_rms_min,
+        co_rms_min,
+    ) = get_passive_sizing(
+        v_in_range,
+        v_out_range,
+        f_sw,
+        v_in_range[2] / 100,
+        r_co_v,
+        r_l_a,
+        eff,
+        model_nonideal_cell,
+        num_cells,
+        sf,
+    )
+    plt.close("all")
+
+    # Same core family: the DCR scales with the turns squared, so with L, and
+    # the ESR of parallel parts with 1 / C.
+    l = l_min * sf
+    parts = {
+        "l": l,
+        "r_dcr": design["r_dcr"] * l / design["l"],
+        "n_l": get_inductor_sizing(l, l_a_min, b_sat, r_l)[3],
+        "c_i": ci_min * sf,
+        "r_ci": design["r_ci"] * design["c_i"] / (ci_min * sf),
+        "c_o": co_min * sf,
+        "r_co": design["r_co"] * design["c_o"] / (co_min * sf),
+        "r_ds_on": design["r_ds_on"],
+        "c_oss": design["c_oss"],
+        "q_g": design["q_g"],
+    }
+    cost = (
+        cost_fixed
+        + 2 * cost_switch
+        + cost_inductor[0]
+        + cost_inductor[1] * 0.5 * l * l_a_min**2 * 1e3
+        + 2 * cost_capacitor[0]
+        + cost_capacitor[1] * 0.5 * parts["c_i"] * ci_vdc_min**2
+        + cost_capacitor[1] * 0.5 * parts["c_o"] * co_vdc_min**2
+    )
+    return {
+        "num_cells": num_cells,
+        "v_in_range": v_in_range,
+        "v_ds_min": v_ds_min,
+        "i_ds_min": i_ds_min,
+        "p_sw_bud": p_sw_bud,
+        "f_sw": f_sw,
+        "l_a_min": l_a_min,
+        "ci_vdc_min": ci_vdc_min,
+        "co_vdc_min": co_vdc_min,
+        "ci_rms_min": ci_rms_min,
+        "co_rms_min": co_rms_min,
+        "d_max": 1 - v_in_range[0] / v_out_range[2],
+        "cost": cost,
+        **parts,
+    }
+
+
+def get_converter_loss(design, v_in, i_in, v_out):
+    """_summary_
+    Get the loss of a converter at its operating points, from the calibrated
+    loss model with its own gate drive and auxiliary rails.
+
+    Args:
+        design (dict): Converter, see get_partition_design
+        v_in (np.ndarray): Input voltage (V)
+        i_in (np.ndarray): Input current (A)
+        v_out (float): Output voltage (V)
+
+    Returns:
+        np.ndarray: Loss (W).
+    """
+    v_in = np.clip(v_in, 1e-3, v_out * (1 - 1e-3))
+    return get_loss_breakdown(design, v_in, i_in, v_out, design["f_sw"], aux=True)[
+        "total"
+    ]
+
+
+def get_substring_mpp(g, t, clusters, chunk=64):
+    """_summary_
+    Sweep the P-I curve of a sub-string with bypass diodes and find its
+    global maximum and the first local maximum from open circuit.
+
+    Args:
+        g (np.ndarray): Cell irradiance (W/m^2), (T, N)
+        t (np.ndarray): Cell temperature (K), (T, N)
+        clusters ([np.ndarray]): Column indices of the cells of every bypass
+            cluster
+        chunk (int, optional): Time steps per vectorized chunk. Defaults to
+            64.
+
+    Returns:
+        dict: V, I and P at the global ("v", "i", "p") and first local
+            ("v_local", "i_local", "p_local") maximum, (T).
+    """
+    num_steps = len(g)
+    # The light current and the saturation current of every cell, from the
+    # short circuit current and conductance of the single diode model.
+    i_l, g_d = model_nonideal_cell_vec(g, t, 0, r_sh, 0.0)
+    i_0 = np.maximum((g_d - 1 / r_sh) * k_b * t / q, 1e-30)
+    v_t = k_b * t / q
+
+    out = {key: np.zeros(num_steps) for key in ["v", "i", "p"]}
+    out.update({key: np.zeros(num_steps) for key in ["v_local", "i_local", "p_local"]})
+    frac = np.linspace(0, 1, num_points)
+    for start in range(0, num_steps, chunk):
+        sl = slice(start, min(start + chunk, num_steps))
+        i_max = max(float(i_l[sl].max()), 1e-6)
+        current = (frac * i_max)[None, :, None]
+        v = np.zeros((len(g[sl]), num_points))
+        for cells in clusters:
+            i_cell = i_l[sl][:, None, cells]
+            forward = v_t[sl][:, None, cells] * np.log1p(
+                np.maximum(i_cell - current, 0) / i_0[sl][:, None, cells]
+            )
+            v_cell = np.where(current < i_cell, forward, (i_cell - current) * r_sh)
+            v += np.maximum(v_cell.sum(axis=-1), -v_byp - r_byp * current[..., 0])
+        p = v * current[..., 0]
+        best = p.argmax(axis=1)
+        # The tracker walks down from open circuit while the power rises.
+        falling = np.diff(p, axis=1) < 0
+        local = np.where(falling.any(axis=1), falling.argmax(axis=1), num_points - 1)
+        rows = np.arange(len(p))
+        for suffix, idx in [("", best), ("_local", local)]:
+            out["v" + suffix][sl] = v[rows, idx]
+            out["i" + suffix][sl] = current[0, idx, 0]
+            out["p" + suffix][sl] = np.maximum(p[rows, idx], 0)
+    return out
+
+
+def evaluate_partition(task):
+    """_summary_
+    Evaluate the energy of one partition of the array over one scenario.
+
+    Args:
+        task (tuple): (k, design, g, t, dt), with the cell irradiance and
+            temperature (T, N), see get_partition_design.
+
+    Returns:
+        dict: Energy (Wh) drawn from the array by the running converters
+            ("e_array", "e_array_local"), lost in the converters ("e_loss",
+            "e_loss_local") and into the battery ("e_out", "e_out_local"),
+            and the power into the battery (W),
+            (T).
+    """
+    k, design, g, t, dt = task
+    num_cells = g.shape[1]
+    results = {"p_out": np.zeros(len(g)), "p_out_local": np.zeros(len(g))}
+    for key in ["e_array", "e_loss", "e_out"]:
+        results[key] = results[key + "_local"] = 0.0
+    for cells in np.array_split(np.arange(num_cells), k):
+        clusters = np.array_split(cells, m.ceil(len(cells) / cells_per_bypass))
+        mpp = get_substring_mpp(g, t, clusters)
+        for suffix in ["", "_local"]:
+            v_in, i_in = mpp["v" + suffix], mpp["i" + suffix]
+            p_in = mpp["p" + suffix]
+            loss = get_converter_loss(design, v_in, i_in, v_bat)
+            # The converter sleeps when it would draw more than it delivers,
+            # and cannot regulate past its duty cycle limit.
+            on = (p_in > loss) & (v_in >= v_bat * (1 - design["d_max"]))
+            results["p_out" + suffix] += np.where(on, p_in - loss, 0)
+            results["e_array" + suffix] += np.where(on, p_in, 0).sum() * dt / 3600
+            results["e_loss" + suffix] += np.where(on, loss, 0).sum() * dt / 3600
+    for suffix in ["", "_local"]:
+        results["e_out" + suffix] = results["p_out" + suffix].sum() * dt / 3600
+    return results
+
+
+def get_scenarios(num_cells, duration=3600.0, dt=1.0, seed=0):
+    """_summary_
+    Get the cell irradiance and temperature of the shading scenarios, a
+    drive on the June solstice at different times of day, with and without
+    roadside objects, and a cell to cell I_SC mismatch.
+
+    Args:
+        num_cells (int): Number of solar cells
+        duration (float, optional): Length of every scenario (s). Defaults to
+            an hour.
+        dt (float, optional): Time step (s). Defaults to 1.
+        seed (int, optional): Random seed. Defaults to 0.
+
+    Returns:
+        dict: Per scenario name, (g, t) of shape (T, N).
+    """
+    rng = np.random.default_rng(seed)
+    cells, normals, canopy = get_example_vehicle(num_cells)
+    spread = 1 + mismatch * rng.standard_normal(num_cells)
+    route, boxes, spheres = get_example_route(duration, dt, seed=seed)
+    world = get_world_normals(normals, route["heading"])
+    v_air = get_air_speed(15.0, route["heading"], 3.0, np.pi)
+
+    scenarios = {}
+    for name, start, roadside in [
+        ("Noon, open road", "2026-06-21T17:30", False),
+        ("Noon, roadside", "2026-06-21T17:30", True),
+        ("Morning, roadside", "2026-06-21T13:00", True),
+        ("Evening, roadside", "2026-06-21T23:00", True),
+    ]:
+        t = np.datetime64(start) + (route["t"] * 1e3).astype("timedelta64[ms]")
+        zenith, azimuth, distance = get_solar_position(t)
+        i_0 = get_extraterrestrial(distance)
+        ghi, dni, dhi = get_clear_sky_components(zenith)
+        _, lit = get_cell_irradiance(
+            cells,
+            normals,
+            route,
+            azimuth,
+            np.pi / 2 - zenith,
+            dni,
+            dhi,
+            canopy,
+            boxes if roadside else None,
+            spheres if roadside else None,
+        )
+        g = get_poa_irradiance(world, zenith, azimuth, dni, dhi, ghi, i_0, lit=lit)
+        t_cell, _ = get_cell_temperature(g.T, 303.15, v_air, dt)
+        scenarios[name] = (g * spread, t_cell.T)
+    return scenarios
+
+
+def get_partition_study(num_cells, scenarios, dt=1.0, max_workers=None):
+    """_summary_
+    Resize the converter for every partition and evaluate every scenario in
+    a process pool.
+
+    Args:
+        num_cells (int): Number of solar cells
+        scenarios (dict): Per name, (g, t), see get_scenarios
+        dt (float, optional): Time step (s). Defaults to 1.
+        max_workers (int, optional): Worker processes. Defaults to the CPU
+            count.
+
+    Returns:
+        (dict, dict): Design per K, and results per (K, scenario name), see
+            evaluate_partition.
+    """
+    p_sw_bud = get_partition_design(num_cells)["p_sw_bud"]
+    designs = {
+        k: get_partition_design(m.ceil(num_cells / k), p_sw_bud)
+        for k in partition_range
+    }
+    tasks = {
+        (k, name): (k, designs[k], g, t, dt)
+        for k in partition_range
+        for name, (g, t) in scenarios.items()
+    }
+    with concurrent.futures.ProcessPoolExecutor(max_workers) as pool:
+        results = dict(zip(tasks, pool.map(evaluate_partition, tasks.values())))
+    return (designs, results)
+
+
+def get_array_partitioning_map(designs, results, scenarios):
+    """_summary_
+    Plot the energy, loss and cost against the number of sub-strings.
+
+    Args:
+        designs (dict): Design per K
+        results (dict): Results per (K, scenario name)
+        scenarios ([str]): Scenario names
+    """
+    ks = list(designs)
+    fig, axs = plt.subplots(2, 2, figsize=(16, 12))
+    ax = axs[0, 0]
+    for name in scenarios:
+        ax.plot(ks, [results[k, name]["e_out"] for k in ks], "o-", label=name)
+        ax.plot(
+            ks,
+            [results[k, name]["e_out_local"] for k in ks],
+            "x--",
+            color=ax.lines[-1].get_color(),
+            alpha=0.6,
+        )
+    ax.set_xlabel("Sub-strings K")
+    ax.set_ylabel("Energy into the battery (Wh)")
+    ax.set_title("Global (o) and first local (x) maximum trackers")
+    ax.grid(True)
+    ax.legend()
+
+    ax = axs[0, 1]
+    for name in scenarios:
+        ax.plot(ks, [results[k, name]["e_loss"] for k in ks], "o-", label=name)
+    ax.set_xlabel("Sub-strings K")
+    ax.set_ylabel("Converter loss (Wh)")
+    ax.grid(True)
+    ax.legend()
+
+    ax = axs[1, 0]
+    ax.bar(ks, [k * designs[k]["cost"] for k in ks])
+    ax.set_xlabel("Sub-strings K")
+    ax.set_ylabel("Converter cost (USD)")
+    ax.grid(True)
+
+    ax = axs[1, 1]
+    for name in scenarios:
+        e_out = np.array([results[k, name]["e_out_local"] for k in ks])
+        ax.plot(ks[1:], np.diff(e_out), "o-", label=name)
+    ax.axhline(0, color="k", linewidth=0.8)
+    ax.set_xlabel("Sub-strings K")
+    ax.set_ylabel("Marginal energy over the previous K (Wh)")
+    ax.set_title("P&O tracker")
+    ax.grid(True)
+    ax.legend()
+
+    plt.savefig("array_partitioning_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    num_cells = 111
+    dt = 1.0
+
+    start = time.perf_counter()
+    scenarios = get_scenarios(num_cells, dt=dt)
+    print(f"{len(scenarios)} scenarios in {time.perf_counter() - start:.1f} s")
+    start = time.perf_counter()
+    designs, results = get_partition_study(num_cells, scenarios, dt)
+    print(
+        f"{len(results)} partition evaluations in {time.perf_counter() - start:.1f} s"
+    )
+
+    for k, design in designs.items():
+        print(
+            f"K = {k}: {design['num_cells']} cells, V_IN "
+            f"{design['v_in_range'][0]:.1f}-{design['v_in_range'][2]:.1f} V, "
+            f"D_MAX {design['d_max']:.2f}, F_SW {design['f_sw'] / 1e3:.0f} kHz, "
+            f"L {design['l'] * 1e6:.1f} uH, C_I {design['c_i'] * 1e6:.1f} uF, "
+            f"C_O {design['c_o'] * 1e6:.1f} uF, {k} x {design['cost']:.0f} USD"
+        )
+    ks = list(designs)
+    for name in scenarios:
+        print(name)
+        for i, k in enumerate(ks):
+            res = results[k, name]
+            line = (
+                f"  K = {k}: array {res['e_array']:6.1f} Wh (P&O "
+                f"{res['e_array_local']:6.1f}), loss {res['e_loss']:5.1f} Wh, "
+                f"out {res['e_out']:6.1f} Wh (P&O {res['e_out_local']:6.1f})"
+            )
+            if i > 0:
+                prev = results[ks[i - 1], name]
+                gain = res["e_out_local"] - prev["e_out_local"]
+                cost = k * designs[k]["cost"] - ks[i - 1] * designs[ks[i - 1]]["cost"]
+                line += f", marginal {gain:+5.1f} Wh for {cost:+4.0f} USD"
+            print(line)
+
+    get_array_partitioning_map(designs, results, list(scenarios))
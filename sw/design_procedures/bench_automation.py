@@ -0,0 +1,929 @@
+"""_summary_
+@file       bench_automation.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Automated efficiency sweeps over SCPI.
+
+            The bench is a solar array simulator (SAS mode: I_SC, V_OC,
+            I_MP, V_MP), an electronic load in constant voltage mode
+            emulating the battery, a two channel power analyzer across the
+            input and output, and the converter under test, which regulates
+            its input voltage to a reference at a commanded F_SW. Each sweep
+            point sets the curve so that its maximum power point is the
+            requested (V_IN, I_IN), the battery voltage and the converter,
+            waits for the input to settle, and integrates one analyzer
+            window.
+
+            A sweep is run either synchronized, with one command per
+            transaction confirmed by *OPC? and a fixed worst case settle, or
+            pipelined:
+            - points are visited in serpentine order over (V_OUT, V_IN,
+              I_IN, F_SW), so consecutive points differ in as few and as
+              small setpoints as possible,
+            - the setpoints of an instrument go out as one unconfirmed
+              transaction,
+            - the settle is detected by polling the array simulator and
+              load readbacks against the target, after a minimum dwell,
+              instead of waiting the worst case,
+            - the analyzer result of a point is fetched while the next point
+              settles, since the analyzer latches it at the end of the window.
+
+            Every instrument talks through a transport: VisaTransport for
+            the bench (pyvisa), or SimulatedTransport, which charges the bus
+            latency to a virtual clock and answers from a simulated
+            instrument. The simulated instruments share one SimulatedBench,
+            whose operating point follows the setpoints with a dead time and
+            a first order settle, and whose losses come from
+            loss_calibration.get_loss_breakdown, so sweeps run offline in
+            virtual time.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import csv
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.calibration import default_calibration, get_calibration
+from design_procedures.converter_model import default_boost_design
+from design_procedures.loss_calibration import (
+    fit_keys,
+    fit_loss_calibration,
+    get_core_reference_loss,
+    get_loss_breakdown,
+)
+
+latency_write = 2e-3  # s, per SCPI write over LAN
+latency_query = 8e-3  # s, per SCPI query round trip
+dead_time = 10e-3  # s, before the array simulator follows a new setpoint
+tau_settle = 8e-3  # s, input voltage regulation and source settle
+t_integrate = 0.2  # s, power analyzer integration window
+num_samples = 16  # Samples per window of the simulated power analyzer
+analyzer_accuracy = 2e-4  # 1 sigma relative error of each power reading
+readback_noise = (2e-3, 1e-3)  # V, A, 1 sigma of the source readback
+settle_tol = (0.02, 0.005)  # V, A, readback distance to the target when settled
+fixed_settle = 0.5  # s, worst case settle of a synchronized sweep
+poll_interval = 2e-3  # s, between readback polls while settling
+# s, shortest wait after any setpoint change. A readback already at the target
+# means nothing until the instruments have responded, and an F_SW change does
+# not show up in any readback.
+min_dwell = 2 * dead_time
+
+# Maxeon Gen III cell, V_MP / V_OC and I_MP / I_SC of the emulated curve.
+v_mp_ratio = 0.621 / 0.721
+i_mp_ratio = 5.84 / 6.15
+
+
+class VirtualClock:
+    """_summary_
+    Clock of a simulated bench. Sleeping advances time without waiting.
+    """
+
+    def __init__(self):
+        self.t = 0.0
+
+    def now(self):
+        return self.t
+
+    def sleep(self, dt):
+        self.t += max(dt, 0.0)
+
+
+class RealClock:
+    """_summary_
+    Wall clock of a real bench.
+    """
+
+    def now(self):
+        return time.monotonic()
+
+    def sleep(self, dt):
+        if dt > 0:
+            time.sleep(dt)
+
+
+class VisaTransport:
+    """_summary_
+    SCPI over a VISA resource, e.g. "TCPIP0::192.168.1.20::inst0::INSTR".
+    """
+
+    def __init__(self, address, clock=None, timeout=5.0):
+        """_summary_
+        Open a VISA resource.
+
+        Args:
+            address (str): VISA resource string
+            clock (RealClock, optional): Bench clock. Defaults to RealClock().
+            timeout (float, optional): I/O timeout, in s. Defaults to 5.0.
+        """
+        try:
+            import pyvisa
+        except ImportError as error:
+            raise Exception("VisaTransport requires pyvisa.") from error
+        self.clock = RealClock() if clock is None else clock
+        self._resource = pyvisa.ResourceManager().open_resource(address)
+        self._resource.timeout = timeout * 1e3
+        self._resource.read_termination = "\n"
+        self._resource.write_termination = "\n"
+
+    def write(self, command):
+        self._resource.write(command)
+
+    def query(self, command):
+        return self._resource.query(command).strip()
+
+
+class SimulatedTransport:
+    """_summary_
+    SCPI to a simulated instrument. Each transaction advances the bench clock
+    by the bus latency.
+    """
+
+    def __init__(self, instrument):
+        """_summary_
+        Connect to a simulated instrument.
+
+        Args:
+            instrument (SimulatedInstrument): Simulated instrument
+        """
+        self.instrument = instrument
+        self.clock = instrument.bench.clock
+        self.num_transactions = 0
+
+    def write(self, command):
+        self.clock.sleep(latency_write)
+        self.num_transactions += 1
+        self.instrument.handle(command)
+
+    def query(self, command):
+        self.clock.sleep(latency_query)
+        self.num_transactions += 1
+        return self.instrument.handle(command)
+
+
+class SimulatedBench:
+    """_summary_
+    Shared physics of the simulated instruments: the array simulator curve,
+    the battery voltage and the converter setpoints, and the operating point
+    they settle to.
+
+    After every setpoint change the input voltage, input current and output
+    voltage follow the new steady state after dead_time with time constant
+    tau_settle. The history of these transitions is kept so that an analyzer
+    window can be evaluated after later setpoints have been written.
+    """
+
+    def __init__(self, design=None, params=None, clock=None, seed=0):
+        """_summary_
+        Create a bench with the sources off.
+
+        Args:
+            design (dict, optional): Converter design, see
+                default_boost_design. Defaults to default_boost_design.
+            params (dict, optional): Loss model parameters of the simulated
+                converter. Defaults to get_calibration().
+            clock (VirtualClock, optional): Bench clock. Defaults to a new
+                VirtualClock.
+            seed (int, optional): Random seed of the readback and analyzer
+                noise. Defaults to 0.
+        """
+        self.design = default_boost_design if design is None else design
+        self.params = get_calibration() if params is None else params
+        self.clock = VirtualClock() if clock is None else clock
+        self.rng = np.random.default_rng(seed)
+        self.setpoints = {
+            "i_sc": 0.0,
+            "v_oc": 0.0,
+            "i_mp": 0.0,
+            "v_mp": 0.0,
+            "sas_on": 0.0,
+            "v_bat": 0.0,
+            "load_on": 0.0,
+            "v_ref": 0.0,
+            "f_sw": 100e3,
+            "dut_on": 0.0,
+        }
+        # (t, x_0, x_target, f_sw) of every transition, x = (V_IN, I_IN, V_OUT)
+        self._history = [(self.clock.now(), np.zeros(3), np.zeros(3), 100e3)]
+
+    def get_steady_state(self):
+        """_summary_
+        Get the operating point the current setpoints settle to.
+
+        Returns:
+            np.ndarray: V_IN, I_IN, V_OUT.
+        """
+        s = self.setpoints
+        v_out = s["v_bat"] if s["load_on"] else 0.0
+        # The curve is only valid once all four parameters are consistent.
+        valid = 0 < s["i_mp"] < s["i_sc"] and 0 < s["v_mp"] < s["v_oc"]
+        if not s["sas_on"] or not valid:
+            return np.array([0.0, 0.0, v_out])
+        v_in = min(s["v_ref"], s["v_oc"]) if s["dut_on"] else s["v_oc"]
+        i_in = get_sas_current(v_in, s["i_sc"], s["v_oc"], s["i_mp"], s["v_mp"])
+        if not s["dut_on"] or not s["load_on"]:
+            i_in = 0.0
+        return np.array([v_in, i_in, v_out])
+
+    def set(self, **setpoints):
+        """_summary_
+        Change setpoints and start the transition to the new steady state.
+
+        Args:
+            **setpoints: Values of keys of self.setpoints
+        """
+        now = self.clock.now()
+        x_0 = self.get_actual(np.array([now]))[0]
+        self.setpoints.update(setpoints)
+        self._history.append(
+            (now, x_0, self.get_steady_state(), self.setpoints["f_sw"])
+        )
+
+    def get_actual(self, t):
+        """_summary_
+        Get the operating point at a set of times.
+
+        Args:
+            t (np.ndarray): Times, in s, not before the bench was created
+
+        Returns:
+            np.ndarray: (len(t), 3) V_IN, I_IN, V_OUT.
+        """
+        starts = np.array([h[0] for h in self._history])
+        seg = np.searchsorted(starts, t, side="right") - 1
+        x_0 = np.array([self._history[k][1] for k in seg])
+        x_t = np.array([self._history[k][2] for k in seg])
+        age = np.maximum(t - starts[seg] - dead_time, 0.0)
+        return x_t + (x_0 - x_t) * np.exp(-age / tau_settle)[:, None]
+
+    def get_f_sw(self, t):
+        starts = np.array([h[0] for h in self._history])
+        seg = np.searchsorted(starts, t, side="right") - 1
+        return np.array([self._history[k][3] for k in seg])
+
+    def get_window(self, t_0, t_1):
+        """_summary_
+        Get the power analyzer reading over a window: the mean of each
+        quantity, with the analyzer error on the powers.
+
+        Args:
+            t_0 (float): Window start, in s
+            t_1 (float): Window end, in s
+
+        Returns:
+            np.ndarray: U1, I1, P1, U2, I2, P2.
+        """
+        t = np.linspace(t_0, t_1, num_samples)
+        v_in, i_in, v_out = self.get_actual(t).T
+        p_in = v_in * i_in
+        loss = np.zeros_like(t)
+        on = (i_in > 1e-3) & (v_out > v_in)
+        if on.any():
+            loss[on] = get_loss_breakdown(
+                self.design,
+                v_in[on],
+                i_in[on],
+                v_out[on],
+                self.get_f_sw(t[on]),
+                self.params,
+            )["total"]
+        p_out = np.where(on, p_in - loss, 0.0)
+        i_out = np.where(v_out > 0, p_out / np.maximum(v_out, 1e-9), 0.0)
+        reading = np.array([x.mean() for x in (v_in, i_in, p_in, v_out, i_out, p_out)])
+        reading[[2, 5]] *= 1 + self.rng.normal(0, analyzer_accuracy, 2)
+        return reading
+
+    def get_readback(self):
+        """_summary_
+        Get the array simulator readback now.
+
+        Returns:
+            np.ndarray: V_IN, I_IN, V_OUT.
+        """
+        x = self.get_actual(np.array([self.clock.now()]))[0]
+        noise = (readback_noise[0], readback_noise[1], readback_noise[0])
+        return x + self.rng.normal(0, noise)
+
+
+class SimulatedInstrument:
+    """_summary_
+    SCPI parser of a simulated instrument. Commands of one transaction are
+    separated by ";", a leading ":" is ignored, headers are case insensitive
+    and queries are answered in order, joined by ";".
+    """
+
+    idn = "SIM,INSTRUMENT,0,0.0.0"
+
+    def __init__(self, bench):
+        self.bench = bench
+
+    def handle(self, message):
+        """_summary_
+        Execute a transaction.
+
+        Args:
+            message (str): SCPI commands, e.g. "VOLT 50;OUTP ON"
+
+        Returns:
+            str: Responses to the queries of the transaction.
+        """
+        responses = []
+        for command in message.split(";"):
+            command = command.strip().lstrip(":")
+            if not command:
+                continue
+            header, _, argument = command.partition(" ")
+            header = header.upper()
+            if header == "*OPC?":
+                responses.append("1")
+            elif header == "*IDN?":
+                responses.append(self.idn)
+            elif header == "*RST":
+                self.reset()
+            else:
+                response = self.execute(header, argument.strip())
+                if response is not None:
+                    responses.append(response)
+        return ";".join(responses)
+
+    def reset(self):
+        pass
+
+    def execute(self, header, argument):
+        raise Exception(f"{type(self).__name__}: undefined header {header}")
+
+
+def parse_bool(argument):
+    return float(argument.upper() in ("1", "ON"))
+
+
+class SimulatedArraySimulator(SimulatedInstrument):
+    """_summary_
+    Solar array simulator in SAS mode.
+    """
+
+    idn = "SIM,SAS,0,0.0.0"
+    headers = {
+        "CURR:SAS:ISC": "i_sc",
+        "VOLT:SAS:VOC": "v_oc",
+        "CURR:SAS:IMP": "i_mp",
+        "VOLT:SAS:VMP": "v_mp",
+    }
+
+    def execute(self, header, argument):
+        if header in self.headers:
+            self.bench.set(**{self.headers[header]: float(argument)})
+        elif header in ("OUTP", "OUTP:STAT"):
+            self.bench.set(sas_on=parse_bool(argument))
+        elif header == "MEAS:VOLT?":
+            return f"{self.bench.get_readback()[0] :.6e}"
+        elif header == "MEAS:CURR?":
+            return f"{self.bench.get_readback()[1] :.6e}"
+        else:
+            return super().execute(header, argument)
+
+
+class SimulatedElectronicLoad(SimulatedInstrument):
+    """_summary_
+    Electronic load in constant voltage mode, emulating the battery.
+    """
+
+    idn = "SIM,LOAD,0,0.0.0"
+
+    def execute(self, header, argument):
+        if header == "FUNC":
+            if argument.upper() not in ("VOLT", "VOLTAGE"):
+                raise Exception("Simulated load only supports FUNC VOLT")
+        elif header == "VOLT":
+            self.bench.set(v_bat=float(argument))
+        elif header in ("INP", "INP:STAT"):
+            self.bench.set(load_on=parse_bool(argument))
+        elif header == "MEAS:VOLT?":
+            return f"{self.bench.get_readback()[2] :.6e}"
+        else:
+            return super().execute(header, argument)
+
+
+class SimulatedPowerAnalyzer(SimulatedInstrument):
+    """_summary_
+    Two channel power analyzer. INIT starts an integration window, FETC?
+    returns the latched reading of the last window (waiting for it to end)
+    as U1,I1,P1,U2,I2,P2.
+    """
+
+    idn = "SIM,ANALYZER,0,0.0.0"
+
+    def __init__(self, bench):
+        super().__init__(bench)
+        self.t_int = t_integrate
+        self.window = None
+
+    def execute(self, header, argument):
+        if header == "INT:TIME":
+            self.t_int = float(argument)
+        elif header == "INIT":
+            t_0 = self.bench.clock.now()
+            self.window = (t_0, t_0 + self.t_int)
+        elif header == "FETC?":
+            if self.window is None:
+                raise Exception("FETC? without INIT")
+            self.bench.clock.sleep(self.window[1] - self.bench.clock.now())
+            return ",".join(f"{x :.6e}" for x in self.bench.get_window(*self.window))
+        else:
+            return super().execute(header, argument)
+
+
+class SimulatedConverter(SimulatedInstrument):
+    """_summary_
+    Converter under test, regulating its input voltage to VIN:REF.
+    """
+
+    idn = "SIM,BOOST,0,0.0.0"
+
+    def execute(self, header, argument):
+        if header == "VIN:REF":
+            self.bench.set(v_ref=float(argument))
+        elif header == "FSW":
+            self.bench.set(f_sw=float(argument))
+        elif header in ("OUTP", "OUTP:STAT"):
+            self.bench.set(dut_on=parse_bool(argument))
+        else:
+            return super().execute(header, argument)
+
+
+def get_sas_current(v, i_sc, v_oc, i_mp, v_mp):
+    """_summary_
+    Get the current of the exponential SAS mode curve through (0, I_SC),
+    (V_MP, I_MP) and (V_OC, 0).
+
+    Args:
+        v (float|np.ndarray): Voltage, in V
+        i_sc (float): Short circuit current, in A
+        v_oc (float): Open circuit voltage, in V
+        i_mp (float): Maximum power point current, in A
+        v_mp (float): Maximum power point voltage, in V
+
+    Returns:
+        float|np.ndarray: Current, in A.
+    """
+    k = np.log(1 - i_mp / i_sc) / (v_mp - v_oc)
+    return np.clip(i_sc * (1 - np.exp(k * (np.asarray(v) - v_oc))), 0.0, None)
+
+
+class Instrument:
+    """_summary_
+    Driver base. Setpoints go out either as one unconfirmed transaction or,
+    when synchronized, one command at a time each confirmed with *OPC?.
+    """
+
+    def __init__(self, transport):
+        self.transport = transport
+
+    def send(self, commands, sync=False):
+        """_summary_
+        Send setpoint commands.
+
+        Args:
+            commands ([str]): SCPI commands
+            sync (bool, optional): Confirm each command. Defaults to False.
+        """
+        if sync:
+            for command in commands:
+                self.transport.write(command)
+                self.transport.query("*OPC?")
+        elif commands:
+            self.transport.write(";".join(commands))
+
+    def identify(self):
+        return self.transport.query("*IDN?")
+
+
+class ArraySimulator(Instrument):
+    """_summary_
+    Solar array simulator in SAS mode.
+    """
+
+    def set_curve(self, i_sc, v_oc, i_mp, v_mp, sync=False):
+        self.send(
+            [
+                f"CURR:SAS:ISC {i_sc :.4f}",
+                f"VOLT:SAS:VOC {v_oc :.4f}",
+                f"CURR:SAS:IMP {i_mp :.4f}",
+                f"VOLT:SAS:VMP {v_mp :.4f}",
+            ],
+            sync,
+        )
+
+    def set_output(self, on, sync=False):
+        self.send([f"OUTP {'ON' if on else 'OFF'}"], sync)
+
+    def measure(self):
+        """_summary_
+        Read back the output.
+
+        Returns:
+            (float, float): Voltage (V), current (A).
+        """
+        v, i = self.transport.query("MEAS:VOLT?;:MEAS:CURR?").split(";")
+        return float(v), float(i)
+
+
+class BatteryEmulator(Instrument):
+    """_summary_
+    Electronic load in constant voltage mode.
+    """
+
+    def set_voltage(self, v, sync=False):
+        self.send(["FUNC VOLT", f"VOLT {v :.4f}"], sync)
+
+    def set_input(self, on, sync=False):
+        self.send([f"INP {'ON' if on else 'OFF'}"], sync)
+
+    def measure_voltage(self):
+        """_summary_
+        Read back the input voltage.
+
+        Returns:
+            float: Voltage (V).
+        """
+        return float(self.transport.query("MEAS:VOLT?"))
+
+
+class PowerAnalyzer(Instrument):
+    """_summary_
+    Two channel power analyzer, channel 1 on the input and 2 on the output.
+    """
+
+    def set_integration(self, t_int, sync=False):
+        self.send([f"INT:TIME {t_int :.4f}"], sync)
+
+    def start(self):
+        self.transport.write("INIT")
+
+    def fetch(self):
+        """_summary_
+        Get the reading of the last window, waiting for it to end.
+
+        Returns:
+            np.ndarray: U1, I1, P1, U2, I2, P2.
+        """
+        return np.array([float(x) for x in self.transport.query("FETC?").split(",")])
+
+
+class ConverterUnderTest(Instrument):
+    """_summary_
+    Converter under test, regulating its input voltage.
+    """
+
+    def set_operating_point(self, v_ref, f_sw, sync=False):
+        self.send([f"VIN:REF {v_ref :.4f}", f"FSW {f_sw :.0f}"], sync)
+
+    def set_output(self, on, sync=False):
+        self.send([f"OUTP {'ON' if on else 'OFF'}"], sync)
+
+
+def get_simulated_bench(design=None, params=None, seed=0):
+    """_summary_
+    Get the drivers of a simulated bench.
+
+    Args:
+        design (dict, optional): Converter design. Defaults to
+            default_boost_design.
+        params (dict, optional): Loss model parameters of the simulated
+            converter. Defaults to get_calibration().
+        seed (int, optional): Random seed. Defaults to 0.
+
+    Returns:
+        dict: "sas", "load", "analyzer", "dut" drivers, the "clock" and the
+            SimulatedBench as "sim".
+    """
+    sim = SimulatedBench(design, params, seed=seed)
+    return {
+        "sas": ArraySimulator(SimulatedTransport(SimulatedArraySimulator(sim))),
+        "load": BatteryEmulator(SimulatedTransport(SimulatedElectronicLoad(sim))),
+        "analyzer": PowerAnalyzer(SimulatedTransport(SimulatedPowerAnalyzer(sim))),
+        "dut": ConverterUnderTest(SimulatedTransport(SimulatedConverter(sim))),
+        "clock": sim.clock,
+        "sim": sim,
+    }
+
+
+def get_visa_bench(addresses):
+    """_summary_
+    Get the drivers of the real bench.
+
+    Args:
+        addresses (dict): VISA resource string of "sas", "load", "analyzer"
+            and "dut"
+
+    Returns:
+        dict: "sas", "load", "analyzer", "dut" drivers and the "clock".
+    """
+    clock = RealClock()
+    return {
+        "sas": ArraySimulator(VisaTransport(addresses["sas"], clock)),
+        "load": BatteryEmulator(VisaTransport(addresses["load"], clock)),
+        "analyzer": PowerAnalyzer(VisaTransport(addresses["analyzer"], clock)),
+        "dut": ConverterUnderTest(VisaTransport(addresses["dut"], clock)),
+        "clock": clock,
+    }
+
+
+def get_sweep_points(v_in_range, i_in_range, v_out_range, f_sw_range):
+    """_summary_
+    Get the full grid of sweep points, skipping points the boost converter
+    cannot reach (V_IN >= V_OUT).
+
+    Args:
+        v_in_range ([float]): Input voltages, in V
+        i_in_range ([float]): Input currents, in A
+        v_out_range ([float]): Output voltages, in V
+        f_sw_range ([float]): Switching frequencies, in Hz
+
+    Returns:
+        np.ndarray: (N, 4) V_IN, I_IN, V_OUT, F_SW.
+    """
+    grid = np.stack(
+        np.meshgrid(v_in_range, i_in_range, v_out_range, f_sw_range, indexing="ij"),
+        axis=-1,
+    ).reshape(-1, 4)
+    return grid[grid[:, 0] < grid[:, 2]]
+
+
+def get_sweep_order(points, axes=(2, 0, 1, 3)):
+    """_summary_
+    Get a serpentine visiting order of sweep points: sorted by the first axis,
+    then by the next with the direction reversed on every other value of the
+    axes before it, and so on, so consecutive points change the fewest and
+    smallest setpoints.
+
+    Args:
+        points (np.ndarray): (N, D) sweep points
+        axes (tuple, optional): Axes from slowest to fastest changing.
+            Defaults to (V_OUT, V_IN, I_IN, F_SW).
+
+    Returns:
+        np.ndarray: Indices into points.
+    """
+    key = np.zeros(len(points), dtype=np.int64)
+    for axis in axes:
+        _, index = np.unique(points[:, axis], return_inverse=True)
+        size = index.max() + 1
+        index = np.where(key % 2 == 0, index, size - 1 - index)
+        key = key * size + index
+    return np.argsort(key, kind="stable")
+
+
+def wait_settled(bench, v_target, i_target, v_out_target, timeout=fixed_settle):
+    """_summary_
+    Wait min_dwell after a setpoint change, then poll the array simulator and
+    load readbacks until they are within settle_tol of the target.
+
+    Args:
+        bench (dict): Bench drivers
+        v_target (float): Input voltage target, in V
+        i_target (float): Input current target, in A
+        v_out_target (float): Output voltage target, in V
+        timeout (float, optional): Longest wait, in s. Defaults to
+            fixed_settle.
+
+    Returns:
+        float: Time waited, in s.
+    """
+    clock = bench["clock"]
+    start = clock.now()
+    clock.sleep(min_dwell)
+    while clock.now() - start < timeout:
+        v, i = bench["sas"].measure()
+        if abs(v - v_target) < settle_tol[0] and abs(i - i_target) < settle_tol[1]:
+            # The load is only queried once the input has settled.
+            v_out = bench["load"].measure_voltage()
+            if abs(v_out - v_out_target) < settle_tol[0]:
+                break
+        clock.sleep(poll_interval)
+    return clock.now() - start
+
+
+def run_sweep(bench, points, pipelined=True, t_int=t_integrate):
+    """_summary_
+    Measure a set of sweep points.
+
+    Args:
+        bench (dict): Bench drivers, see get_simulated_bench
+        points (np.ndarray): (N, 4) V_IN, I_IN, V_OUT, F_SW
+        pipelined (bool, optional): Pipelined or synchronized sweep, see the
+            module description. Defaults to True.
+        t_int (float, optional): Analyzer window, in s. Defaults to
+            t_integrate.
+
+    Returns:
+        (dict, float): Records with the setpoints ("v_in_set", "i_in_set",
+            "v_out_set", "f_sw"), the readings ("v_in", "i_in", "p_in",
+            "v_out", "i_out", "p_out"), and the window start "t"; and the
+            sweep time, in s.
+    """
+    sas, load, analyzer, dut = (bench[k] for k in ("sas", "load", "analyzer", "dut"))
+    clock = bench["clock"]
+    sync = not pipelined
+    order = get_sweep_order(points) if pipelined else np.arange(len(points))
+    points = points[order]
+
+    start = clock.now()
+    analyzer.set_integration(t_int, sync)
+    v_in, i_in, v_out, f_sw = points[0]
+    load.set_voltage(v_out, sync)
+    load.set_input(True, sync)
+    sas.set_output(True, sync)
+    dut.set_output(True, sync)
+
+    readings = np.zeros((len(points), 6))
+    t_window = np.zeros(len(points))
+    previous = np.full(4, np.nan)
+    for k, point in enumerate(points):
+        v_in, i_in, v_out, f_sw = point
+        # A synchronized sweep rewrites every setpoint.
+        changed = sync | (point != previous)
+        if changed[2]:
+            load.set_voltage(v_out, sync)
+        if changed[0] or changed[1]:
+            sas.set_curve(i_in / i_mp_ratio, v_in / v_mp_ratio, i_in, v_in, sync)
+        if changed[0] or changed[3]:
+            dut.set_operating_point(v_in, f_sw, sync)
+        if pipelined:
+            if k > 0:
+                readings[k - 1] = analyzer.fetch()
+            wait_settled(bench, v_in, i_in, v_out)
+        else:
+            clock.sleep(fixed_settle)
+        t_window[k] = clock.now()
+        analyzer.start()
+        if pipelined:
+            clock.sleep(t_int)
+        else:
+            readings[k] = analyzer.fetch()
+        previous = point
+    if pipelined:
+        readings[-1] = analyzer.fetch()
+    elapsed = clock.now() - start
+
+    dut.set_output(False, sync)
+    sas.set_output(False, sync)
+    load.set_input(False, sync)
+
+    # Back to the caller's order.
+    restore = np.argsort(order)
+    records = {
+        "v_in_set": points[restore, 0],
+        "i_in_set": points[restore, 1],
+        "v_out_set": points[restore, 2],
+        "f_sw": points[restore, 3],
+        "t": t_window[restore],
+    }
+    for j, key in enumerate(("v_in", "i_in", "p_in", "v_out", "i_out", "p_out")):
+        records[key] = readings[restore, j]
+    return records, elapsed
+
+
+def save_sweep_csv(records, path):
+    """_summary_
+    Write sweep records in the format of loss_calibration.load_efficiency_csv.
+
+    Args:
+        records (dict): Sweep records, see run_sweep
+        path (str): CSV path
+    """
+    keys = list(records.keys())
+    with open(path, "w", newline="") as file:
+        writer = csv.writer(file)
+        writer.writerow(keys)
+        writer.writerows(np.column_stack([records[k] for k in keys]).tolist())
+
+
+def get_bench_sweep_map(results, num=12):
+    """_summary_
+    Plot the input power of the simulated bench with the analyzer windows
+    over the first points of a synchronized and a pipelined sweep, and the
+    efficiency measured by the pipelined sweep.
+
+    Args:
+        results (dict): "Synchronized" and "Pipelined" to a tuple of the
+            sweep records and the SimulatedBench they were measured on
+        num (int, optional): Points shown in the timeline. Defaults to 12.
+    """
+    fig, axs = plt.subplots(1, 3, figsize=(18, 5.5))
+    for ax, name in zip(axs, ("Synchronized", "Pipelined")):
+        records, sim = results[name]
+        t_0 = np.sort(records["t"])[:num]
+        t = np.linspace(0, t_0[-1] + t_integrate, 4000)
+        x = sim.get_actual(t)
+        ax.plot(t, x[:, 0] * x[:, 1], color="tab:blue")
+        for t_w in t_0:
+            ax.axvspan(t_w, t_w + t_integrate, color="tab:orange", alpha=0.3)
+        ax.set_title(f"{name} sweep, first {num} points")
+        ax.set_xlabel("Time (s)")
+        ax.set_ylabel("Input power (W)")
+        ax.grid()
+
+    records, _ = results["Pipelined"]
+    sc = axs[2].scatter(
+        records["p_in"],
+        records["p_out"] / records["p_in"] * 100,
+        c=records["f_sw"] / 1e3,
+        marker="o",
+        s=12,
+        cmap="viridis",
+    )
+    fig.colorbar(sc, ax=axs[2], label="F_SW (kHz)")
+    axs[2].set_title("Measured efficiency")
+    axs[2].set_xlabel("Input power (W)")
+    axs[2].set_ylabel("Efficiency (%)")
+    axs[2].grid()
+
+    fig.tight_layout()
+    plt.savefig("bench_sweep_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    # The simulated board differs from the datasheet model, as in
+    # loss_calibration.
+    truth = dict(
+        default_calibration,
+        k_r_ds_on=1.35,
+        k_e_oss=1.6,
+        k_ac=3.0,
+        k_core=3.2,
+        alpha=1.5,
+        beta=2.7,
+        p_fixed=0.85,
+    )
+    points = get_sweep_points(
+        np.linspace(25, 75, 6),
+        np.linspace(1.0, 6.0, 6),
+        [85.0, 105.0, 125.0],
+        [50e3, 100e3, 150e3, 200e3],
+    )
+    print(f"{len(points)} sweep points")
+
+    results = {}
+    for name, pipelined in (("Synchronized", False), ("Pipelined", True)):
+        bench = get_simulated_bench(params=truth)
+        start = time.perf_counter()
+        records, elapsed = run_sweep(bench, points, pipelined)
+        wall = time.perf_counter() - start
+        results[name] = (records, bench["sim"])
+        transactions = sum(
+            bench[k].transport.num_transactions
+            for k in ("sas", "load", "analyzer", "dut")
+        )
+        eff_err = records["p_out"] / records["p_in"] - (
+            1
+            - get_loss_breakdown(
+                bench["sim"].design,
+                records["v_in_set"],
+                records["i_in_set"],
+                records["v_out_set"],
+                records["f_sw"],
+                truth,
+            )["total"]
+            / (records["v_in_set"] * records["i_in_set"])
+        )
+        print(
+            f"{name}: {elapsed / 60 :.1f} min of bench time "
+            f"({elapsed / len(points) * 1e3 :.0f} ms per point, "
+            f"{transactions} transactions), simulated in {wall :.2f} s, "
+            f"efficiency error vs steady state {np.abs(eff_err).max() * 100 :.3f} % max"
+        )
+
+    records, _ = results["Pipelined"]
+    save_sweep_csv(records, "bench_sweep.csv")
+    params, errors, summary = fit_loss_calibration(records)
+    print(
+        f"Calibration from the pipelined sweep: RMS efficiency error "
+        f"{summary['rms'] * 100 :.3f} %"
+    )
+    for key in fit_keys:
+        print(
+            f"{key:>10}{params[key] :10.3f} +/- {errors[key] :.3f} "
+            f"(simulated {truth[key] :.3f})"
+        )
+    f_ref, b_ref = summary["f_ref"], summary["b_ref"]
+    print(
+        f"{'e_ref':>10}{get_core_reference_loss(params, f_ref, b_ref) * 1e3 :10.3f} "
+        f"(simulated {get_core_reference_loss(truth, f_ref, b_ref) * 1e3 :.3f}) "
+        f"mJ/m^3 per cycle at F_EQ {f_ref / 1e3 :.1f} kHz, B {b_ref * 1e3 :.1f} mT"
+    )
+
+    get_bench_sweep_map(results)
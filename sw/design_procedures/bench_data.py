@@ -0,0 +1,481 @@
+"""_summary_
+@file       bench_data.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Turn bench exports into efficiency and loss maps on the design
+            grids.
+
+            Inputs are a power analyzer export (one row per integration
+            window: time, U1, I1, P1 on the input, U2, I2, P2 on the output,
+            and the commanded F_SW) and a thermal camera export (one row per
+            frame: time and the temperature of each region of interest, ROI).
+            The loss of each ROI is recovered from its temperature with a
+            first order heat balance,
+                P = C_TH dT/dt + (T - T_AMB) / R_TH
+            where T and dT/dt come from a local linear fit of the frames
+            around each analyzer window, so points need not reach thermal
+            steady state.
+
+            Measurements are scattered over (V_IN, I_IN, V_OUT, F_SW) while
+            the design maps sit on a V_IN x V_OUT grid with I_IN on the array
+            curve (get_switch_op_fs_map, get_passive_sizing). Rather than
+            interpolate the losses themselves, the model minus measurement
+            residual at every bench point is interpolated (one Delaunay
+            triangulation for all channels) and added to the model evaluated
+            on the grid; the residual is smooth where the loss is not.
+            Grid points outside the measured hull are left as NaN.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import csv
+import re
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+from scipy.interpolate import LinearNDInterpolator
+from scipy.signal import lfilter
+
+from design_procedures.bench_automation import (
+    get_simulated_bench,
+    get_sweep_points,
+    run_sweep,
+)
+from design_procedures.calibration import default_calibration, get_calibration
+from design_procedures.converter_model import (
+    default_boost_design,
+    default_num_cells,
+    default_v_in_range,
+    default_v_out_range,
+    get_operating_grid,
+)
+from design_procedures.loss_calibration import fit_loss_calibration, get_loss_breakdown
+
+switch_grid = 35  # Points per axis of get_switch_op_fs_map
+passive_grid = 50  # Points per axis of get_passive_sizing
+
+# Power analyzer export columns (see get_column_key) and their record names.
+analyzer_columns = {
+    "time": "t",
+    "t": "t",
+    "u1": "v_in",
+    "vin": "v_in",
+    "i1": "i_in",
+    "iin": "i_in",
+    "p1": "p_in",
+    "pin": "p_in",
+    "u2": "v_out",
+    "vout": "v_out",
+    "i2": "i_out",
+    "iout": "i_out",
+    "p2": "p_out",
+    "pout": "p_out",
+    "fsw": "f_sw",
+}
+
+# Loss model terms seen by each thermal camera ROI, and the ROI thermal
+# resistance to ambient (C/W) and heat capacity (J/C) on the bench board.
+roi_groups = {
+    "sw": ("sw_con", "sw_swi"),
+    "l": ("l_dc", "l_ac", "core"),
+    "c": ("ci", "co"),
+}
+roi_r_th = {"sw": 15.0, "l": 20.0, "c": 40.0}
+roi_c_th = {"sw": 1.5, "l": 8.0, "c": 2.0}
+thermal_margin = 0.5  # s, frames either side of a window in the local fit
+
+
+def get_column_key(header):
+    """_summary_
+    Normalize an export header, e.g. "P1 [W]" to "p1" and "F_SW" to "fsw".
+
+    Args:
+        header (str): Column header
+
+    Returns:
+        str: Key.
+    """
+    header = re.sub(r"[\[\(].*?[\]\)]", "", header)
+    return re.sub(r"[\s_\-]", "", header).lower()
+
+
+def read_csv_columns(path):
+    """_summary_
+    Read a numeric CSV with a header row.
+
+    Args:
+        path (str): CSV path
+
+    Returns:
+        dict: Normalized header (see get_column_key) to np.ndarray.
+    """
+    with open(path, newline="") as file:
+        rows = list(csv.reader(file))
+    data = np.array(rows[1:], dtype=float).reshape(-1, len(rows[0]))
+    return {get_column_key(h): data[:, k] for k, h in enumerate(rows[0])}
+
+
+def load_analyzer_export(path):
+    """_summary_
+    Load a power analyzer export, or the CSV written by
+    bench_automation.save_sweep_csv.
+
+    Args:
+        path (str): CSV with time, U1, I1, P1, U2, I2, P2 and F_SW columns,
+            or their record names (t, v_in, ...). Units in brackets are
+            ignored.
+
+    Returns:
+        dict: Records with "t", "v_in", "i_in", "p_in", "v_out", "i_out",
+            "p_out" and "f_sw".
+    """
+    columns = read_csv_columns(path)
+    records = {
+        analyzer_columns[key]: x
+        for key, x in columns.items()
+        if key in analyzer_columns
+    }
+    missing = {"t", "v_in", "i_in", "p_in", "v_out", "p_out", "f_sw"} - set(records)
+    if missing:
+        raise Exception(f"{path} has no column for {sorted(missing)}")
+    return records
+
+
+def load_thermal_export(path, t_amb=None):
+    """_summary_
+    Load a thermal camera ROI export.
+
+    Args:
+        path (str): CSV with a time column, optionally an ambient ("t_amb" or
+            "ambient") column, and one temperature column per ROI, in C
+        t_amb (float, optional): Ambient temperature, in C, when the export
+            has no ambient column. Defaults to None.
+
+    Returns:
+        dict: "t" frame times, "t_amb" ambient per frame and "rois", ROI name
+            to temperature per frame.
+    """
+    columns = read_csv_columns(path)
+    t = columns.pop("time", None)
+    t = columns.pop("t") if t is None else t
+    amb = columns.pop("tamb", columns.pop("ambient", None))
+    if amb is None:
+        if t_amb is None:
+            raise Exception(f"{path} has no ambient column; pass t_amb")
+        amb = np.full_like(t, t_amb)
+    return {"t": t, "t_amb": amb, "rois": columns}
+
+
+def get_window_fit(t, x, t_0, t_1):
+    """_summary_
+    Fit a line to samples over each of a set of windows, with cumulative sums
+    so all windows are fit at once.
+
+    Args:
+        t (np.ndarray): Sample times, increasing
+        x (np.ndarray): Samples
+        t_0 (np.ndarray): Window starts
+        t_1 (np.ndarray): Window ends
+
+    Returns:
+        (np.ndarray, np.ndarray): Value at the window center and slope, NaN
+            for windows with fewer than two samples.
+    """
+    origin = t[0]
+    t = t - origin
+    sums = [np.concatenate([[0.0], np.cumsum(s)]) for s in (t, t * t, x, t * x)]
+    lo = np.searchsorted(t, t_0 - origin, side="left")
+    hi = np.searchsorted(t, t_1 - origin, side="right")
+    n = (hi - lo).astype(float)
+    s_t, s_tt, s_x, s_tx = (s[hi] - s[lo] for s in sums)
+    with np.errstate(divide="ignore", invalid="ignore"):
+        slope = (n * s_tx - s_t * s_x) / (n * s_tt - s_t**2)
+        center = (t_0 + t_1) / 2 - origin
+        value = (s_x - slope * s_t) / n + slope * center
+    bad = n < 2
+    value[bad] = np.nan
+    slope[bad] = np.nan
+    return value, slope
+
+
+def get_roi_losses(records, thermal, t_int, t_offset=0.0, margin=thermal_margin):
+    """_summary_
+    Get the loss of each thermal camera ROI during each analyzer window.
+
+    Args:
+        records (dict): Analyzer records, see load_analyzer_export
+        thermal (dict): Thermal export, see load_thermal_export
+        t_int (float): Analyzer window, in s
+        t_offset (float, optional): Camera clock minus analyzer clock, in s.
+            Defaults to 0.0.
+        margin (float, optional): Frames this far either side of the window
+            enter the fit, in s. Defaults to thermal_margin.
+
+    Returns:
+        dict: ROI name to loss per record, in W. ROIs without thermal
+            parameters (roi_r_th, roi_c_th) are skipped.
+    """
+    t_0 = records["t"] + t_offset - margin
+    t_1 = records["t"] + t_offset + t_int + margin
+    t_amb, _ = get_window_fit(thermal["t"], thermal["t_amb"], t_0, t_1)
+    losses = {}
+    for roi, temp in thermal["rois"].items():
+        if roi not in roi_r_th:
+            continue
+        value, slope = get_window_fit(thermal["t"], temp, t_0, t_1)
+        losses[roi] = roi_c_th[roi] * slope + (value - t_amb) / roi_r_th[roi]
+    return losses
+
+
+def interpolate_scattered(points, values, query):
+    """_summary_
+    Linearly interpolate scattered samples. Coordinates are scaled to unit
+    range and constant coordinates dropped before triangulating.
+
+    Args:
+        points (np.ndarray): (N, D) sample coordinates
+        values (np.ndarray): (N, K) samples
+        query (np.ndarray): (M, D) query coordinates
+
+    Returns:
+        np.ndarray: (M, K) interpolated values, NaN outside the hull of
+            the samples.
+    """
+    lo = points.min(axis=0)
+    span = np.ptp(points, axis=0)
+    keep = span > 0
+    points = (points[:, keep] - lo[keep]) / span[keep]
+    query = (query[:, keep] - lo[keep]) / span[keep]
+    if points.shape[1] == 1:
+        order = np.argsort(points[:, 0])
+        return np.stack(
+            [
+                np.interp(query[:, 0], points[order, 0], v[order], np.nan, np.nan)
+                for v in values.T
+            ],
+            axis=-1,
+        )
+    return LinearNDInterpolator(points, values)(query)
+
+
+def get_bench_maps(records, grid, f_sw, design=None, params=None, roi_losses=None):
+    """_summary_
+    Reconstruct measured efficiency and loss maps on a design grid and their
+    residuals against the loss model.
+
+    Args:
+        records (dict): Analyzer records, see load_analyzer_export
+        grid ((np.ndarray, ...)): V_IN, I_IN, V_OUT, see get_operating_grid
+        f_sw (float): Switching frequency of the maps, in Hz
+        design (dict, optional): Converter design. Defaults to
+            default_boost_design.
+        params (dict, optional): Loss model parameters. Defaults to
+            get_calibration().
+        roi_losses (dict, optional): ROI losses, see get_roi_losses.
+            Defaults to None.
+
+    Returns:
+        dict: Maps on the grid. "loss_model", "loss_meas" and "loss_residual"
+            (model - measured) in W; "eff_model", "eff_meas" and
+            "eff_residual"; and "<roi>_model", "<roi>_meas", "<roi>_residual"
+            for each ROI, in W.
+    """
+    design = default_boost_design if design is None else design
+    params = get_calibration() if params is None else params
+    roi_losses = {} if roi_losses is None else roi_losses
+
+    op = [records[k] for k in ("v_in", "i_in", "v_out", "f_sw")]
+    model = get_loss_breakdown(design, *op, params=params)
+    channels = [model["total"] - (records["p_in"] - records["p_out"])]
+    for roi, loss in roi_losses.items():
+        channels.append(sum(model[k] for k in roi_groups[roi]) - loss)
+    values = np.stack(channels, axis=-1)
+    valid = np.isfinite(values).all(axis=-1) & (records["p_in"] > 0)
+
+    v_in, i_in, v_out = grid
+    query = np.stack([v_in, i_in, v_out, np.full_like(v_in, f_sw)], axis=-1)
+    residual = interpolate_scattered(
+        np.stack(op, axis=-1)[valid], values[valid], query.reshape(-1, 4)
+    ).reshape(v_in.shape + (len(channels),))
+
+    grid_model = get_loss_breakdown(design, v_in, i_in, v_out, f_sw, params=params)
+    p_in = v_in * i_in
+    maps = {
+        "loss_model": grid_model["total"],
+        "loss_residual": residual[..., 0],
+        "loss_meas": grid_model["total"] - residual[..., 0],
+    }
+    with np.errstate(divide="ignore", invalid="ignore"):
+        maps["eff_model"] = 1 - maps["loss_model"] / p_in
+        maps["eff_meas"] = 1 - maps["loss_meas"] / p_in
+    maps["eff_residual"] = maps["eff_model"] - maps["eff_meas"]
+    for k, roi in enumerate(roi_losses):
+        maps[f"{roi}_model"] = sum(grid_model[key] for key in roi_groups[roi])
+        maps[f"{roi}_residual"] = residual[..., k + 1]
+        maps[f"{roi}_meas"] = maps[f"{roi}_model"] - residual[..., k + 1]
+    return maps
+
+
+def get_simulated_thermal_export(sim, t_end, frame_rate=10, t_amb=25, seed=1):
+    """_summary_
+    Get the thermal camera export of a simulated bench: each ROI heats with
+    its loss through its R_TH and C_TH, and frames carry 0.05 C noise.
+
+    Args:
+        sim (SimulatedBench): Simulated bench after a sweep
+        t_end (float): Last frame time, in s
+        frame_rate (float, optional): Frames per s. Defaults to 10.
+        t_amb (float, optional): Ambient temperature, in C. Defaults to 25.
+        seed (int, optional): Random seed. Defaults to 1.
+
+    Returns:
+        dict: Thermal export, see load_thermal_export.
+    """
+    rng = np.random.default_rng(seed)
+    t = np.arange(0, t_end, 1 / frame_rate)
+    v_in, i_in, v_out = sim.get_actual(t).T
+    on = (i_in > 1e-3) & (v_out > v_in)
+    loss = get_loss_breakdown(
+        sim.design, v_in[on], i_in[on], v_out[on], sim.get_f_sw(t[on]), sim.params
+    )
+    rois = {}
+    for roi, keys in roi_groups.items():
+        p = np.zeros_like(t)
+        p[on] = sum(loss[k] for k in keys)
+        a = np.exp(-1 / (frame_rate * roi_r_th[roi] * roi_c_th[roi]))
+        rise = lfilter([1 - a], [1, -a], roi_r_th[roi] * p)
+        rois[roi] = t_amb + rise + rng.normal(0, 0.05, len(t))
+    return {"t": t, "t_amb": np.full_like(t, t_amb), "rois": rois}
+
+
+def get_bench_data_map(grid, maps):
+    """_summary_
+    Plot the measured and model efficiency, their residual, and the residual
+    of each ROI loss over the V_IN x V_OUT grid.
+
+    Args:
+        grid ((np.ndarray, ...)): V_IN, I_IN, V_OUT, see get_operating_grid
+        maps (dict): Maps, see get_bench_maps
+    """
+    v_in, _, v_out = grid
+    rois = [key[: -len("_residual")] for key in maps if key.endswith("_residual")]
+    rois = [roi for roi in rois if roi not in ("loss", "eff")]
+    panels = [
+        ("eff_meas", "Measured efficiency (%)", 100, "viridis"),
+        ("eff_model", "Model efficiency (%)", 100, "viridis"),
+        ("eff_residual", "Model - measured efficiency (%)", 100, "coolwarm"),
+    ] + [
+        (f"{r}_residual", f"{r} model - measured loss (W)", 1, "coolwarm") for r in rois
+    ]
+
+    cols = 3
+    rows = -(-len(panels) // cols)
+    fig, axs = plt.subplots(rows, cols, figsize=(6 * cols, 5 * rows), squeeze=False)
+    for ax, (key, title, scale, cmap) in zip(axs.flat, panels):
+        z = np.ma.masked_invalid(maps[key] * scale)
+        if cmap == "coolwarm":
+            lim = np.nanmax(np.abs(z)) if z.count() else 1
+            mesh = ax.pcolormesh(v_in, v_out, z, cmap=cmap, vmin=-lim, vmax=lim)
+        else:
+            mesh = ax.pcolormesh(v_in, v_out, z, cmap=cmap)
+        fig.colorbar(mesh, ax=ax)
+        ax.set_title(title)
+        ax.set_xlabel("V_IN (V)")
+        ax.set_ylabel("V_OUT (V)")
+    for ax in axs.flat[len(panels) :]:
+        ax.axis("off")
+
+    fig.tight_layout()
+    plt.savefig("bench_data_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    num_cells = default_num_cells
+    v_in_range = default_v_in_range
+    v_out_range = default_v_out_range
+    f_sw = 100e3
+    t_int = 2.0  # s, long enough windows for the thermal fit
+
+    # Simulated bench whose converter differs from the datasheet model, as in
+    # loss_calibration. Export both instruments and read them back.
+    truth = dict(
+        default_calibration,
+        k_r_ds_on=1.35,
+        k_e_oss=1.6,
+        k_ac=3.0,
+        k_core=3.2,
+        alpha=1.5,
+        beta=2.7,
+        p_fixed=0.85,
+    )
+    bench = get_simulated_bench(params=truth)
+    points = get_sweep_points(
+        np.linspace(18, 78, 11),
+        np.linspace(0.25, 6.5, 11),
+        v_out_range,
+        [50e3, 100e3, 150e3, 200e3],
+    )
+    records, elapsed = run_sweep(bench, points, t_int=t_int)
+    thermal = get_simulated_thermal_export(bench["sim"], bench["clock"].now())
+
+    columns = ["t", "v_in", "i_in", "p_in", "v_out", "i_out", "p_out", "f_sw"]
+    np.savetxt(
+        "analyzer_export.csv",
+        np.column_stack([records[k] for k in columns]),
+        delimiter=",",
+        header="Time[s],U1[V],I1[A],P1[W],U2[V],I2[A],P2[W],FSW[Hz]",
+        comments="",
+    )
+    np.savetxt(
+        "thermal_export.csv",
+        np.column_stack([thermal["t"], thermal["t_amb"], *thermal["rois"].values()]),
+        delimiter=",",
+        header="Time [s],Ambient [C]," + ",".join(thermal["rois"]),
+        comments="",
+    )
+    print(
+        f"Exported {len(points)} analyzer windows and {len(thermal['t'])} "
+        f"camera frames ({elapsed / 60 :.0f} min of bench time)"
+    )
+
+    start = time.perf_counter()
+    records = load_analyzer_export("analyzer_export.csv")
+    thermal = load_thermal_export("thermal_export.csv")
+    roi_losses = get_roi_losses(records, thermal, t_int)
+    grid = get_operating_grid(v_in_range, v_out_range, num_cells, switch_grid)
+    maps = get_bench_maps(records, grid, f_sw, roi_losses=roi_losses)
+    print(f"Processed in {time.perf_counter() - start :.2f} s")
+
+    covered = np.isfinite(maps["loss_residual"]).mean() * 100
+    print(f"{covered :.0f} % of the {switch_grid} x {switch_grid} grid measured")
+    for key in ["eff"] + list(roi_losses):
+        residual = maps[f"{key}_residual"]
+        scale, unit = (100, "%") if key == "eff" else (1, "W")
+        print(
+            f"{key:>4} residual: mean {np.nanmean(residual) * scale :+.3f} {unit}, "
+            f"max |{np.nanmax(np.abs(residual)) * scale :.3f}| {unit}"
+        )
+
+    # The same data calibrates the model, after which the residuals vanish.
+    params, _, _ = fit_loss_calibration(records)
+    calibrated = get_bench_maps(
+        records, grid, f_sw, params=params, roi_losses=roi_losses
+    )
+    print(
+        f"After calibration, eff residual max "
+        f"|{np.nanmax(np.abs(calibrated['eff_residual'])) * 100 :.3f}| %"
+    )
+
+    get_bench_data_map(grid, maps)
@@ -0,0 +1,75 @@
+"""_summary_
+@file       calibration.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Loss model parameters shared by the design procedures.
+
+            The defaults are the datasheet models: the switch R_DS_ON and
+            C_OSS as given, the inductor winding at its DC resistance, and
+            a Steinmetz fit of TDK N97 at 100 C for the core,
+                P_V = K_CORE F_EQ^(ALPHA - 1) B^BETA F   (W/m^3, Hz, T)
+            with the equivalent frequency F_EQ = 2 F / (PI^2 D (1 - D)) of
+            the triangular flux of the boost inductor.
+
+            loss_calibration fits them to measured efficiency and writes
+            calibration.json next to this file; every procedure then picks
+            the calibrated values up through get_calibration.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import json
+import os
+
+calibration_file = os.path.join(os.path.dirname(__file__), "calibration.json")
+
+default_calibration = {
+    "k_r_ds_on": 1.0,  # Effective R_DS_ON over the datasheet value
+    "k_e_oss": 1.0,  # Effective C_OSS switching energy over the datasheet
+    "k_ac": 1.0,  # Winding resistance seen by the ripple over the DC value
+    "k_core": 1.97,  # Steinmetz coefficient, W/m^3
+    "alpha": 1.4,  # Steinmetz frequency exponent
+    "beta": 2.6,  # Steinmetz flux density exponent
+    "p_fixed": 0.1,  # W, fixed power path loss (dividers, bias, leakage)
+}
+
+_cache = {}
+
+
+def get_calibration(path=calibration_file):
+    """_summary_
+    Get the loss model parameters, the calibrated values where a calibration
+    file exists and the defaults otherwise.
+
+    Args:
+        path (str, optional): Calibration file. Defaults to calibration_file.
+
+    Returns:
+        dict: Parameters, see default_calibration.
+    """
+    if path not in _cache:
+        params = dict(default_calibration)
+        if os.path.exists(path):
+            with open(path) as file:
+                params.update(json.load(file))
+        _cache[path] = params
+    return _cache[path]
+
+
+def save_calibration(params, path=calibration_file):
+    """_summary_
+    Write the loss model parameters for the design procedures.
+
+    Args:
+        params (dict): Parameters, see default_calibration
+        path (str, optional): Calibration file. Defaults to calibration_file.
+
+    Returns:
+        str: Path of the written file.
+    """
+    with open(path, "w") as file:
+        json.dump(
+            {key: float(params[key]) for key in default_calibration}, file, indent=4
+        )
+        file.write("\n")
+    _cache.pop(path, None)
+    return path
@@ -0,0 +1,287 @@
+"""_summary_
+@file       cell_temperature.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Dynamic cell temperature of the array on a moving vehicle.
+
+            Each cell is a lumped thermal capacitance per unit area,
+                C dT/dt = A (1 - ETA) G - H (T - T_AMB) - H_R (T_AMB - T_SKY),
+                H       = H_C(V_AIR) + H_R + H_B,
+            heated by the absorbed irradiance that is not turned into
+            electrical power, cooled by forced convection over the top surface
+            at the air speed relative to the vehicle (the Test et al. flat
+            plate correlation H_C = 8.55 + 2.56 V_AIR), by linearized
+            radiation to a sky colder than the air, and by conduction through
+            the insulated body shell.
+
+            With the inputs held over a time step the update is exact,
+                T_K = a_K T_K-1 + (1 - a_K) T_SS,K,  a_K = exp(-H_K DT / C),
+            a first order recurrence with time varying coefficients. It is
+            solved over long traces without a loop per sample: the trace is
+            cut into blocks short enough that the product of the a_K in a
+            block cannot underflow, every block is solved from a zero state
+            with cumulative sums in log space, and only the block boundaries
+            are chained one after another.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.irradiance_model import stream_irradiance
+from design_procedures.mppt_tuning import get_array_mpp, get_test_profiles, tune_mppt
+from design_procedures.shading_model import get_array_layout, get_example_route
+from design_procedures.solar_position import (
+    get_erbs_decomposition,
+    get_extraterrestrial,
+    get_poa_irradiance,
+    get_solar_position,
+    get_world_normals,
+)
+
+heat_capacity = 1500.0  # J/m^2/K, cells, encapsulant and composite skin
+absorptance = 0.9  # Share of the irradiance absorbed by the cell
+efficiency = 0.22  # Share of the irradiance leaving as electrical power
+emissivity = 0.85  # Thermal emissivity of the encapsulant
+h_back = 1.5  # W/m^2/K, through the body shell to the cabin air
+sky_depression = 20.0  # K, sky below the air temperature on a clear day
+max_decay = 20.0  # Largest log decay within a block of the recurrence
+max_block = 4096  # Samples per block of the recurrence
+
+
+def get_air_speed(speed, heading, wind_speed=0.0, wind_direction=0.0):
+    """_summary_
+    Get the speed of the air over the vehicle.
+
+    Args:
+        speed (np.ndarray): Vehicle speed (m/s)
+        heading (np.ndarray): Heading, clockwise from north (rad)
+        wind_speed (np.ndarray, optional): Wind speed (m/s). Defaults to 0.
+        wind_direction (np.ndarray, optional): Direction the wind blows from,
+            clockwise from north (rad). Defaults to 0.
+
+    Returns:
+        np.ndarray: Relative air speed (m/s).
+    """
+    east = -wind_speed * np.sin(wind_direction) - speed * np.sin(heading)
+    north = -wind_speed * np.cos(wind_direction) - speed * np.cos(heading)
+    return np.hypot(east, north)
+
+
+def get_linear_recurrence(a, b, x_0):
+    """_summary_
+    Solve x_k = a_k x_k-1 + b_k along the last axis, for 0 < a_k <= 1.
+
+    Args:
+        a (np.ndarray): Decay per sample, (..., K)
+        b (np.ndarray): Input per sample, (..., K)
+        x_0 (np.ndarray): State before the first sample, (...)
+
+    Returns:
+        np.ndarray: State after every sample, (..., K).
+    """
+    a, b = np.broadcast_arrays(np.asarray(a, dtype=float), np.asarray(b, dtype=float))
+    num_samples = a.shape[-1]
+    log_a = np.log(a)
+    worst = -log_a.min() if num_samples else 0.0
+    block = int(np.clip(max_decay / max(worst, 1e-12), 1, min(max_block, num_samples)))
+    num_blocks = -(-num_samples // block)
+    pad = [(0, 0)] * (a.ndim - 1) + [(0, num_blocks * block - num_samples)]
+    log_a = np.pad(log_a, pad).reshape(a.shape[:-1] + (num_blocks, block))
+    b = np.pad(b, pad).reshape(log_a.shape)
+
+    # Within a block from a zero state, x_k = exp(L_k) sum_j<=k b_j exp(-L_j).
+    decay = np.exp(np.cumsum(log_a, axis=-1))
+    x = decay * np.cumsum(b / decay, axis=-1)
+
+    # Chain the blocks.
+    start = np.empty(log_a.shape[:-1])
+    state = np.broadcast_to(np.asarray(x_0, dtype=float), a.shape[:-1])
+    for i in range(num_blocks):
+        start[..., i] = state
+        state = decay[..., i, -1] * state + x[..., i, -1]
+    x = x + decay * start[..., None]
+    return x.reshape(a.shape[:-1] + (-1,))[..., :num_samples]
+
+
+def get_heat_balance(g, t_amb, v_air, sky_view=1.0):
+    """_summary_
+    Get the total heat transfer coefficient and the steady state cell
+    temperature.
+
+    Args:
+        g (np.ndarray): Plane of array irradiance (W/m^2)
+        t_amb (np.ndarray): Air temperature (K)
+        v_air (np.ndarray): Air speed over the array (m/s)
+        sky_view (np.ndarray, optional): Share of the sky radiation exchange,
+            (1 + N_Z) / 2 for a tilted cell and lower under cloud. Defaults
+            to 1.
+
+    Returns:
+        (np.ndarray, np.ndarray): H (W/m^2/K) and T_SS (K).
+    """
+    h_r = 4 * emissivity * 5.670374e-8 * np.asarray(t_amb) ** 3
+    h = 8.55 + 2.56 * np.asarray(v_air) + h_r + h_back
+    q = absorptance * (1 - efficiency) * np.asarray(g) - h_r * sky_depression * sky_view
+    return (h, t_amb + q / h)
+
+
+def get_cell_temperature(g, t_amb, v_air, dt=1.0, t_init=None, sky_view=1.0):
+    """_summary_
+    Get the cell temperature over a trace, time along the last axis.
+
+    Args:
+        g (np.ndarray): Plane of array irradiance (W/m^2), (..., K)
+        t_amb (np.ndarray): Air temperature (K), (K) or (..., K)
+        v_air (np.ndarray): Air speed over the array (m/s), (K) or (..., K)
+        dt (float, optional): Time step (s). Defaults to 1.
+        t_init (np.ndarray, optional): Cell temperature before the first
+            sample (K), (...). Defaults to the steady state of the first
+            sample.
+        sky_view (np.ndarray, optional): Share of the sky radiation exchange,
+            see get_heat_balance. Defaults to 1.
+
+    Returns:
+        (np.ndarray, np.ndarray): Cell temperature (K), (..., K), and the last
+            sample (to seed the next chunk).
+    """
+    h, t_ss = get_heat_balance(g, t_amb, v_air, sky_view)
+    h, t_ss = np.broadcast_arrays(h, t_ss)
+    a = np.exp(-h * dt / heat_capacity)
+    if t_init is None:
+        t_init = t_ss[..., 0]
+    t_cell = get_linear_recurrence(a, (1 - a) * t_ss, t_init)
+    return (t_cell, t_cell[..., -1])
+
+
+def get_cell_temperature_map(hours, g, t_cell, t_static, p):
+    """_summary_
+    Plot the irradiance, the cell temperature and the array power of a
+    mission.
+
+    Args:
+        hours (np.ndarray): Time (h)
+        g (np.ndarray): Mean plane of array irradiance (W/m^2)
+        t_cell (np.ndarray): Cell temperature while driving (K), (N, T)
+        t_static (np.ndarray): Steady state cell temperature (K), (T)
+        p (dict): Array power per temperature model (W)
+    """
+    fig, axs = plt.subplots(3, 1, figsize=(16, 14), sharex=True)
+    ax = axs[0]
+    ax.plot(hours, g)
+    ax.set_ylabel("Irradiance (W/m^2)")
+    ax.set_title("Mean plane of array irradiance")
+    ax.grid(True)
+
+    ax = axs[1]
+    ax.fill_between(
+        hours,
+        t_cell.min(axis=0) - 273.15,
+        t_cell.max(axis=0) - 273.15,
+        alpha=0.3,
+        label="Cell spread",
+    )
+    ax.plot(hours, t_cell.mean(axis=0) - 273.15, label="Dynamic, mean")
+    ax.plot(hours, t_static - 273.15, label="Steady state", alpha=0.7)
+    ax.set_ylabel("Temperature (C)")
+    ax.grid(True)
+    ax.legend()
+
+    ax = axs[2]
+    for name, value in p.items():
+        ax.plot(hours, value, label=name, alpha=0.8)
+    ax.set_xlabel("Time (h)")
+    ax.set_ylabel("Array power (W)")
+    ax.grid(True)
+    ax.legend()
+
+    plt.savefig("cell_temperature_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    num_cells = 111
+    dt = 1.0
+
+    # Integrator throughput over a day of every cell at 1 s.
+    rng = np.random.default_rng(0)
+    g_bench = rng.uniform(0, 1000, (num_cells, 86400))
+    start = time.perf_counter()
+    get_cell_temperature(g_bench, 303.15, rng.uniform(0, 25, 86400), dt)
+    elapsed = time.perf_counter() - start
+    print(f"Integrator: {g_bench.size / elapsed / 1e6:.1f} M cell samples/s")
+
+    # A race day, 09:00 to 17:00 CDT, with a 5 min control stop every hour.
+    duration = 8 * 3600
+    t = np.datetime64("2026-06-21T14:00:00") + np.arange(duration).astype(
+        "timedelta64[s]"
+    )
+    zenith, azimuth, distance = get_solar_position(t)
+    i_0 = get_extraterrestrial(distance)
+    cos_z = np.maximum(np.cos(zenith), 1e-3)
+    stream = stream_irradiance("temperate", seed=3, duration=duration, dt=dt)
+    k = np.concatenate([chunk["k"] for chunk in stream])[:duration]
+    ghi = 1098 * cos_z * np.exp(-0.057 / cos_z) * k
+    dni, dhi = get_erbs_decomposition(ghi, zenith, i_0)
+
+    route, _, _ = get_example_route(duration=duration, dt=dt)
+    speed = np.where(route["t"] % 3600 < 3300, 15.0, 0.0)
+    _, normals = get_array_layout(num_cells)
+    world = get_world_normals(normals, route["heading"])
+    g = get_poa_irradiance(world, zenith, azimuth, dni, dhi, ghi, i_0).T
+    t_amb = 273.15 + 30 + 5 * np.sin(np.pi * route["t"] / duration)
+    v_air = get_air_speed(speed, route["heading"], 3.0, np.pi)
+    sky_view = (1 + normals[:, 2, None]) / 2 * k.clip(0, 1)
+
+    t_cell, _ = get_cell_temperature(g, t_amb, v_air, dt, sky_view=sky_view)
+    t_parked, _ = get_cell_temperature(
+        g, t_amb, get_air_speed(0.0, route["heading"], 3.0, np.pi), dt
+    )
+    # The steady state, with no thermal lag.
+    t_static = get_heat_balance(g, t_amb, v_air, sky_view)[1]
+
+    # Uniform string at the mean cell irradiance and temperature.
+    g_mean = g.mean(axis=0)
+    p = {
+        "25 C": get_array_mpp(num_cells, g_mean, 298.15)[1],
+        "Steady state": get_array_mpp(num_cells, g_mean, t_static.mean(axis=0))[1],
+        "Dynamic": get_array_mpp(num_cells, g_mean, t_cell.mean(axis=0))[1],
+        "Dynamic, parked": get_array_mpp(num_cells, g_mean, t_parked.mean(axis=0))[1],
+    }
+    print(
+        f"Cell temperature driving: mean {t_cell.mean() - 273.15:.1f} C, "
+        f"peak {t_cell.max() - 273.15:.1f} C; parked peak "
+        f"{t_parked.max() - 273.15:.1f} C"
+    )
+    for name, value in p.items():
+        print(f"{name:>16}: {value.sum() * dt / 3.6e6:.3f} kWh")
+
+    # Retune the tracker with the cells heating and cooling through the test
+    # profiles at driving speed.
+    dt_mppt = 2e-3
+    names, profiles = get_test_profiles(dt_mppt)
+    t_profiles, _ = get_cell_temperature(profiles, 303.15, 15.0, dt_mppt)
+    for name, t in [("25 C", 298.15), ("dynamic", t_profiles)]:
+        params, _ = tune_mppt(num_cells, dt=dt_mppt, t=t)
+        print(
+            f"MPPT tuned at {name} cells: step {params['step']:.3f} V, period "
+            f"{params['period'] * 1e3:.0f} ms, K_A {params['gain']} V, "
+            f"efficiency {params['efficiency'] * 100:.2f} %"
+        )
+
+    get_cell_temperature_map(
+        route["t"] / 3600, g_mean, t_cell, t_static.mean(axis=0), p
+    )
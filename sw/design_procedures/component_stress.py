@@ -0,0 +1,209 @@
+"""_summary_
+@file       component_stress.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Analytic component stress (average, RMS, peak, ripple spectrum)
+            for the synchronous DC-DC boost converter.
+
+            In forced CCM every current in the converter is piecewise linear
+            over a switching period with breakpoints at 0 and D / F_SW:
+
+            - I_L rises from I_MIN to I_MAX while SW1 conducts, then falls.
+            - SW1 carries I_L during D, SW2 carries I_L during (1 - D).
+            - C_I carries the AC part of I_L (the array is a DC source).
+            - C_O carries I_SW2 - I_OUT (the battery takes the DC part).
+
+            A linear segment of fractional length d from a to b contributes
+                mean        d (a + b) / 2
+                mean square d (a^2 + a b + b^2) / 3
+            and the Fourier coefficients follow from the jumps J_K and slope
+            changes S_K (per period) at each breakpoint T_K (fraction of the
+            period), with w = 2 pi n:
+                c_n = sum(J_K e^(-jwT_K) / (jw) + S_K e^(-jwT_K) / (jw)^2)
+
+            Every function takes floats or broadcastable numpy arrays.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import math as m
+
+import numpy as np
+
+
+def get_inductor_ripple(v_in, v_out, f_sw, l, eff=1.0):
+    """_summary_
+    Get the peak to peak inductor current ripple.
+
+    Args:
+        v_in (float|np.ndarray): Input voltage
+        v_out (float|np.ndarray): Output voltage
+        f_sw (float|np.ndarray): Switching frequency
+        l (float|np.ndarray): Inductance
+        eff (float, optional): Efficiency of converter. Defaults to 1.0.
+
+    Returns:
+        float|np.ndarray: Peak to peak inductor current.
+    """
+    duty = 1 - v_in * eff / v_out
+    return v_in * duty / (f_sw * l)
+
+
+def get_segment_stats(d, a, b):
+    """_summary_
+    Get the contribution of a linear segment to the mean and mean square of a
+    periodic waveform.
+
+    Args:
+        d (float|np.ndarray): Fraction of the period spanned by the segment
+        a (float|np.ndarray): Value at the start of the segment
+        b (float|np.ndarray): Value at the end of the segment
+
+    Returns:
+        (float|np.ndarray, float|np.ndarray): Mean and mean square
+            contributions.
+    """
+    return (d * (a + b) / 2, d * (a**2 + a * b + b**2) / 3)
+
+
+def get_triangle_stress(i_avg, i_pp):
+    """_summary_
+    Get the stress of a triangular (inductor) current.
+
+    Args:
+        i_avg (float|np.ndarray): Average current
+        i_pp (float|np.ndarray): Peak to peak ripple
+
+    Returns:
+        (float|np.ndarray, ...): Average, RMS, peak and peak to peak current.
+    """
+    i_rms = np.sqrt(i_avg**2 + i_pp**2 / 12)
+    return (i_avg, i_rms, i_avg + i_pp / 2, i_pp)
+
+
+def get_piecewise_linear_spectrum(t_k, jumps, slopes, num_harmonics):
+    """_summary_
+    Get the harmonic amplitudes of a periodic piecewise linear waveform.
+
+    Args:
+        t_k ([float|np.ndarray]): Breakpoints, as a fraction of the period
+        jumps ([float|np.ndarray]): Step f(t+) - f(t-) at each breakpoint
+        slopes ([float|np.ndarray]): Change of slope f'(t+) - f'(t-) at each
+            breakpoint, in units per period
+        num_harmonics (int): Number of harmonics to compute
+
+    Returns:
+        np.ndarray: Peak amplitude of harmonics 1..N, in the last axis.
+    """
+    n = np.arange(1, num_harmonics + 1)
+    jw = 2j * m.pi * n
+    c_n = 0
+    for t, jump, slope in zip(t_k, jumps, slopes):
+        t = np.asarray(t)[..., None]
+        e = np.exp(-jw * t)
+        c_n = (
+            c_n
+            + (np.asarray(jump)[..., None] / jw + np.asarray(slope)[..., None] / jw**2)
+            * e
+        )
+    return 2 * np.abs(c_n)
+
+
+def get_component_stress(v_in, i_in, v_out, f_sw, i_l_pp, eff=1.0, num_harmonics=0):
+    """_summary_
+    Get the stress of SW1, SW2, L, C_I and C_O at a set of operating points.
+
+    Args:
+        v_in (float|np.ndarray): Input voltage
+        i_in (float|np.ndarray): Input current
+        v_out (float|np.ndarray): Output voltage
+        f_sw (float|np.ndarray): Switching frequency
+        i_l_pp (float|np.ndarray): Peak to peak inductor current ripple, see
+            get_inductor_ripple
+        eff (float, optional): Efficiency of converter, applied to the duty
+            cycle and output current as in get_switch_duty_cycle_map. Defaults
+            to 1.0.
+        num_harmonics (int, optional): Number of ripple harmonics to compute.
+            Defaults to 0 (no spectrum).
+
+    Returns:
+        dict: For each of "sw1", "sw2", "l", "ci", "co", a dict of:
+            i_avg - average current
+            i_rms - RMS current
+            i_pk - peak (absolute) current
+            i_pp - peak to peak current
+            v_pk - peak voltage stress
+            i_spectrum - harmonic amplitudes 1..N of the current, at
+                multiples of F_SW (only if num_harmonics > 0)
+        and "duty", the SW1 duty cycle.
+    """
+    duty = 1 - v_in * eff / v_out
+    i_out = v_in * i_in * eff / v_out
+    i_min = i_in - i_l_pp / 2
+    i_max = i_in + i_l_pp / 2
+
+    # Slopes of I_L in units per period.
+    s_on = i_l_pp / duty
+    s_off = -i_l_pp / (1 - duty)
+
+    stress = {"duty": duty}
+
+    # Inductor.
+    i_avg, i_rms, i_pk, i_pp = get_triangle_stress(i_in, i_l_pp)
+    stress["l"] = {
+        "i_avg": i_avg,
+        "i_rms": i_rms,
+        "i_pk": np.maximum(abs(i_max), abs(i_min)),
+        "i_pp": i_pp,
+        "v_pk": np.maximum(v_in, v_out - v_in),
+    }
+
+    # Switches.
+    sw1_avg, sw1_ms = get_segment_stats(duty, i_min, i_max)
+    sw2_avg, sw2_ms = get_segment_stats(1 - duty, i_max, i_min)
+    stress["sw1"] = {
+        "i_avg": sw1_avg,
+        "i_rms": np.sqrt(sw1_ms),
+        "i_pk": np.maximum(abs(i_max), abs(i_min)),
+        "i_pp": i_max - np.minimum(i_min, 0),
+        "v_pk": v_out,
+    }
+    stress["sw2"] = {
+        "i_avg": sw2_avg,
+        "i_rms": np.sqrt(sw2_ms),
+        "i_pk": np.maximum(abs(i_max), abs(i_min)),
+        "i_pp": i_max - np.minimum(i_min, 0),
+        "v_pk": v_out,
+    }
+
+    # Capacitors. C_I sees the ripple of I_L, C_O sees SW2 less the output.
+    stress["ci"] = {
+        "i_avg": 0 * i_in,
+        "i_rms": i_l_pp / m.sqrt(12),
+        "i_pk": i_l_pp / 2,
+        "i_pp": i_l_pp,
+        "v_pk": v_in,
+    }
+    stress["co"] = {
+        "i_avg": sw2_avg - i_out,
+        "i_rms": np.sqrt(np.maximum(sw2_ms - 2 * sw2_avg * i_out + i_out**2, 0)),
+        "i_pk": np.maximum(abs(i_max - i_out), abs(i_out)),
+        "i_pp": i_max - np.minimum(i_min, 0),
+        "v_pk": v_out,
+    }
+
+    if num_harmonics > 0:
+        t_k = (0 * duty, duty)
+        d_s = s_on - s_off
+        spectra = {
+            "l": ((0, 0), (d_s, -d_s)),
+            "sw1": ((i_min, -i_max), (s_on, -s_on)),
+            "sw2": ((-i_min, i_max), (-s_off, s_off)),
+            "ci": ((0, 0), (-d_s, d_s)),
+            "co": ((-i_min, i_max), (-s_off, s_off)),
+        }
+        for key, (jumps, slopes) in spectra.items():
+            stress[key]["i_spectrum"] = get_piecewise_linear_spectrum(
+                t_k, jumps, slopes, num_harmonics
+            )
+
+    return stress
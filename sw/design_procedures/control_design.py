@@ -0,0 +1,664 @@
+"""_summary_
+@file       control_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Digital control design of the array side input voltage loop of the
+            synchronous DC-DC boost converter.
+
+            The plant is the small signal duty cycle to V_IN transfer function
+            of the averaged converter, built by state space averaging of the
+            subinterval matrices in converter_model:
+                A   = D A_ON + (1 - D) A_OFF
+                B_D = (A_ON - A_OFF) X + (B_ON - B_OFF) U
+
+            The loop is closed once per switching period, T_S = 1 / F_SW:
+            - V_IN is sampled T_SAMP into the period,
+            - the ADC conversion and the computation take T_ADC + T_CALC,
+            - the new duty cycle is loaded from the shadow register at the
+              next period boundary after that,
+            - the trailing edge modulator adds a further D T_S.
+            The total delay T_D = N T_S + TAU from sample to duty edge is
+            discretized exactly along with the zero order hold of the
+            modulator: over [k T_S, (k + 1) T_S) the plant sees u[k - N - 1]
+            for TAU and then u[k - N], so
+                x[k + 1] = PHI x[k] + GAMMA_A u[k - N - 1] + GAMMA_B u[k - N]
+                GAMMA_B  = int_0^(T_S - TAU) e^(A s) ds B
+                GAMMA_A  = e^(A (T_S - TAU)) int_0^TAU e^(A s) ds B
+
+            The compensator is a discrete PI, C(z) = K_P + K_I T_S z / (z - 1).
+            The achievable bandwidth of a plant is the highest crossover
+            frequency, over a few zero placements, with a single gain crossing
+            and phase and gain margins that meet their targets up to Nyquist.
+            Below the array maximum power point the array is nearly a current
+            source, the L C_I resonance is barely damped, and the gain margin
+            at the resonance usually forces an integral dominant design.
+            get_pi_at_crossover instead places the PI at a given crossover,
+            for the gain schedule of gain_schedule.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import math as m
+import sys
+
+import matplotlib.pyplot as plt
+import numpy as np
+from scipy.linalg import expm
+
+from design_procedures.converter_model import (
+    default_boost_design,
+    get_boost_state_space,
+    get_pv_norton,
+)
+from design_procedures.nonideal_model import model_nonideal_cell_vec
+
+t_adc = 1e-6  # s, ADC conversion
+t_calc = 2e-6  # s, control law computation
+pm_min = 45  # deg
+gm_min = 6  # dB
+zero_ratios = [5, 2, 1, 0.5, 0]  # W_C / W_Z of the PI, 0 for integral only
+
+# Requirements, see docs/DESIGN.md.
+slew_min = 80  # V/s, minimum input response rate
+v_step = 0.725  # V, input control resolution
+
+
+def get_vin_plant(design, v_in, v_out, num_cells, g=1000, t=298.15):
+    """_summary_
+    Get the small signal duty cycle to V_IN model of the averaged converter
+    at an operating point.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in (float): Array voltage
+        v_out (float): Output voltage
+        num_cells (int): Number of solar cells in series
+        g (float, optional): Irradiance (W/m^2). Defaults to 1000.
+        t (float, optional): Cell temperature (K). Defaults to 298.15.
+
+    Returns:
+        (np.ndarray, np.ndarray, np.ndarray, float): A (3x3), B_D (3), C (3)
+            such that v_in = C x, and the steady state duty cycle.
+    """
+    i_in = float(model_nonideal_cell_vec(g, t, 0, 100, v_in / num_cells)[0])
+    i_s, r_pv = get_pv_norton(v_in, i_in, num_cells, g, t)
+    r = design["r_dcr"] + design["r_ds_on"]
+    duty = 1 - (v_in - i_in * r) / v_out
+    v_b = v_out - design["r_b"] * (1 - duty) * i_in
+    u = np.array([i_s, v_b])
+
+    a_on, b_on, a_off, b_off = get_boost_state_space(
+        design, design["r_ds_on"], design["r_ds_on"], r_pv
+    )
+    a = duty * a_on + (1 - duty) * a_off
+    b = duty * b_on + (1 - duty) * b_off
+    x = -np.linalg.solve(a, b @ u)
+    b_d = (a_on - a_off) @ x + (b_on - b_off) @ u
+
+    # V_IN = g (V_CI + R_CI (I_S - I_L)), the input row of get_output_map.
+    k = 1 / (1 + design["r_ci"] / r_pv)
+    c = np.array([-k * design["r_ci"], k, 0])
+    return (a, b_d, c, duty)
+
+
+def get_loop_delay(f_sw, duty, t_adc=t_adc, t_calc=t_calc, t_samp=0.0):
+    """_summary_
+    Get the delay from the V_IN sample to the duty cycle edge that acts on it.
+
+    Args:
+        f_sw (float|np.ndarray): Switching (and sampling) frequency
+        duty (float|np.ndarray): SW1 duty cycle
+        t_adc (float, optional): ADC conversion time. Defaults to t_adc.
+        t_calc (float, optional): Computation time. Defaults to t_calc.
+        t_samp (float, optional): Sample instant after the start of the
+            period. Defaults to 0.
+
+    Returns:
+        float|np.ndarray: Total delay T_D.
+    """
+    t_s = 1 / np.asarray(f_sw)
+    # The shadow register is loaded at the first period boundary after the
+    # result is ready.
+    t_update = np.ceil((t_samp + t_adc + t_calc) / t_s) * t_s
+    return t_update - t_samp + duty * t_s
+
+
+def get_delayed_discretization(a, b, t_s, t_d):
+    """_summary_
+    Exactly discretize a plant behind a zero order hold and a delay.
+
+    Args:
+        a (np.ndarray): State matrix, (..., n, n)
+        b (np.ndarray): Input vector, (..., n)
+        t_s (float|np.ndarray): Sample period
+        t_d (float|np.ndarray): Delay
+
+    Returns:
+        (np.ndarray, ...): PHI, GAMMA_A, GAMMA_B and the integer delay N.
+    """
+    a, b = np.asarray(a), np.asarray(b)
+    shape = np.broadcast_shapes(a.shape[:-2], np.shape(t_s), np.shape(t_d))
+    a = np.broadcast_to(a, shape + a.shape[-2:])
+    b = np.broadcast_to(b, shape + b.shape[-1:])
+    t_s = np.broadcast_to(t_s, shape)
+    t_d = np.broadcast_to(t_d, shape)
+    num = a.shape[-1]
+
+    n_delay = np.floor(t_d / t_s + 1e-12).astype(int)
+    tau = t_d - n_delay * t_s
+
+    def integrate(dt):
+        # expm([[A, B], [0, 0]] dt) = [[e^(A dt), int_0^dt e^(A s) ds B], ...]
+        aug = np.zeros(shape + (num + 1, num + 1))
+        aug[..., :num, :num] = a
+        aug[..., :num, num] = b
+        e = expm(aug * np.asarray(dt)[..., None, None])
+        return (e[..., :num, :num], e[..., :num, num])
+
+    phi_b, gamma_b = integrate(t_s - tau)
+    _, gamma_tau = integrate(tau)
+    gamma_a = np.einsum("...ij,...j->...i", phi_b, gamma_tau)
+    phi, _ = integrate(t_s)
+    return (phi, gamma_a, gamma_b, n_delay)
+
+
+def get_frequency_response(phi, gamma_a, gamma_b, c, n_delay, w, t_s):
+    """_summary_
+    Get the frequency response of a delayed discrete plant,
+        P(z) = C (z I - PHI)^-1 (GAMMA_A z^-1 + GAMMA_B) z^-N.
+
+    Args:
+        phi (np.ndarray): (..., n, n)
+        gamma_a (np.ndarray): (..., n)
+        gamma_b (np.ndarray): (..., n)
+        c (np.ndarray): Output vector, (..., n)
+        n_delay (np.ndarray): Integer delay, (...)
+        w (np.ndarray): Angular frequencies, (W)
+        t_s (float|np.ndarray): Sample period, (...)
+
+    Returns:
+        np.ndarray: Complex response, (..., W).
+    """
+    num = phi.shape[-1]
+    z = np.exp(1j * np.asarray(w) * np.asarray(t_s)[..., None])
+    lhs = z[..., None, None] * np.eye(num) - phi[..., None, :, :]
+    rhs = gamma_a[..., None, :] / z[..., None] + gamma_b[..., None, :]
+    x = np.linalg.solve(lhs, rhs[..., None])[..., 0]
+    p = np.einsum("...j,...wj->...w", np.asarray(c), x)
+    return p * z ** -np.asarray(n_delay)[..., None]
+
+
+def get_pi_response(w, w_c, ratio, t_s):
+    """_summary_
+    Get the shape of the discrete PI with its zero at W_C / RATIO,
+        C(z) / K_I = T_S z / (z - 1) + RATIO / W_C.
+
+    Args:
+        w (np.ndarray): Angular frequencies
+        w_c (float|np.ndarray): Crossover frequency
+        ratio (float): W_C / W_Z = K_P W_C / K_I, 0 for a pure integrator
+        t_s (float|np.ndarray): Sample period
+
+    Returns:
+        np.ndarray: Complex response.
+    """
+    z = np.exp(1j * w * t_s)
+    return t_s * z / (z - 1) + ratio / w_c
+
+
+def get_crossings(x, level):
+    """_summary_
+    Get the intervals of a sampled curve that cross a level. A sample that
+    lands exactly on the level counts with the samples above it, so the
+    crossing is counted once, in the interval leading to it.
+
+    Args:
+        x (np.ndarray): Curve on an increasing grid, (..., W)
+        level (float): Level
+
+    Returns:
+        np.ndarray: Whether each interval crosses, (..., W - 1).
+    """
+    above = x >= level
+    return above[..., :-1] != above[..., 1:]
+
+
+def get_loop_margins(loop):
+    """_summary_
+    Get the phase and gain margins of a loop gain over every crossing.
+
+    Args:
+        loop (np.ndarray): Loop gain on an increasing frequency grid, (..., W)
+
+    Returns:
+        (np.ndarray, np.ndarray, np.ndarray): Minimum phase margin (deg), gain
+            margin (dB), inf where there is no crossing, and the number of
+            gain crossings.
+    """
+    mag = np.abs(loop)
+    phase = np.degrees(np.unwrap(np.angle(loop), axis=-1))
+
+    gain_cross = get_crossings(mag, 1)
+    pm = (180 + phase[..., :-1] + 180) % 360 - 180
+    pm = np.where(gain_cross, pm, np.inf).min(axis=-1)
+
+    branch = np.floor((phase + 180) / 360)
+    phase_cross = branch[..., :-1] != branch[..., 1:]
+    gm = -20 * np.log10(mag[..., 1:])
+    gm = np.where(phase_cross, gm, np.inf).min(axis=-1)
+    return (pm, gm, gain_cross.sum(axis=-1))
+
+
+def get_frequency_grid(a, t_s, num_w=384):
+    """_summary_
+    Get a frequency grid up to Nyquist that resolves the resonances of a
+    batch of plants, with the peak and half power points of each added to a
+    log spaced grid.
+
+    Args:
+        a (np.ndarray): Continuous state matrices, (..., n, n)
+        t_s (float): Sample period
+        num_w (int, optional): Log spaced points. Defaults to 384.
+
+    Returns:
+        np.ndarray: Increasing angular frequencies.
+    """
+    w_max = m.pi / t_s * 0.999
+    w = np.logspace(m.log10(2 * m.pi * 10), m.log10(w_max), num_w)
+    poles = np.linalg.eigvals(a).ravel()
+    poles = poles[poles.imag > 0]
+    offsets = np.array([-2, -1, -0.5, 0, 0.5, 1, 2])
+    w_r = (poles.imag[:, None] + offsets * np.abs(poles.real)[:, None]).ravel()
+    w = np.concatenate([w, w_r[(w_r > w[0]) & (w_r < w_max)]])
+    return np.unique(w)
+
+
+def get_achievable_bandwidth(p, w, t_s, num_c=128, pm_min=pm_min, gm_min=gm_min):
+    """_summary_
+    Get the highest crossover frequency a PI can reach on a plant while
+    meeting the margin targets with a single gain crossing, over the zero
+    placements in zero_ratios, and its gains.
+
+    Args:
+        p (np.ndarray): Plant response, (..., W). The plant gain is negative
+            (more duty cycle lowers V_IN); the PI gains carry that sign.
+        w (np.ndarray): Angular frequencies, (W), see get_frequency_grid
+        t_s (float): Sample period
+        num_c (int, optional): Crossover candidates, log spaced over W.
+            Defaults to 128.
+        pm_min (float, optional): Phase margin target (deg). Defaults to
+            pm_min.
+        gm_min (float, optional): Gain margin target (dB). Defaults to gm_min.
+
+    Returns:
+        dict: Arrays of shape (...):
+            w_c - crossover frequency, nan where no candidate is valid
+            k_p, k_i - PI gains, duty per V and duty per V s
+            pm, gm - margins
+            ratio - W_C / W_Z of the chosen zero placement
+    """
+    cand = np.unique(np.round(np.geomspace(1, len(w) - 1, num_c)).astype(int))
+    w_cand = w[cand]
+    best = None
+    for ratio in zero_ratios:
+        shape = get_pi_response(w[None, :], w_cand[:, None], ratio, t_s)
+        k_i = 1 / np.abs(shape[np.arange(len(cand)), cand] * -p[..., cand])
+        loop = k_i[..., None] * shape * -p[..., None, :]
+        pm, gm, num_cross = get_loop_margins(loop)
+
+        valid = (pm >= pm_min) & (gm >= gm_min) & (num_cross == 1)
+        ok = valid.any(axis=-1)
+        idx = (valid * np.arange(len(cand))).argmax(axis=-1)
+        pick = lambda x: np.take_along_axis(x, idx[..., None], axis=-1)[..., 0]
+        w_c = np.where(ok, w_cand[idx], np.nan)
+        k_i = -pick(k_i)
+        candidate = {
+            "w_c": w_c,
+            "k_p": np.where(ok, k_i * ratio / w_cand[idx], np.nan),
+            "k_i": np.where(ok, k_i, np.nan),
+            "pm": np.where(ok, pick(pm), np.nan),
+            "gm": np.where(ok, pick(gm), np.nan),
+            "ratio": np.where(ok, ratio, np.nan),
+        }
+        if best is None:
+            best = candidate
+        else:
+            better = np.nan_to_num(w_c) > np.nan_to_num(best["w_c"])
+            best = {key: np.where(better, candidate[key], best[key]) for key in best}
+    return best
+
+
+def get_pi_at_crossover(
+    p, w, w_c, t_s, pm_min=pm_min, gm_min=gm_min, ratios=zero_ratios
+):
+    """_summary_
+    Get the PI that crosses over at a given frequency with the most phase
+    margin, over a set of zero placements, while meeting the margin targets
+    with a single gain crossing.
+
+    Args:
+        p (np.ndarray): Plant response, (..., W)
+        w (np.ndarray): Angular frequencies, (W), containing W_C
+        w_c (float): Crossover frequency
+        t_s (float): Sample period
+        pm_min (float, optional): Phase margin target (deg). Defaults to
+            pm_min.
+        gm_min (float, optional): Gain margin target (dB). Defaults to gm_min.
+        ratios ([float], optional): W_C / W_Z placements to try, 0 for
+            integral only. Defaults to zero_ratios.
+
+    Returns:
+        dict: Arrays of shape (...), nan where no placement is valid:
+            k_p, k_i - PI gains, duty per V and duty per V s
+            pm, gm - margins
+            ratio - W_C / W_Z of the chosen zero placement
+    """
+    idx = np.abs(w - w_c).argmin()
+    best = None
+    for ratio in ratios:
+        shape = get_pi_response(w, w[idx], ratio, t_s)
+        k_i = 1 / np.abs(shape[idx] * p[..., idx])
+        pm, gm, num_cross = get_loop_margins(k_i[..., None] * shape * -p)
+        valid = (pm >= pm_min) & (gm >= gm_min) & (num_cross == 1)
+        candidate = {
+            "k_p": np.where(valid, -k_i * ratio / w[idx], np.nan),
+            "k_i": np.where(valid, -k_i, np.nan),
+            "pm": np.where(valid, pm, np.nan),
+            "gm": np.where(valid, gm, np.nan),
+            "ratio": np.where(valid, ratio, np.nan),
+        }
+        if best is None:
+            best = candidate
+        else:
+            better = np.nan_to_num(candidate["pm"]) > np.nan_to_num(best["pm"])
+            best = {key: np.where(better, candidate[key], best[key]) for key in best}
+    return best
+
+
+def get_pi_margins(p, w, k_p, k_i, t_s):
+    """_summary_
+    Get the margins and crossover frequency of the loop with a given PI.
+
+    Args:
+        p (np.ndarray): Plant response, (..., W)
+        w (np.ndarray): Angular frequencies, (W)
+        k_p (np.ndarray): Proportional gains, (...)
+        k_i (np.ndarray): Integral gains, (...)
+        t_s (float): Sample period
+
+    Returns:
+        (np.ndarray, ...): Phase margin (deg), gain margin (dB), number of gain
+            crossings and first crossover frequency (rad/s), nan if none.
+    """
+    z = np.exp(1j * w * t_s)
+    pi = np.asarray(k_p)[..., None] + np.asarray(k_i)[..., None] * t_s * z / (z - 1)
+    loop = pi * p
+    pm, gm, num_cross = get_loop_margins(loop)
+
+    # Log interpolated first crossing of |L| = 1.
+    mag = np.log(np.abs(loop))
+    idx = get_crossings(mag, 0).argmax(axis=-1)[..., None]
+    m_0 = np.take_along_axis(mag, idx, axis=-1)[..., 0]
+    m_1 = np.take_along_axis(mag, idx + 1, axis=-1)[..., 0]
+    frac = m_0 / np.where(m_0 == m_1, 1, m_0 - m_1)
+    log_w = np.log(w[idx[..., 0]]) + frac * np.log(w[idx[..., 0] + 1] / w[idx[..., 0]])
+    w_c = np.where(num_cross > 0, np.exp(log_w), np.nan)
+    return (pm, gm, num_cross, w_c)
+
+
+def get_closed_loop(phi, gamma_a, gamma_b, c, n_delay, k_p, k_i, t_s):
+    """_summary_
+    Build the closed loop of a delayed discrete plant and the PI, with the
+    reference as input and V_IN as output.
+
+    Args:
+        phi (np.ndarray): (n, n)
+        gamma_a (np.ndarray): (n)
+        gamma_b (np.ndarray): (n)
+        c (np.ndarray): Output vector, (n)
+        n_delay (int): Integer delay
+        k_p (float): Proportional gain
+        k_i (float): Integral gain
+        t_s (float): Sample period
+
+    Returns:
+        (np.ndarray, np.ndarray, np.ndarray): Closed loop PHI, GAMMA and C over
+            states [x, u[k-1] .. u[k-N-1], integrator].
+    """
+    num = phi.shape[0]
+    size = num + n_delay + 2
+    # u[k] = K_P e[k] + I[k + 1], I[k + 1] = I[k] + K_I T_S e[k], e = r - C x.
+    u_x = np.zeros(size)
+    u_x[:num] = -(k_p + k_i * t_s) * c
+    u_x[-1] = 1
+    u_r = k_p + k_i * t_s
+
+    a_cl = np.zeros((size, size))
+    b_cl = np.zeros(size)
+    a_cl[:num, :num] = phi
+    a_cl[:num, num + n_delay] += gamma_a
+    if n_delay == 0:
+        a_cl[:num] += np.outer(gamma_b, u_x)
+        b_cl[:num] = gamma_b * u_r
+    else:
+        a_cl[:num, num + n_delay - 1] += gamma_b
+    # Delay line.
+    a_cl[num] = u_x
+    b_cl[num] = u_r
+    for idx in range(1, n_delay + 1):
+        a_cl[num + idx, num + idx - 1] = 1
+    # Integrator.
+    a_cl[-1, :num] = -k_i * t_s * c
+    a_cl[-1, -1] = 1
+    b_cl[-1] = k_i * t_s
+
+    c_cl = np.zeros(size)
+    c_cl[:num] = c
+    return (a_cl, b_cl, c_cl)
+
+
+def get_step_rate(a_cl, b_cl, c_cl, t_s, v_step=v_step, t_end=0.1):
+    """_summary_
+    Get the response rate of a closed loop to a reference step, measured to
+    90 % of the step.
+
+    Args:
+        a_cl (np.ndarray): Closed loop state matrix
+        b_cl (np.ndarray): Closed loop input vector
+        c_cl (np.ndarray): Closed loop output vector
+        t_s (float): Sample period
+        v_step (float, optional): Step size. Defaults to v_step.
+        t_end (float, optional): Simulated time. Defaults to 0.1.
+
+    Returns:
+        (float, float): Response rate (V/s) and overshoot (fraction).
+    """
+    num_steps = int(t_end / t_s)
+    x = np.zeros(len(b_cl))
+    y = np.zeros(num_steps)
+    for k in range(num_steps):
+        x = a_cl @ x + b_cl * v_step
+        y[k] = c_cl @ x
+    dc = y[-1]
+    reached = np.nonzero(np.abs(y) >= 0.9 * abs(dc))[0]
+    if len(reached) == 0 or abs(dc) < 0.5 * v_step:
+        return (0.0, np.nan)
+    t_90 = (reached[0] + 1) * t_s
+    return (0.9 * v_step / t_90, max(np.max(y) / dc - 1, 0))
+
+
+def get_required_bandwidth(slew=slew_min, v_step=v_step):
+    """_summary_
+    Get the crossover frequency needed to move V_IN by a resolution step at a
+    given rate, treating the closed loop as first order (90 % at 2.3 / W_C).
+
+    Args:
+        slew (float, optional): Response rate (V/s). Defaults to slew_min.
+        v_step (float, optional): Step size. Defaults to v_step.
+
+    Returns:
+        float: Crossover frequency (rad/s).
+    """
+    return 2.3 * slew / (0.9 * v_step)
+
+
+def get_plant_grid(design, v_in_range, v_out_range, num_cells, g=1000):
+    """_summary_
+    Get the small signal plants over an operating grid.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in_range ([float]): Array voltages
+        v_out_range ([float]): Output voltages
+        num_cells (int): Number of solar cells in series
+        g (float, optional): Irradiance (W/m^2). Defaults to 1000.
+
+    Returns:
+        (np.ndarray, ...): A (V_IN, V_OUT, 3, 3), B_D, C and duty cycles.
+    """
+    plants = [
+        [get_vin_plant(design, v_in, v_out, num_cells, g) for v_out in v_out_range]
+        for v_in in v_in_range
+    ]
+    return tuple(
+        np.array([[p[idx] for p in row] for row in plants]) for idx in range(4)
+    )
+
+
+def get_control_bandwidth_map(
+    design,
+    v_in_range,
+    v_out_range,
+    f_sw_range,
+    num_cells,
+    f_sw_sel=None,
+    num_w=384,
+):
+    """_summary_
+    Get the achievable input voltage loop bandwidth against the switching
+    frequency over an operating grid, and plot its spread.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in_range ([float]): Array voltages
+        v_out_range ([float]): Output voltages
+        f_sw_range ([float]): Switching (and sampling) frequencies
+        num_cells (int): Number of solar cells in series
+        f_sw_sel (float, optional): Selected switching frequency to mark.
+            Defaults to None.
+        num_w (int, optional): Log spaced frequency points up to Nyquist.
+            Defaults to 384.
+
+    Returns:
+        dict: See get_achievable_bandwidth, with shape (F_SW, V_IN, V_OUT),
+            and "duty".
+    """
+    a, b, c, duty = get_plant_grid(design, v_in_range, v_out_range, num_cells)
+    results = {key: [] for key in ("w_c", "k_p", "k_i", "pm", "gm")}
+    for f_sw in f_sw_range:
+        t_s = 1 / f_sw
+        w = get_frequency_grid(a, t_s, num_w)
+        t_d = get_loop_delay(f_sw, duty)
+        phi, gamma_a, gamma_b, n_delay = get_delayed_discretization(a, b, t_s, t_d)
+        p = get_frequency_response(phi, gamma_a, gamma_b, c, n_delay, w, t_s)
+        design_f = get_achievable_bandwidth(p, w, t_s)
+        for key in results:
+            results[key].append(design_f[key])
+    results = {key: np.array(val) for key, val in results.items()}
+    results["duty"] = duty
+
+    f_c = results["w_c"].reshape(len(f_sw_range), -1) / (2 * m.pi)
+    f_req = get_required_bandwidth() / (2 * m.pi)
+
+    fig, ax = plt.subplots(figsize=(10, 6))
+    ax.fill_between(
+        np.asarray(f_sw_range) / 1e3,
+        np.nanmin(f_c, axis=1),
+        np.nanmax(f_c, axis=1),
+        alpha=0.3,
+        label="Operating grid",
+    )
+    ax.plot(np.asarray(f_sw_range) / 1e3, np.nanmin(f_c, axis=1), label="Worst case")
+    ax.axhline(f_req, color="r", linestyle="--", label=f"{slew_min} V/s requirement")
+    if f_sw_sel is not None:
+        ax.axvline(f_sw_sel / 1e3, color="k", linestyle=":", label="Selected F_SW")
+    ax.set_xscale("log")
+    ax.set_yscale("log")
+    ax.set_title(
+        f"Achievable V_IN loop bandwidth (PM >= {pm_min} deg, GM >= {gm_min} dB)"
+    )
+    ax.set_xlabel("Switching frequency (kHz)")
+    ax.set_ylabel("Crossover frequency (Hz)")
+    ax.grid(True, which="both")
+    ax.legend()
+    plt.savefig("control_bandwidth_map.png")
+    plt.show()
+
+    return results
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    num_cells = 111
+    design = dict(default_boost_design)
+    f_sw_sel = design["f_sw"]
+
+    v_in_range = np.linspace(17.23, 71.7, 12)
+    v_out_range = np.array([85, 105, 125])
+    f_sw_range = np.logspace(np.log10(20e3), np.log10(500e3), 15)
+
+    results = get_control_bandwidth_map(
+        design, v_in_range, v_out_range, f_sw_range, num_cells, f_sw_sel
+    )
+    f_c_min = np.nanmin(results["w_c"].reshape(len(f_sw_range), -1), axis=1)
+    for f_sw, f_c in zip(f_sw_range, f_c_min / (2 * m.pi)):
+        print(f"F_SW={f_sw / 1e3:7.1f} kHz: worst case crossover {f_c:8.1f} Hz")
+
+    # Exact closed loop check at the selected frequency.
+    t_s = 1 / f_sw_sel
+    a, b, c, duty = get_plant_grid(design, v_in_range, v_out_range, num_cells)
+    w = get_frequency_grid(a, t_s)
+    t_d = get_loop_delay(f_sw_sel, duty)
+    phi, gamma_a, gamma_b, n_delay = get_delayed_discretization(a, b, t_s, t_d)
+    p = get_frequency_response(phi, gamma_a, gamma_b, c, n_delay, w, t_s)
+    pi = get_achievable_bandwidth(p, w, t_s)
+
+    rates, radii = [], []
+    for idx in np.ndindex(duty.shape):
+        a_cl, b_cl, c_cl = get_closed_loop(
+            phi[idx],
+            gamma_a[idx],
+            gamma_b[idx],
+            c[idx],
+            n_delay[idx],
+            pi["k_p"][idx],
+            pi["k_i"][idx],
+            t_s,
+        )
+        radii.append(np.max(np.abs(np.linalg.eigvals(a_cl))))
+        rates.append(get_step_rate(a_cl, b_cl, c_cl, t_s)[0])
+    print(
+        f"At {f_sw_sel / 1e3:.0f} kHz: loop delay {t_d.min() * 1e6:.1f}-"
+        f"{t_d.max() * 1e6:.1f} us, crossover "
+        f"{np.nanmin(pi['w_c']) / (2 * m.pi):.0f}-"
+        f"{np.nanmax(pi['w_c']) / (2 * m.pi):.0f} Hz, "
+        f"max pole radius {max(radii):.4f}"
+    )
+    rates = np.array(rates).reshape(duty.shape)
+    slow = rates < slew_min
+    if slow.any():
+        print(
+            f"Below {slew_min} V/s at V_IN <= {v_in_range[slow.any(axis=1)].max():.1f} V"
+        )
+    print(
+        f"Slowest {v_step} V step response {rates.min():.0f} V/s "
+        f"(requirement {slew_min} V/s): {'met' if rates.min() >= slew_min else 'NOT met'}"
+    )
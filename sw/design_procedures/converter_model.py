@@ -0,0 +1,706 @@
+"""_summary_
+@file       converter_model.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Cycle-level switched model of the synchronous DC-DC boost
+            converter.
+
+            The converter is modeled as a piecewise linear state space system
+            with states x = [I_L, V_CI, V_CO] and inputs u = [I_S, V_B]:
+
+            - The array is a Norton equivalent (I_S, R_PV) linearized about its
+              operating point.
+            - The battery is a voltage source V_B behind R_B.
+            - SW1 (low side) conducts for D / F_SW, SW2 (high side) for the
+              rest of the period. Each switch is modeled as its on-resistance.
+            - Capacitors carry their ESR, the inductor its DCR.
+
+            Each subinterval is discretized exactly with the matrix exponential
+            of the augmented system [[A, B u], [0, 0]], so a cycle costs two
+            3x3 matrix products regardless of the switching frequency.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import matplotlib.pyplot as plt
+import numpy as np
+from scipy.linalg import expm
+
+from design_procedures.calibration import default_calibration
+from design_procedures.nonideal_model import (
+    get_cell_dynamic_resistance,
+    model_nonideal_cell_vec,
+)
+
+# Nominal selected design. See docs/DESIGN.md.
+default_boost_design = {
+    "l": 100e-6,  # H
+    "r_dcr": 30e-3,  # Ohm
+    "n_l": 27,  # Turns on PQ 26/25 at 8.8 A, 410 mT
+    "c_i": 5e-6,  # F, RA4505K100
+    "r_ci": 6.9e-3,  # Ohm
+    "c_o": 54e-6,  # F, 3x A759MS186M2CAAE090
+    "r_co": 30e-3,  # Ohm
+    "r_ds_on": 10.25e-3,  # Ohm, EPC2307
+    "c_oss": 762e-12,  # F, EPC2307
+    "q_g": 7.4e-9,  # C, EPC2307 at V_GS 5 V
+    "r_b": 50e-3,  # Ohm, pack and harness
+    "f_sw": 104e3,  # Hz, selected switching (and loop sampling) frequency
+    # Hz, PWM timer clock. TIM1 of the STM32L432 on the NUCLEO-L432KC
+    # (hw/controller.kicad_sch) at its 80 MHz maximum SYSCLK; the part has no
+    # high resolution timer.
+    "f_clk": 80e6,
+}
+
+# Nominal operating range of design.py, rounded.
+default_num_cells = 111
+default_v_in_range = [20.3, 68.9, 74.5]  # V_IN_LOW, V_IN_MPP, V_IN_HIGH
+default_v_out_range = [85, 105, 125]  # V_OUT_LOW, V_OUT_MID, V_OUT_HIGH
+
+# Cell characteristics and design criteria of design.py.
+default_cell = {"v_oc": 0.721, "i_sc": 6.15, "v_mpp": 0.621, "i_mpp": 5.84}
+default_design_criteria = {
+    "le_top_pct": 0.705,  # Share of V_MPP below it that V_IN_LOW reaches
+    "ue_top_pct": 0.5,  # Share of V_OC - V_MPP above it that V_IN_HIGH reaches
+    "r_co_v": 0.250,  # V, output ripple
+    "r_l_a": 2.75,  # A, inductor ripple
+    "sf": 1.25,  # Safety factor
+    "eff": 0.97,  # Target converter efficiency
+    "sw_1_p_dist": 0.29,  # Share of the loss budget per switch
+}
+
+
+def get_operating_grid(v_in_range, v_out_range, num_cells, num=35, g=1000):
+    """_summary_
+    Get the V_IN x V_OUT grid of the design maps, with I_IN on the array
+    curve at 25 C.
+
+    Args:
+        v_in_range ([float]): Input voltage range in format [min, best, max]
+        v_out_range ([float]): Output voltage range in format [min, avg, max]
+        num_cells (int): Number of solar cells
+        num (int, optional): Points per axis. Defaults to 35, the grid of
+            get_switch_op_fs_map.
+        g (float, optional): Irradiance, in W/m^2. Defaults to 1000.
+
+    Returns:
+        (np.ndarray, ...): (num, num) V_IN, I_IN and V_OUT, V_IN along the
+            first axis.
+    """
+    v_in, v_out = np.meshgrid(
+        np.linspace(v_in_range[0], v_in_range[2], num),
+        np.linspace(v_out_range[0], v_out_range[2], num),
+        indexing="ij",
+    )
+    i_in = model_nonideal_cell_vec(g, 298.15, 0, 100, v_in / num_cells)[0]
+    return v_in, np.maximum(i_in, 0.0), v_out
+
+
+def get_pv_norton(v_in, i_in, num_cells, g=1000, t=298.15):
+    """_summary_
+    Linearize the array about an operating point into a Norton equivalent.
+
+    Args:
+        v_in (float): Array voltage at the operating point
+        i_in (float): Array current at the operating point
+        num_cells (int): Number of solar cells
+        g (float, optional): Irradiance (W/m^2). Defaults to 1000.
+        t (float, optional): Cell temperature (K). Defaults to 298.15.
+
+    Returns:
+        (float, float): Norton current I_S and dynamic resistance R_PV.
+    """
+    r_pv = num_cells * float(
+        get_cell_dynamic_resistance(g, t, 0, 100, v_in / num_cells)
+    )
+    return (i_in + v_in / r_pv, r_pv)
+
+
+def get_boost_state_space(design, r_sw1, r_sw2, r_pv):
+    """_summary_
+    Get the state space matrices of both subintervals of the boost converter.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        r_sw1 (float): Effective on-resistance of SW1
+        r_sw2 (float): Effective on-resistance of SW2
+        r_pv (float): Array dynamic resistance
+
+    Returns:
+        (np.ndarray, ...): A_ON, B_ON (SW1 conducting), A_OFF, B_OFF (SW2
+            conducting). B matrices map u = [I_S, V_B].
+    """
+    l, r_dcr = design["l"], design["r_dcr"]
+    c_i, r_ci = design["c_i"], design["r_ci"]
+    c_o, r_co = design["c_o"], design["r_co"]
+    r_b = design["r_b"]
+
+    # Input node: V_IN = g (V_CI + R_CI (I_S - I_L)).
+    g = 1 / (1 + r_ci / r_pv)
+    # Output node: V_OUT = h (V_CO + R_CO I_X + R_CO V_B / R_B).
+    h = 1 / (1 + r_co / r_b)
+
+    def derivative(x, u, on):
+        i_l, v_ci, v_co = x
+        i_s, v_b = u
+        v_in = g * (v_ci + r_ci * (i_s - i_l))
+        i_x = 0 if on else i_l
+        v_out = h * (v_co + r_co * i_x + r_co * v_b / r_b)
+        v_sw = i_l * r_sw1 if on else v_out + i_l * r_sw2
+        return np.array(
+            [
+                (v_in - i_l * r_dcr - v_sw) / l,
+                (i_s - i_l - v_in / r_pv) / c_i,
+                (i_x - (v_out - v_b) / r_b) / c_o,
+            ]
+        )
+
+    # The derivative is linear, so its columns are the system matrices.
+    eye_x, eye_u, zero_x, zero_u = np.eye(3), np.eye(2), np.zeros(3), np.zeros(2)
+    matrices = []
+    for on in (True, False):
+        a = np.column_stack([derivative(col, zero_u, on) for col in eye_x])
+        b = np.column_stack([derivative(zero_x, col, on) for col in eye_u])
+        matrices += [a, b]
+    return tuple(matrices)
+
+
+def get_affine_step(a, b, u, dt):
+    """_summary_
+    Exactly discretize x' = A x + B u over dt into x+ = PHI x + GAMMA.
+
+    Args:
+        a (np.ndarray): State matrix
+        b (np.ndarray): Input matrix
+        u (np.ndarray): Constant input over the step
+        dt (float): Step length
+
+    Returns:
+        (np.ndarray, np.ndarray): PHI and GAMMA.
+    """
+    aug = np.zeros((4, 4))
+    aug[:3, :3] = a
+    aug[:3, 3] = b @ u
+    e = expm(aug * dt)
+    return (e[:3, :3], e[:3, 3])
+
+
+def get_output_map(design, r_pv, on):
+    """_summary_
+    Get the linear map from (x, u) to the terminal quantities of a
+    subinterval: [V_IN, V_OUT, I_CI, I_CO, I_SW1, I_SW2].
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        r_pv (float): Array dynamic resistance
+        on (bool): Whether SW1 is conducting
+
+    Returns:
+        (np.ndarray, np.ndarray): C (6x3) and D (6x2).
+    """
+    r_ci, r_co, r_b = design["r_ci"], design["r_co"], design["r_b"]
+    g = 1 / (1 + r_ci / r_pv)
+    h = 1 / (1 + r_co / r_b)
+    x_sw = 0.0 if on else 1.0
+
+    # Rows in terms of [I_L, V_CI, V_CO] and [I_S, V_B].
+    c = np.zeros((6, 3))
+    d = np.zeros((6, 2))
+    c[0] = [-g * r_ci, g, 0]
+    d[0] = [g * r_ci, 0]
+    c[1] = [h * r_co * x_sw, 0, h]
+    d[1] = [0, h * r_co / r_b]
+    # I_CI = I_S - I_L - V_IN / R_PV
+    c[2] = [-1, 0, 0] - c[0] / r_pv
+    d[2] = [1, 0] - d[0] / r_pv
+    # I_CO = I_X - (V_OUT - V_B) / R_B
+    c[3] = [x_sw, 0, 0] - c[1] / r_b
+    d[3] = [0, 1 / r_b] - d[1] / r_b
+    c[4] = [1 - x_sw, 0, 0]
+    c[5] = [x_sw, 0, 0]
+    return (c, d)
+
+
+def simulate_switched_boost(
+    design,
+    v_in,
+    i_in,
+    v_b,
+    duty,
+    f_sw,
+    num_cycles,
+    num_cells,
+    x_0=None,
+    samples_per_cycle=0,
+    r_ds_on_model=None,
+    t_j=25,
+):
+    """_summary_
+    Simulate the switched boost converter cycle by cycle.
+
+    When a dynamic on-resistance model is given, the on-resistance of each
+    switch for a cycle is evaluated from the voltage it blocked and the
+    duration of its preceding off-state.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in (float): Array voltage at the operating point
+        i_in (float): Array current at the operating point
+        v_b (float): Battery voltage
+        duty (float): SW1 duty cycle
+        f_sw (float): Switching frequency
+        num_cycles (int): Number of switching cycles to simulate
+        num_cells (int): Number of solar cells
+        x_0 (np.ndarray, optional): Initial [I_L, V_CI, V_CO]. Defaults to the
+            ideal averaged operating point.
+        samples_per_cycle (int, optional): Waveform samples per cycle, split
+            between the subintervals in proportion to their length. When 0
+            only the cycle boundaries are returned. Defaults to 0.
+        r_ds_on_model (func, optional): f(r_ds_on, v_block, t_off, t_j)
+            returning the effective on-resistance, such as get_dynamic_r_ds_on.
+            Defaults to the static R_DS_ON.
+        t_j (float, optional): Junction temperature, in C. Defaults to 25.
+
+    Returns:
+        (np.ndarray, np.ndarray, np.ndarray): Sample times, states (N x 3) and
+            terminal quantities (N x 6, see get_output_map).
+    """
+    i_s, r_pv = get_pv_norton(v_in, i_in, num_cells)
+    u = np.array([i_s, v_b])
+    t_sw = 1 / f_sw
+    t_on = duty * t_sw
+    t_off = t_sw - t_on
+
+    if x_0 is None:
+        x_0 = np.array([i_in, v_in, v_b + i_in * (1 - duty) * design["r_b"]])
+    x = np.asarray(x_0, dtype=float)
+
+    n_on = max(int(round(samples_per_cycle * duty)), 1) if samples_per_cycle else 1
+    n_off = max(samples_per_cycle - n_on, 1) if samples_per_cycle else 1
+
+    outputs = [
+        get_output_map(design, r_pv, True),
+        get_output_map(design, r_pv, False),
+    ]
+
+    cache = {}
+
+    def get_steps(r_sw1, r_sw2):
+        key = (round(r_sw1, 9), round(r_sw2, 9))
+        if key not in cache:
+            a_on, b_on, a_off, b_off = get_boost_state_space(design, r_sw1, r_sw2, r_pv)
+            cache[key] = (
+                get_affine_step(a_on, b_on, u, t_on / n_on),
+                get_affine_step(a_off, b_off, u, t_off / n_off),
+            )
+        return cache[key]
+
+    r_ds_on = design["r_ds_on"]
+    r_sw1 = r_sw2 = r_ds_on
+    # Both switches block the output voltage while off.
+    v_block = outputs[1][0][1] @ x + outputs[1][1][1] @ u
+
+    times = []
+    states = []
+    terms = []
+    for k in range(num_cycles):
+        if r_ds_on_model is not None:
+            r_sw1 = float(r_ds_on_model(r_ds_on, v_block, t_off, t_j))
+            r_sw2 = float(r_ds_on_model(r_ds_on, v_block, t_on, t_j))
+        (phi_on, gam_on), (phi_off, gam_off) = get_steps(r_sw1, r_sw2)
+
+        t_0 = k * t_sw
+        for idx, (phi, gam, n, dt, on) in enumerate(
+            [
+                (phi_on, gam_on, n_on, t_on / n_on, True),
+                (phi_off, gam_off, n_off, t_off / n_off, False),
+            ]
+        ):
+            c, d = outputs[idx]
+            for j in range(n):
+                if samples_per_cycle or (on and j == 0):
+                    times.append(t_0 + (0 if on else t_on) + j * dt)
+                    states.append(x.copy())
+                    terms.append(c @ x + d @ u)
+                x = phi @ x + gam
+
+        v_block = outputs[1][0][1] @ x + outputs[1][1][1] @ u
+
+    times.append(num_cycles * t_sw)
+    states.append(x.copy())
+    terms.append(outputs[0][0] @ x + outputs[0][1] @ u)
+
+    return (np.array(times), np.array(states), np.array(terms))
+
+
+def get_switch_dynamic_loss(
+    design, times, terms, f_sw, duty, r_ds_on_model=None, t_j=25
+):
+    """_summary_
+    Get the conduction loss of both switches over the last switching cycle of
+    a sampled simulation.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        times (np.ndarray): Sample times from simulate_switched_boost
+        terms (np.ndarray): Terminal quantities from simulate_switched_boost
+        f_sw (float): Switching frequency
+        duty (float): SW1 duty cycle
+        r_ds_on_model (func, optional): Dynamic on-resistance model. Defaults
+            to the static R_DS_ON.
+        t_j (float, optional): Junction temperature, in C. Defaults to 25.
+
+    Returns:
+        (float, float): Conduction loss with the model, and the extra loss
+            over the static R_DS_ON.
+    """
+    t_sw = 1 / f_sw
+    mask = times[:-1] >= times[-1] - t_sw - 1e-15
+    dt = np.diff(times)[mask]
+    i_sw1_2 = np.sum(terms[:-1][mask, 4] ** 2 * dt) / t_sw
+    i_sw2_2 = np.sum(terms[:-1][mask, 5] ** 2 * dt) / t_sw
+    v_block = np.mean(terms[:-1][mask, 1])
+
+    r_ds_on = design["r_ds_on"]
+    r_static = r_ds_on
+    r_sw1 = r_sw2 = r_ds_on
+    if r_ds_on_model is not None:
+        r_static = r_ds_on_model(r_ds_on, 0.0, 0.0, t_j)
+        r_sw1 = r_ds_on_model(r_ds_on, v_block, (1 - duty) * t_sw, t_j)
+        r_sw2 = r_ds_on_model(r_ds_on, v_block, duty * t_sw, t_j)
+
+    loss = i_sw1_2 * r_sw1 + i_sw2_2 * r_sw2
+    return (loss, loss - (i_sw1_2 + i_sw2_2) * r_static)
+
+
+def get_periodic_steady_state(
+    design,
+    v_in,
+    i_in,
+    v_b,
+    duty,
+    f_sw,
+    num_cells,
+    r_ds_on_model=None,
+    t_j=25,
+    tol=1e-9,
+    max_iter=20,
+):
+    """_summary_
+    Solve for the periodic steady state of the switched boost converter with
+    the shooting method. The cycle map P(x) is one switching period of
+    simulate_switched_boost, and Newton's method is applied to
+    F(x) = P(x) - x with a finite difference Jacobian. With a static
+    on-resistance the map is affine and this converges in one step.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in (float): Array voltage at the operating point
+        i_in (float): Array current at the operating point
+        v_b (float): Battery voltage
+        duty (float): SW1 duty cycle
+        f_sw (float): Switching frequency
+        num_cells (int): Number of solar cells
+        r_ds_on_model (func, optional): Dynamic on-resistance model. Defaults
+            to the static R_DS_ON.
+        t_j (float, optional): Junction temperature, in C. Defaults to 25.
+        tol (float, optional): Convergence tolerance on |F(x)|. Defaults to
+            1e-9.
+        max_iter (int, optional): Maximum Newton iterations. Defaults to 20.
+
+    Returns:
+        (np.ndarray, int, bool): [I_L, V_CI, V_CO] at the start of the SW1
+            on-state on the periodic orbit, the number of iterations taken and
+            whether |F(x)| < tol there. Without convergence the state is the
+            last iterate.
+    """
+
+    def cycle(x):
+        _, states, _ = simulate_switched_boost(
+            design,
+            v_in,
+            i_in,
+            v_b,
+            duty,
+            f_sw,
+            1,
+            num_cells,
+            x,
+            0,
+            r_ds_on_model,
+            t_j,
+        )
+        return states[-1]
+
+    x = np.array([i_in, v_in, v_b + i_in * (1 - duty) * design["r_b"]])
+    scale = np.array([1e-4, 1e-3, 1e-3])
+    f_x = cycle(x) - x
+    iteration = 0
+    while np.max(np.abs(f_x)) >= tol and iteration < max_iter:
+        jac = np.column_stack(
+            [
+                (cycle(x + dx) - (x + dx) - f_x) / dx[idx]
+                for idx, dx in enumerate(np.diag(scale))
+            ]
+        )
+        x = x - np.linalg.solve(jac, f_x)
+        f_x = cycle(x) - x
+        iteration += 1
+
+    return (x, iteration, bool(np.max(np.abs(f_x)) < tol))
+
+
+def get_periodic_steady_state_map(
+    design,
+    v_in,
+    i_in,
+    v_out,
+    f_sw,
+    num_cells,
+    r_ds_on_model=None,
+    t_j=25,
+    samples=64,
+    duty_iter=5,
+):
+    """_summary_
+    Solve the periodic steady state of every operating point of a grid at
+    once. Each point is linearized and its cycle map is affine, so the orbit
+    is found by a batched linear solve (I - PHI) x = GAMMA. The duty cycle of
+    each point is then corrected so that the average array voltage matches the
+    requested V_IN despite the converter losses.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in (np.ndarray): Array voltage of each point
+        i_in (np.ndarray): Array current of each point
+        v_out (np.ndarray): Battery voltage of each point
+        f_sw (float): Switching frequency
+        num_cells (int): Number of solar cells
+        r_ds_on_model (func, optional): Dynamic on-resistance model, evaluated
+            at the battery voltage and the corrected duty cycle. Defaults to
+            the static R_DS_ON.
+        t_j (float, optional): Junction temperature, in C. Defaults to 25.
+        samples (int, optional): Samples per subinterval for the waveform
+            statistics. Defaults to 64.
+        duty_iter (int, optional): Duty correction iterations. Defaults to 5.
+
+    Returns:
+        dict: Arrays shaped like v_in:
+            duty - SW1 duty cycle
+            x_0 - [I_L, V_CI, V_CO] at the start of the on-state (..., 3)
+            i_l_avg, i_l_rms, i_l_pk, i_l_pp - inductor current
+            v_ci_pp, v_co_pp - capacitor voltage ripple (excluding ESR)
+            v_in_pp, v_out_pp - terminal voltage ripple (including ESR)
+            i_ci_rms, i_co_rms - capacitor RMS current
+            i_sw1_rms, i_sw2_rms, i_sw1_pk, i_sw2_pk - switch currents
+            p_cond - switch conduction loss
+        and "waveforms", the (..., 2, samples + 1, 6) terminal quantities of
+        the on and off subintervals (see get_output_map) with "t" the sample
+        times.
+    """
+    shape = np.broadcast(v_in, i_in, v_out).shape
+    v_in = np.broadcast_to(v_in, shape).ravel().astype(float)
+    i_in = np.broadcast_to(i_in, shape).ravel().astype(float)
+    v_out = np.broadcast_to(v_out, shape).ravel().astype(float)
+    num = len(v_in)
+    t_sw = 1 / f_sw
+
+    pv = [get_pv_norton(v_in[k], i_in[k], num_cells) for k in range(num)]
+
+    def get_matrices(duty):
+        # Per point continuous matrices and output maps. A dynamic
+        # on-resistance depends on the off time before each on-state, so it
+        # follows the duty cycle the point runs at.
+        r_sw1 = np.full(num, design["r_ds_on"])
+        r_sw2 = np.full(num, design["r_ds_on"])
+        mats = np.zeros((num, 2, 3, 4))
+        outs = np.zeros((num, 2, 6, 4))
+        for k in range(num):
+            i_s, r_pv = pv[k]
+            u = np.array([i_s, v_out[k]])
+            if r_ds_on_model is not None:
+                r_sw1[k] = r_ds_on_model(
+                    design["r_ds_on"], v_out[k], (1 - duty[k]) * t_sw, t_j
+                )
+                r_sw2[k] = r_ds_on_model(
+                    design["r_ds_on"], v_out[k], duty[k] * t_sw, t_j
+                )
+            a_on, b_on, a_off, b_off = get_boost_state_space(
+                design, r_sw1[k], r_sw2[k], r_pv
+            )
+            mats[k, 0, :, :3], mats[k, 0, :, 3] = a_on, b_on @ u
+            mats[k, 1, :, :3], mats[k, 1, :, 3] = a_off, b_off @ u
+            for idx, on in enumerate((True, False)):
+                c, d = get_output_map(design, r_pv, on)
+                outs[k, idx, :, :3], outs[k, idx, :, 3] = c, d @ u
+        return (mats, outs, r_sw1, r_sw2)
+
+    def get_steps(a_aff, dt):
+        aug = np.zeros((num, 4, 4))
+        aug[:, :3, :] = a_aff * dt[:, None, None]
+        e = expm(aug)
+        return (e[:, :3, :3], e[:, :3, 3])
+
+    duty = 1 - v_in / v_out
+    mats, outs, r_sw1, r_sw2 = get_matrices(duty)
+    for iteration in range(duty_iter):
+        if r_ds_on_model is not None and iteration > 0:
+            mats, outs, r_sw1, r_sw2 = get_matrices(duty)
+        t_on = duty * t_sw
+        t_off = t_sw - t_on
+        phi_on, gam_on = get_steps(mats[:, 0], t_on / samples)
+        phi_off, gam_off = get_steps(mats[:, 1], t_off / samples)
+
+        # Full cycle map from the substeps.
+        phi = np.tile(np.eye(3), (num, 1, 1))
+        gam = np.zeros((num, 3))
+        for phi_s, gam_s in ((phi_on, gam_on), (phi_off, gam_off)):
+            for _ in range(samples):
+                phi = phi_s @ phi
+                gam = np.einsum("nij,nj->ni", phi_s, gam) + gam_s
+        x_0 = np.linalg.solve(np.eye(3) - phi, gam[..., None])[..., 0]
+
+        # Sample one period on the orbit. Each subinterval is sampled at both
+        # of its ends, so the commutation instants appear twice with the left
+        # and right limits of the discontinuous waveforms.
+        states = np.zeros((num, 2, samples + 1, 3))
+        terms = np.zeros((num, 2, samples + 1, 6))
+        x = x_0
+        for idx, (phi_s, gam_s) in enumerate(((phi_on, gam_on), (phi_off, gam_off))):
+            for j in range(samples + 1):
+                states[:, idx, j] = x
+                terms[:, idx, j] = (
+                    np.einsum("nij,nj->ni", outs[:, idx, :, :3], x) + outs[:, idx, :, 3]
+                )
+                if j < samples:
+                    x = np.einsum("nij,nj->ni", phi_s, x) + gam_s
+
+        # Trapezoidal weights of each sample over the period.
+        w = np.ones((num, 2, samples + 1))
+        w[:, :, 0] = w[:, :, -1] = 0.5
+        w[:, 0] *= (duty / samples)[:, None]
+        w[:, 1] *= ((1 - duty) / samples)[:, None]
+
+        v_in_avg = np.sum(w * terms[..., 0], axis=(1, 2))
+        duty_used = duty
+        duty = np.clip(duty + (v_in_avg - v_in) / v_out, 0.0, 0.99)
+
+    duty = duty_used
+
+    def mean(y):
+        return np.sum(w * y, axis=(1, 2))
+
+    def rms(y):
+        return np.sqrt(np.sum(w * y**2, axis=(1, 2)))
+
+    def pp(y):
+        return np.max(y, axis=(1, 2)) - np.min(y, axis=(1, 2))
+
+    i_sw1_rms = rms(terms[..., 4])
+    i_sw2_rms = rms(terms[..., 5])
+
+    result = {
+        "duty": duty,
+        "x_0": x_0,
+        "i_l_avg": mean(states[..., 0]),
+        "i_l_rms": rms(states[..., 0]),
+        "i_l_pk": np.max(states[..., 0], axis=(1, 2)),
+        "i_l_pp": pp(states[..., 0]),
+        "v_ci_pp": pp(states[..., 1]),
+        "v_co_pp": pp(states[..., 2]),
+        "v_in_pp": pp(terms[..., 0]),
+        "v_out_pp": pp(terms[..., 1]),
+        "i_ci_rms": rms(terms[..., 2]),
+        "i_co_rms": rms(terms[..., 3]),
+        "i_sw1_rms": i_sw1_rms,
+        "i_sw2_rms": i_sw2_rms,
+        "i_sw1_pk": np.max(terms[..., 4], axis=(1, 2)),
+        "i_sw2_pk": np.max(terms[..., 5], axis=(1, 2)),
+        "p_cond": i_sw1_rms**2 * r_sw1 + i_sw2_rms**2 * r_sw2,
+    }
+    for key, val in result.items():
+        result[key] = val.reshape(shape + val.shape[1:])
+
+    steps = np.arange(samples + 1)[None, :] / samples
+    t_on = (duty * t_sw)[:, None]
+    t = np.stack([steps * t_on, t_on + steps * (t_sw - t_on)], axis=1)
+    result["t"] = t.reshape(shape + t.shape[1:])
+    result["waveforms"] = terms.reshape(shape + terms.shape[1:])
+    return result
+
+
+def get_steady_state_cross_check_map(
+    design, v_in_range, v_out_range, f_sw, model, num_cells, num=35
+):
+    """_summary_
+    Compare the periodic steady state of the switched model against the
+    ripple approximations of get_passive_sizing and the RMS approximations of
+    get_switch_losses across all operating points.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in_range ([float]]): Input voltage range in format [min, best, max]
+        v_out_range ([float]): Output voltage range in format [min, avg, max]
+        f_sw (float): Switching frequency
+        model (func): Solar cell model
+        num_cells (int): Number of solar cells
+        num (int, optional): Grid points per axis. Defaults to 35.
+
+    Returns:
+        (dict, dict): Periodic steady state results (see
+            get_periodic_steady_state_map) and the relative error of each
+            approximation: i_l_pp, v_ci_pp, v_co_pp, p_cond.
+    """
+    # Deferred to avoid a circular import with switch_design.
+    from design_procedures.switch_design import get_switch_losses_batch
+
+    v_in_combos = np.linspace(v_in_range[0], v_in_range[2], num=num, endpoint=True)
+    v_out_combos = np.linspace(v_out_range[0], v_out_range[2], num=num, endpoint=True)
+    i_in_combos = np.array(
+        [model(1000, 298.15, 0, 100, v_in / num_cells) for v_in in v_in_combos]
+    )
+    v_in, v_out = np.meshgrid(v_in_combos, v_out_combos, indexing="ij")
+    i_in = np.broadcast_to(i_in_combos[:, None], v_in.shape)
+
+    pss = get_periodic_steady_state_map(design, v_in, i_in, v_out, f_sw, num_cells)
+
+    # Approximations, as written in get_passive_sizing.
+    duty = 1 - v_in / v_out
+    i_l_pp = v_in * duty / (f_sw * design["l"])
+    v_ci_pp = i_l_pp / (8 * f_sw * design["c_i"])
+    v_co_pp = (v_in * i_in / v_out * duty) / (f_sw * design["c_o"])
+
+    # And as in get_switch_losses, given the exact ripple ratio. The switched
+    # model takes the datasheet R_DS_ON, so the approximation does too.
+    r_l = pss["i_l_pp"] / (2 * i_in)
+    p_cond, _, _, _ = get_switch_losses_batch(
+        v_in,
+        i_in,
+        v_out,
+        f_sw,
+        design["r_ds_on"],
+        design["c_oss"],
+        r_l,
+        dynamic=False,
+        calibration=default_calibration,
+    )
+
+    error = {
+        "i_l_pp": i_l_pp / pss["i_l_pp"] - 1,
+        "v_ci_pp": v_ci_pp / pss["v_ci_pp"] - 1,
+        "v_co_pp": v_co_pp / pss["v_co_pp"] - 1,
+        "p_cond": p_cond / pss["p_cond"] - 1,
+    }
+
+    fig, axs = plt.subplots(1, 4, subplot_kw=dict(projection="3d"))
+    for ax, (key, err) in zip(axs, error.items()):
+        ax.scatter(v_in, v_out, err * 100, c=err)
+        ax.set_title(f"{key.upper()} Approx. Error")
+        ax.set_xlabel("V_IN (V)")
+        ax.set_ylabel("V_OUT (V)")
+        ax.set_zlabel("Error (%)")
+
+    plt.tight_layout()
+    plt.savefig("steady_state_cross_check_map.png")
+    plt.show()
+
+    return (pss, error)
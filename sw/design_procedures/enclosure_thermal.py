@@ -0,0 +1,351 @@
+"""_summary_
+@file       enclosure_thermal.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Thermal network of the converter enclosure.
+
+            The switches, inductor, capacitors and controller (with the gate
+            driver) sit on one board in a closed box on the car. Each is a
+            node of a conductance network together with the board, the switch
+            heatsink, the internal air and the enclosure wall:
+
+                SW1, SW2 -- R_JB --> PCB,  SW1, SW2 -- R_JC + TIM --> HS
+                L, C_I, C_O, CTRL -- pads --> PCB, and -- surface --> AIR
+                PCB -- both faces --> AIR,  HS -- R_SA --> AIR
+                AIR -- inner face --> WALL -- outer face, radiation --> AMB
+
+            so every part heats the others through the board and the air.
+            The losses come from loss_calibration.get_loss_breakdown per
+            operating point. The network G T = P + G_AMB T_AMB is solved for
+            all points in one batched linear solve. Two couplings make it
+            nonlinear: R_DS_ON rises with the junction temperature, and R_SA
+            and the outer film depend on the temperature rise. Both are
+            handled by a few fixed point passes of the batched solve.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.component_stress import (
+    get_component_stress,
+    get_inductor_ripple,
+)
+from design_procedures.converter_model import (
+    default_boost_design,
+    default_num_cells,
+    default_v_in_range,
+    default_v_out_range,
+    get_operating_grid,
+)
+from design_procedures.heatsink_design import (
+    get_base_area,
+    get_r_sa,
+    heatsink_catalogue,
+    sigma,
+)
+from design_procedures.loss_calibration import get_loss_breakdown
+from design_procedures.thermal_design import r_epo
+
+components = ["sw1", "sw2", "l", "ci", "co", "ctrl"]
+nodes = components + ["pcb", "hs", "air", "wall"]
+t_limit = {name: 125.0 for name in components}  # C
+
+# Board and enclosure, in C/W unless noted.
+r_jb = 2.4  # EPC2307 junction to board, with the via field under it
+r_jc = 0.5  # EPC2307 junction to case
+r_pad = {"l": 20.0, "ci": 15.0, "co": 12.0, "ctrl": 10.0}  # Part to board
+area_part = {"l": 3.5e-3, "ci": 4e-4, "co": 1.5e-3, "ctrl": 2e-4}  # m^2
+area_pcb = 2 * 0.1 * 0.08  # m^2, both faces of a 100 x 80 mm board
+area_wall = 2 * (0.15 * 0.1 + 0.15 * 0.05 + 0.1 * 0.05)  # m^2, 150x100x50 mm
+h_inside = 5.0  # W/m^2/K, still air inside the closed box
+emissivity_wall = 0.85
+num_passes = 4  # Fixed point passes for R_DS_ON(T_J), R_SA and the outer film
+heatsink = heatsink_catalogue["Extrusion_25x25x10"]  # Both switches, fins up
+
+
+def get_component_losses(design, v_in, i_in, v_out, f_sw, params=None, t_j=25):
+    """_summary_
+    Split the loss breakdown into the loss of each enclosure component. SW1
+    (low side) takes its conduction loss and the hard switched C_OSS loss,
+    SW2 (synchronous) its conduction loss, the controller the fixed loss,
+    the gate driver and the auxiliary rails.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in (np.ndarray): Input voltage (V)
+        i_in (np.ndarray): Input current (A)
+        v_out (np.ndarray): Output voltage (V)
+        f_sw (np.ndarray): Switching frequency (Hz)
+        params (dict, optional): Loss model parameters. Defaults to
+            get_calibration().
+        t_j (np.ndarray, optional): Junction temperature (C). Defaults to 25.
+
+    Returns:
+        np.ndarray: (..., len(components)) loss, in W.
+    """
+    loss = get_loss_breakdown(design, v_in, i_in, v_out, f_sw, params, t_j, aux=True)
+    i_l_pp = get_inductor_ripple(v_in, v_out, f_sw, design["l"])
+    stress = get_component_stress(v_in, i_in, v_out, f_sw, i_l_pp)
+    i_1, i_2 = stress["sw1"]["i_rms"] ** 2, stress["sw2"]["i_rms"] ** 2
+    share = i_1 / np.maximum(i_1 + i_2, 1e-12)
+    return np.stack(
+        [
+            loss["sw_con"] * share + loss["sw_swi"],
+            loss["sw_con"] * (1 - share),
+            loss["l_dc"] + loss["l_ac"] + loss["core"],
+            loss["ci"],
+            loss["co"],
+            loss["fixed"] + loss["gate"] + loss["aux"],
+        ],
+        axis=-1,
+    )
+
+
+def get_conductance_matrix(g_hs, g_wall):
+    """_summary_
+    Assemble the conductance matrix of the enclosure network.
+
+    Args:
+        g_hs (np.ndarray): (M,) heatsink to air conductance (1 / R_SA), W/K
+        g_wall (np.ndarray): (M,) wall to ambient conductance, W/K
+
+    Returns:
+        (np.ndarray, np.ndarray): (M, N, N) conductance matrix and (M, N)
+            conductance of each node to ambient, N = len(nodes).
+    """
+    index = {name: k for k, name in enumerate(nodes)}
+    num = len(g_hs)
+    g = np.zeros((num, len(nodes), len(nodes)))
+
+    def link(a, b, conductance):
+        i, j = index[a], index[b]
+        g[:, i, i] += conductance
+        g[:, j, j] += conductance
+        g[:, i, j] -= conductance
+        g[:, j, i] -= conductance
+
+    for sw in ("sw1", "sw2"):
+        link(sw, "pcb", 1 / r_jb)
+        # Both switches share the heatsink, each through its own TIM.
+        link(sw, "hs", 1 / (r_jc + 2 * r_epo / get_base_area(heatsink)))
+    for part, r in r_pad.items():
+        link(part, "pcb", 1 / r)
+        link(part, "air", h_inside * area_part[part])
+    link("pcb", "air", h_inside * area_pcb)
+    link("hs", "air", g_hs)
+    link("air", "wall", h_inside * area_wall)
+
+    g_amb = np.zeros((num, len(nodes)))
+    g_amb[:, index["wall"]] = g_wall
+    g[:, index["wall"], index["wall"]] += g_wall
+    return g, g_amb
+
+
+def get_enclosure_temperatures(
+    design, v_in, i_in, v_out, f_sw, t_amb=60.0, v_car=0.0, params=None
+):
+    """_summary_
+    Get the temperature of every enclosure node at a set of operating points.
+    Operating point arguments, t_amb and v_car broadcast against each other.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in (np.ndarray): Input voltage (V)
+        i_in (np.ndarray): Input current (A)
+        v_out (np.ndarray): Output voltage (V)
+        f_sw (np.ndarray): Switching frequency (Hz)
+        t_amb (float|np.ndarray, optional): Air outside the enclosure (C).
+            Defaults to 60.0.
+        v_car (float|np.ndarray, optional): Air speed over the enclosure
+            (m/s). Defaults to 0.0.
+        params (dict, optional): Loss model parameters. Defaults to
+            get_calibration().
+
+    Returns:
+        (np.ndarray, np.ndarray): (..., len(nodes)) temperatures (C) and
+            (..., len(components)) losses (W).
+    """
+    v_in, i_in, v_out, f_sw, t_amb, v_car = np.broadcast_arrays(
+        *[np.asarray(x, dtype=float) for x in (v_in, i_in, v_out, f_sw, t_amb, v_car)]
+    )
+    shape = v_in.shape
+    v_in, i_in, v_out, f_sw, t_amb, v_car = (
+        x.ravel() for x in (v_in, i_in, v_out, f_sw, t_amb, v_car)
+    )
+
+    # Outer film: flat plate in the car's air stream (as in cell_temperature)
+    # and linearized radiation, both re-evaluated at the wall temperature.
+    h_out = 8.55 + 2.56 * v_car
+    t_j = t_amb.copy()
+    t_wall = t_amb + 5.0
+    t_air = t_amb + 5.0
+    dt_hs = np.full_like(t_amb, 20.0)
+    for _ in range(num_passes):
+        p = get_component_losses(design, v_in, i_in, v_out, f_sw, params, t_j)
+        t_w, t_a = t_wall + 273.15, t_amb + 273.15
+        h_rad = emissivity_wall * sigma * (t_w**2 + t_a**2) * (t_w + t_a)
+        g_wall = (h_out + h_rad) * area_wall
+        # The heatsink sits in the enclosure air, not the outside air.
+        g_hs = 1 / get_r_sa(heatsink, 0.0, "horizontal_up", dt_hs, t_air)
+        g, g_amb = get_conductance_matrix(g_hs, g_wall)
+
+        rhs = g_amb * t_amb[:, None]
+        rhs[:, : len(components)] += p
+        t = np.linalg.solve(g, rhs[..., None])[..., 0]
+
+        t_j = (t[:, 0] + t[:, 1]) / 2
+        t_wall = t[:, nodes.index("wall")]
+        t_air = t[:, nodes.index("air")]
+        dt_hs = np.maximum(t[:, nodes.index("hs")] - t_air, 1.0)
+
+    return t.reshape(shape + (len(nodes),)), p.reshape(shape + (len(components),))
+
+
+def get_critical_component(temperatures, limits=t_limit):
+    """_summary_
+    Get the component closest to (or furthest over) its limit.
+
+    Args:
+        temperatures (np.ndarray): (..., len(nodes)) temperatures (C)
+        limits (dict, optional): Limit per component (C). Defaults to
+            t_limit.
+
+    Returns:
+        (np.ndarray, np.ndarray): Index into components and its margin to the
+            limit (C), negative when over.
+    """
+    margin = (
+        np.array([limits[c] for c in components]) - temperatures[..., : len(components)]
+    )
+    critical = np.argmin(margin, axis=-1)
+    return critical, np.take_along_axis(margin, critical[..., None], -1)[..., 0]
+
+
+def get_first_over_limit(temperatures, limits=t_limit):
+    """_summary_
+    Get, along the last operating point axis (e.g. a ramp of power or
+    ambient), the first point where any component exceeds its limit and
+    which component it is.
+
+    Args:
+        temperatures (np.ndarray): (..., K, len(nodes)) temperatures (C)
+        limits (dict, optional): Limit per component (C). Defaults to
+            t_limit.
+
+    Returns:
+        (np.ndarray, np.ndarray): Index along the ramp (-1 when never over)
+            and index into components (-1 when never over).
+    """
+    critical, margin = get_critical_component(temperatures, limits)
+    over = margin < 0
+    first = np.where(over.any(axis=-1), np.argmax(over, axis=-1), -1)
+    part = np.take_along_axis(critical, np.maximum(first, 0)[..., None], -1)[..., 0]
+    return first, np.where(first >= 0, part, -1)
+
+
+def get_enclosure_thermal_map(v_in, v_out, temperatures, t_amb_ramp, first):
+    """_summary_
+    Plot the critical component and its margin over the V_IN x V_OUT grid,
+    and the ambient at which a component first exceeds its limit.
+
+    Args:
+        v_in (np.ndarray): (A, B) input voltage grid (V)
+        v_out (np.ndarray): (A, B) output voltage grid (V)
+        temperatures (np.ndarray): (A, B, len(nodes)) temperatures (C)
+        t_amb_ramp (np.ndarray): (K,) ambient ramp (C)
+        first ((np.ndarray, np.ndarray)): (A, B) first over limit along the
+            ramp, see get_first_over_limit
+    """
+    critical, margin = get_critical_component(temperatures)
+    fig, axs = plt.subplots(1, 3, figsize=(18, 5.5))
+
+    mesh = axs[0].pcolormesh(v_in, v_out, margin, cmap="RdYlGn", vmin=0)
+    fig.colorbar(mesh, ax=axs[0], label="Margin (C)")
+    axs[0].set_title("Margin of the critical component")
+
+    cmap = plt.get_cmap("tab10", len(components))
+    mesh = axs[1].pcolormesh(
+        v_in, v_out, critical, cmap=cmap, vmin=-0.5, vmax=len(components) - 0.5
+    )
+    bar = fig.colorbar(mesh, ax=axs[1], ticks=range(len(components)))
+    bar.ax.set_yticklabels(components)
+    axs[1].set_title("Critical component")
+
+    t_first = np.where(first[0] >= 0, t_amb_ramp[np.maximum(first[0], 0)], np.nan)
+    mesh = axs[2].pcolormesh(v_in, v_out, np.ma.masked_invalid(t_first))
+    fig.colorbar(mesh, ax=axs[2], label="Ambient (C)")
+    axs[2].set_title("Ambient at which a component first exceeds 125 C")
+
+    for ax in axs:
+        ax.set_xlabel("V_IN (V)")
+        ax.set_ylabel("V_OUT (V)")
+    fig.tight_layout()
+    plt.savefig("enclosure_thermal_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    design = default_boost_design
+    f_sw = 100e3
+    v_in, i_in, v_out = get_operating_grid(
+        default_v_in_range, default_v_out_range, default_num_cells
+    )
+
+    start = time.perf_counter()
+    t, p = get_enclosure_temperatures(design, v_in, i_in, v_out, f_sw, 60.0)
+    elapsed = time.perf_counter() - start
+    critical, margin = get_critical_component(t)
+    worst = np.unravel_index(np.argmin(margin), margin.shape)
+    print(f"{v_in.size} operating points in {elapsed * 1e3 :.0f} ms")
+    print(
+        f"Worst point V_IN {v_in[worst] :.1f} V, V_OUT {v_out[worst] :.0f} V, "
+        f"{p[worst].sum() :.2f} W of loss, at 60 C ambient in still air:"
+    )
+    for k, name in enumerate(nodes):
+        loss = f"{p[worst][k] :6.2f} W" if k < len(components) else ""
+        print(f"\t{name:>5} {t[worst][k] :6.1f} C {loss}")
+
+    # Ramp the ambient to find which component gives out first, parked and
+    # at 15 m/s.
+    t_amb_ramp = np.arange(40.0, 121.0, 2.0)
+    for v_car in (0.0, 15.0):
+        t_ramp, _ = get_enclosure_temperatures(
+            design,
+            v_in[..., None],
+            i_in[..., None],
+            v_out[..., None],
+            f_sw,
+            t_amb_ramp,
+            v_car,
+        )
+        first = get_first_over_limit(t_ramp)
+        hit = first[0] >= 0
+        if hit.any():
+            k = np.argmin(np.where(hit, first[0], np.inf))
+            k = np.unravel_index(k, hit.shape)
+            print(
+                f"{v_car :4.1f} m/s: {components[first[1][k]]} first exceeds "
+                f"{t_limit[components[first[1][k]]] :.0f} C at "
+                f"{t_amb_ramp[first[0][k]] :.0f} C ambient "
+                f"(V_IN {v_in[k] :.1f} V, V_OUT {v_out[k] :.0f} V)"
+            )
+        else:
+            print(f"{v_car :4.1f} m/s: no component exceeds its limit")
+        if v_car == 0.0:
+            first_parked = first
+
+    get_enclosure_thermal_map(v_in, v_out, t, t_amb_ramp, first_parked)
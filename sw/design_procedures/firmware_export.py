@@ -0,0 +1,133 @@
+"""_summary_
+@file       firmware_export.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Export design parameters to C headers for the firmware in fw/.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import os
+import re
+
+import numpy as np
+
+# Default location of generated headers, relative to sw/.
+fw_include_dir = os.path.join(os.path.dirname(__file__), "..", "..", "fw", "include")
+
+
+def get_c_literal(value):
+    """_summary_
+    Format a Python value as a C literal. A NaN or infinite float has none
+    and raises ValueError.
+
+    Args:
+        value (int|float|bool|str): Value
+
+    Returns:
+        str: C literal, e.g. 12, 1.5e-06f, true or "text".
+    """
+    if isinstance(value, (bool, np.bool_)):
+        return "true" if value else "false"
+    if isinstance(value, (int, np.integer)):
+        return str(int(value))
+    if isinstance(value, (float, np.floating)):
+        if not np.isfinite(value):
+            raise ValueError(f"No C literal for {value}")
+        literal = f"{float(value):.9g}"
+        return literal + ("f" if "." in literal or "e" in literal else ".0f")
+    return f'"{value}"'
+
+
+def get_c_array(name, values, c_type="float"):
+    """_summary_
+    Format a 1D or 2D array as a C static const array definition.
+
+    Args:
+        name (str): Array name
+        values (np.ndarray): Values
+        c_type (str, optional): Element type. Defaults to "float".
+
+    Returns:
+        str: Definition, e.g. static const float NAME[2] = {1.0f, 2.0f};
+    """
+    values = np.asarray(values)
+    cast = float if c_type in ("float", "double") else int
+    dims = "".join(f"[{n}]" for n in values.shape)
+
+    def format_row(row):
+        return "{" + ", ".join(get_c_literal(cast(v)) for v in row) + "}"
+
+    if values.ndim == 1:
+        body = format_row(values)
+    else:
+        body = "{\n    " + ",\n    ".join(format_row(row) for row in values) + "\n}"
+    return f"static const {c_type} {name}{dims} = {body};"
+
+
+def write_c_header(filename, brief, constants, arrays=(), path=None):
+    """_summary_
+    Write a header of #define constants (and optionally const arrays).
+
+    Args:
+        filename (str): Header file name, e.g. "soft_start.h"
+        brief (str): One line description for the file comment
+        constants ([(str, any, str)]): (name, value, comment) of each constant
+        arrays ([str], optional): Array definitions, see get_c_array. Defaults
+            to none.
+        path (str, optional): Output directory. Defaults to fw/include.
+
+    Returns:
+        str: Path of the written header.
+    """
+    path = fw_include_dir if path is None else path
+    os.makedirs(path, exist_ok=True)
+    guard = filename.upper().replace(".", "_")
+    width = max([len(name) for name, _, _ in constants] + [0])
+
+    lines = [
+        "/**",
+        f" * @file {filename}",
+        f" * @brief {brief}",
+        " * @note Generated by sw/design_procedures. Do not edit by hand.",
+        " */",
+        f"#ifndef {guard}",
+        f"#define {guard}",
+        "",
+    ]
+    if arrays:
+        lines += ["#include <stdint.h>", ""]
+    for name, value, comment in constants:
+        literal = get_c_literal(value)
+        line = f"#define {name:<{width}} {'(' + literal + ')':<16}"
+        lines.append(f"{line} /* {comment} */" if comment else line.rstrip())
+    if arrays:
+        lines.append("")
+        lines += list(arrays)
+    lines += ["", f"#endif /* {guard} */", ""]
+
+    out = os.path.join(path, filename)
+    with open(out, "w") as f:
+        f.write("\n".join(lines))
+    return out
+
+
+def read_c_header(filename, path=None):
+    """_summary_
+    Read back the numeric #define constants of a generated header, so that
+    later procedures use the values the firmware is built with.
+
+    Args:
+        filename (str): Header file name, e.g. "mppt_tuning.h"
+        path (str, optional): Directory. Defaults to fw/include.
+
+    Returns:
+        dict: Value of each numeric constant, by name.
+    """
+    path = fw_include_dir if path is None else path
+    pattern = re.compile(r"#define\s+(\w+)\s+\(([-+0-9.eE]+)f?\)")
+    with open(os.path.join(path, filename)) as f:
+        matches = pattern.findall(f.read())
+    return {
+        name: float(value) if re.search(r"[.eE]", value) else int(value)
+        for name, value in matches
+    }
@@ -0,0 +1,465 @@
+"""_summary_
+@file       fixed_point_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Fixed point implementation of the input voltage loop PI and the
+            choice of its Q-format.
+
+            The firmware PI works in ADC counts in and timer counts out:
+                e[k]  = R - Y[k]
+                U[k]  = sat((I[k] + B0 e[k]) >> F)
+                I[k+1] = sat_W(I[k] + B1 e[k])
+            with B0 = (K_P + K_I T_S) S and B1 = K_I T_S S stored in QF within
+            a W bit word, S = V_LSB * COUNTS the counts per count scale, the
+            integrator I in QF within W bits (initialized to the nominal
+            duty cycle) and the products accumulated in 2W bits. The
+            simulation runs in int64 and flags any sum that leaves the 2W bit
+            accumulator as an overflow, so W = 32 is exact until it fails.
+
+            For every candidate (W, F) and every operating point:
+            - the closed loop poles with the quantized coefficients are
+              compared against the unquantized design (control_design),
+            - the loop is simulated with ADC, arithmetic and DPWM
+              quantization from a reference step of one control resolution
+              step, and the tail is checked for limit cycles, tracking error
+              and overflow.
+            The limit cycle free condition for the DPWM is that a duty cycle
+            count moves V_IN by less than an ADC count, V_OUT / COUNTS <
+            V_LSB; the simulation checks it along with the integrator dead
+            zone of coarse formats.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import math as m
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.control_design import (
+    get_achievable_bandwidth,
+    get_closed_loop,
+    get_delayed_discretization,
+    get_frequency_grid,
+    get_frequency_response,
+    get_loop_delay,
+    get_plant_grid,
+    v_step,
+)
+from design_procedures.converter_model import (
+    default_boost_design,
+    default_num_cells,
+    default_v_out_range,
+)
+
+adc_bits = 12
+v_in_fs = 100.0  # V, full scale of the V_IN sense
+word_lengths = [16, 24, 32]
+
+
+def get_q_formats(word_lengths=word_lengths):
+    """_summary_
+    Get every (W, F) candidate, F from 0 to W - 1.
+
+    Args:
+        word_lengths ([int], optional): Word lengths. Defaults to
+            word_lengths.
+
+    Returns:
+        (np.ndarray, np.ndarray): Word lengths and fractional bits.
+    """
+    w = np.concatenate([np.full(word, word) for word in word_lengths])
+    f = np.concatenate([np.arange(word) for word in word_lengths])
+    return (w, f)
+
+
+def quantize(x, w, f):
+    """_summary_
+    Quantize values into signed QF integers within a W bit word.
+
+    Args:
+        x (float|np.ndarray): Values
+        w (int|np.ndarray): Word lengths
+        f (int|np.ndarray): Fractional bits
+
+    Returns:
+        (np.ndarray, np.ndarray): Integers and whether each overflowed.
+    """
+    q = np.round(np.asarray(x) * 2.0 ** np.asarray(f))
+    lim = 2.0 ** (np.asarray(w) - 1)
+    overflow = (q >= lim) | (q < -lim)
+    return (np.clip(q, -lim, lim - 1).astype(np.int64), overflow)
+
+
+def get_min_timer_clock(f_sw, v_out):
+    """_summary_
+    Get the slowest PWM timer clock whose duty cycle step moves V_IN by less
+    than an ADC count, V_OUT F_SW / F_CLK < V_LSB, the limit cycle free
+    condition of the DPWM.
+
+    Args:
+        f_sw (float): Switching frequency
+        v_out (float): Highest output voltage
+
+    Returns:
+        float: Timer clock, in Hz.
+    """
+    return v_out * f_sw / (v_in_fs / 2**adc_bits)
+
+
+def get_counts_scale(f_sw, f_clk):
+    """_summary_
+    Get the DPWM resolution and the ADC count to timer count scale.
+
+    Args:
+        f_sw (float): Switching frequency
+        f_clk (float): Timer clock
+
+    Returns:
+        (float, float, float): Timer counts per period, V_LSB and the scale
+            S = V_LSB * COUNTS.
+    """
+    counts = round(f_clk / f_sw)
+    v_lsb = v_in_fs / 2**adc_bits
+    return (counts, v_lsb, v_lsb * counts)
+
+
+def get_quantized_pole_radius(plant, k_p, k_i, t_s, scale, w, f):
+    """_summary_
+    Get the closed loop pole radius with quantized PI coefficients.
+
+    Args:
+        plant ((np.ndarray, ...)): PHI, GAMMA_A, GAMMA_B, C and N per
+            operating point, see get_delayed_discretization
+        k_p (np.ndarray): Proportional gains per operating point
+        k_i (np.ndarray): Integral gains per operating point
+        t_s (float): Sample period
+        scale (float): Counts per count scale, see get_counts_scale
+        w (np.ndarray): Word lengths, (Q)
+        f (np.ndarray): Fractional bits, (Q)
+
+    Returns:
+        (np.ndarray, np.ndarray): Pole radius (Q, ...) with quantized
+            coefficients, and without.
+    """
+    phi, gamma_a, gamma_b, c, n_delay = plant
+    b0, _ = quantize((k_p + k_i * t_s)[None] * scale, w[:, None], f[:, None])
+    b1, _ = quantize((k_i * t_s)[None] * scale, w[:, None], f[:, None])
+    lsb = 2.0 ** -f[:, None]
+    k_i_q = b1 * lsb / (t_s * scale)
+    k_p_q = (b0 - b1) * lsb / scale
+
+    def radius(k_p, k_i, idx):
+        a_cl, _, _ = get_closed_loop(
+            phi[idx], gamma_a[idx], gamma_b[idx], c[idx], n_delay[idx], k_p, k_i, t_s
+        )
+        return np.max(np.abs(np.linalg.eigvals(a_cl)))
+
+    ops = range(len(k_p))
+    ideal = np.array([radius(k_p[idx], k_i[idx], idx) for idx in ops])
+    quantized = np.array(
+        [
+            [radius(k_p_q[q, idx], k_i_q[q, idx], idx) for idx in ops]
+            for q in range(len(w))
+        ]
+    )
+    return (quantized, ideal)
+
+
+def simulate_fixed_point_loop(
+    plant,
+    b0,
+    b1,
+    w,
+    f,
+    counts,
+    v_lsb,
+    v_in_0,
+    duty_0,
+    r_step,
+    num_steps=4000,
+    num_tail=1000,
+):
+    """_summary_
+    Simulate a batch of fixed point loops with ADC, arithmetic and DPWM
+    quantization. Every argument is per loop, in its first axis.
+
+    Args:
+        plant ((np.ndarray, ...)): PHI, GAMMA_A, GAMMA_B, C and N per loop
+        b0 (np.ndarray): Quantized B0 (QF integers)
+        b1 (np.ndarray): Quantized B1 (QF integers)
+        w (np.ndarray): Integrator word lengths
+        f (np.ndarray): Fractional bits
+        counts (int): Timer counts per period
+        v_lsb (float): V_IN per ADC count
+        v_in_0 (np.ndarray): Nominal V_IN
+        duty_0 (np.ndarray): Nominal duty cycle
+        r_step (int): Reference step (ADC counts)
+        num_steps (int, optional): Steps to simulate. Defaults to 4000.
+        num_tail (int, optional): Steps at the end checked for limit cycles.
+            Defaults to 1000.
+
+    Returns:
+        dict: Per loop:
+            v_in_pp - V_IN peak to peak over the tail (ADC counts)
+            duty_pp - duty cycle peak to peak over the tail (timer counts)
+            error - mean tracking error over the tail (ADC counts)
+            overflow - whether the integrator saturated or a sum left the
+                2W bit accumulator
+    """
+    phi, gamma_a, gamma_b, c, n_delay = plant
+    batch = len(b0)
+    rows = np.arange(batch)
+    f = np.asarray(f, dtype=np.int64)
+    half = np.where(f > 0, np.left_shift(1, np.maximum(f - 1, 0)), 0)
+    lim = np.left_shift(np.int64(1), np.asarray(w, dtype=np.int64) - 1)
+    # 2^(2W - 1); float so that W = 32 does not wrap.
+    acc_lim = 2.0 ** (2 * np.asarray(w, dtype=np.float64) - 1)
+    b0_f = np.asarray(b0, dtype=np.float64)
+    b1_f = np.asarray(b1, dtype=np.float64)
+
+    x = np.zeros(phi.shape[:2])
+    history = np.zeros((batch, n_delay.max() + 2))
+    integ = np.round(duty_0 * counts * 2.0**f).astype(np.int64)
+    overflow = integ >= lim
+    integ = np.minimum(integ, lim - 1)
+    r = np.round(v_in_0 / v_lsb).astype(np.int64) + r_step
+
+    y_tail = np.zeros((num_tail, batch), dtype=np.int64)
+    u_tail = np.zeros((num_tail, batch), dtype=np.int64)
+    for k in range(num_steps):
+        y = np.round((v_in_0 + np.einsum("bi,bi->b", c, x)) / v_lsb).astype(np.int64)
+        e = r - y
+        # Check the 2W bit sums in float before they can wrap in int64.
+        overflow |= np.abs(integ + b0_f * e) >= acc_lim
+        overflow |= np.abs(integ + b1_f * e) >= acc_lim
+        acc = integ + b0 * e
+        u = np.clip(np.right_shift(acc + half, f), 0, counts)
+        new = integ + b1 * e
+        overflow |= (new >= lim) | (new < -lim)
+        integ = np.clip(new, -lim, lim - 1)
+
+        history[:, 1:] = history[:, :-1]
+        history[:, 0] = u / counts - duty_0
+        x = (
+            np.einsum("bij,bj->bi", phi, x)
+            + gamma_a * history[rows, n_delay + 1][:, None]
+            + gamma_b * history[rows, n_delay][:, None]
+        )
+        if k >= num_steps - num_tail:
+            y_tail[k - num_steps + num_tail] = y
+            u_tail[k - num_steps + num_tail] = u
+
+    return {
+        "v_in_pp": y_tail.max(axis=0) - y_tail.min(axis=0),
+        "duty_pp": u_tail.max(axis=0) - u_tail.min(axis=0),
+        "error": (r - y_tail).mean(axis=0),
+        "overflow": overflow,
+    }
+
+
+def get_fixed_point_search(
+    plant, k_p, k_i, v_in_0, duty_0, f_sw, f_clk, word_lengths=word_lengths
+):
+    """_summary_
+    Evaluate every Q-format candidate at every operating point.
+
+    Args:
+        plant ((np.ndarray, ...)): PHI, GAMMA_A, GAMMA_B, C and N per
+            operating point, flattened to (P, ...)
+        k_p (np.ndarray): Proportional gains (P)
+        k_i (np.ndarray): Integral gains (P)
+        v_in_0 (np.ndarray): Nominal V_IN (P)
+        duty_0 (np.ndarray): Nominal duty cycle (P)
+        f_sw (float): Switching frequency
+        f_clk (float): Timer clock
+        word_lengths ([int], optional): Word lengths. Defaults to
+            word_lengths.
+
+    Returns:
+        dict: w, f (Q) and per (Q, P): radius, v_in_pp, duty_pp, error,
+            overflow, and "radius_ideal" (P).
+    """
+    t_s = 1 / f_sw
+    counts, v_lsb, scale = get_counts_scale(f_sw, f_clk)
+    w, f = get_q_formats(word_lengths)
+    num_q, num_p = len(w), len(k_p)
+
+    b0, over_0 = quantize((k_p + k_i * t_s)[None] * scale, w[:, None], f[:, None])
+    b1, over_1 = quantize((k_i * t_s)[None] * scale, w[:, None], f[:, None])
+    radius, radius_ideal = get_quantized_pole_radius(plant, k_p, k_i, t_s, scale, w, f)
+
+    tile = lambda x: np.broadcast_to(x[None], (num_q,) + x.shape).reshape(
+        (num_q * num_p,) + x.shape[1:]
+    )
+    sim = simulate_fixed_point_loop(
+        tuple(tile(np.asarray(x)) for x in plant),
+        b0.ravel(),
+        b1.ravel(),
+        np.repeat(w, num_p),
+        np.repeat(f, num_p),
+        counts,
+        v_lsb,
+        tile(v_in_0),
+        tile(duty_0),
+        int(round(v_step / v_lsb)),
+    )
+    results = {key: val.reshape(num_q, num_p) for key, val in sim.items()}
+    results["overflow"] |= over_0 | over_1
+    results.update({"w": w, "f": f, "radius": radius, "radius_ideal": radius_ideal})
+    return results
+
+
+def get_recommended_format(results, max_pp=1, max_error=1):
+    """_summary_
+    Pick the cheapest passing Q-format: the shortest word, then the format
+    whose poles moved least.
+
+    A format passes at every operating point if the quantized loop is stable,
+    nothing overflows, V_IN settles to within MAX_ERROR counts of the
+    reference and any residual oscillation is at most MAX_PP counts.
+
+    Args:
+        results (dict): See get_fixed_point_search
+        max_pp (int, optional): Maximum V_IN peak to peak (ADC counts).
+            Defaults to 1.
+        max_error (float, optional): Maximum tracking error (ADC counts).
+            Defaults to 1.
+
+    Returns:
+        (tuple|None, np.ndarray): (W, F) or None if no format passes, and the
+            pass mask (Q).
+    """
+    passing = (
+        (results["radius"] < 1)
+        & ~results["overflow"]
+        & (results["v_in_pp"] <= max_pp)
+        & (np.abs(results["error"]) <= max_error)
+    ).all(axis=1)
+    if not passing.any():
+        return (None, passing)
+
+    shift = np.abs(results["radius"] - results["radius_ideal"][None]).max(axis=1)
+    w = results["w"]
+    cheapest = w[passing].min()
+    candidates = np.nonzero(passing & (w == cheapest))[0]
+    best = candidates[np.argmin(shift[candidates])]
+    return ((int(w[best]), int(results["f"][best])), passing)
+
+
+def get_fixed_point_map(searches):
+    """_summary_
+    Plot the worst case limit cycle amplitude and pole radius of every
+    Q-format, for each timer option.
+
+    Args:
+        searches (dict): Timer name to results, see get_fixed_point_search
+    """
+    fig, axs = plt.subplots(2, len(searches), figsize=(8 * len(searches), 10))
+    axs = np.asarray(axs).reshape(2, -1)
+    for col, (name, results) in enumerate(searches.items()):
+        _, passing = get_recommended_format(results)
+        for word in np.unique(results["w"]):
+            sel = results["w"] == word
+            f = results["f"][sel]
+            axs[0, col].semilogy(
+                f, 1 + results["v_in_pp"][sel].max(axis=1), "o-", label=f"W={word}"
+            )
+            axs[1, col].plot(f, results["radius"][sel].max(axis=1), "o-")
+            axs[1, col].plot(
+                f[passing[sel]],
+                results["radius"][sel][passing[sel]].max(axis=1),
+                "k*",
+            )
+        axs[0, col].set_title(f"{name}: worst case V_IN limit cycle")
+        axs[0, col].set_xlabel("Fractional bits F")
+        axs[0, col].set_ylabel("1 + V_IN peak to peak (ADC counts)")
+        axs[0, col].legend()
+        axs[0, col].grid(True, which="both")
+        axs[1, col].axhline(1, color="r", linestyle="--")
+        axs[1, col].set_title(f"{name}: worst case pole radius (* passing)")
+        axs[1, col].set_xlabel("Fractional bits F")
+        axs[1, col].set_ylabel("Pole radius")
+        axs[1, col].set_ylim(0.99, 1.01)
+        axs[1, col].grid(True)
+    fig.tight_layout()
+    plt.savefig("fixed_point_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    num_cells = default_num_cells
+    design = dict(default_boost_design)
+    f_sw, f_clk = design["f_sw"], design["f_clk"]
+    t_s = 1 / f_sw
+
+    # Continuous design of control_design at every operating point.
+    v_in_range = np.linspace(17.23, 71.7, 12)
+    v_out_range = np.array(default_v_out_range)
+    a, b, c, duty = get_plant_grid(design, v_in_range, v_out_range, num_cells)
+    t_d = get_loop_delay(f_sw, duty)
+    phi, gamma_a, gamma_b, n_delay = get_delayed_discretization(a, b, t_s, t_d)
+    w = get_frequency_grid(a, t_s)
+    p = get_frequency_response(phi, gamma_a, gamma_b, c, n_delay, w, t_s)
+    pi = get_achievable_bandwidth(p, w, t_s)
+
+    flat = lambda x: x.reshape((-1,) + x.shape[2:])
+    plant = tuple(flat(x) for x in (phi, gamma_a, gamma_b, c, n_delay))
+    v_in_0 = np.repeat(v_in_range, len(v_out_range))
+
+    start = time.perf_counter()
+    results = get_fixed_point_search(
+        plant,
+        flat(pi["k_p"]),
+        flat(pi["k_i"]),
+        v_in_0,
+        flat(duty),
+        f_sw,
+        f_clk,
+    )
+    elapsed = time.perf_counter() - start
+
+    counts, v_lsb, _ = get_counts_scale(f_sw, f_clk)
+    v_dpwm = v_out_range.max() / counts
+    fmt, passing = get_recommended_format(results)
+    print(
+        f"{f_clk / 1e6:.0f} MHz timer, {counts} counts per period: "
+        f"{len(results['w'])} formats x {len(v_in_0)} points in {elapsed:.2f} s, "
+        f"DPWM step {v_dpwm * 1e3:.1f} mV of V_IN vs ADC LSB {v_lsb * 1e3:.1f} mV"
+    )
+    if fmt is None:
+        settled = (
+            (results["radius"] < 1)
+            & ~results["overflow"]
+            & (np.abs(results["error"]) <= 1)
+        ).all(axis=1)
+        pp = results["v_in_pp"].max(axis=1)[settled]
+        f_clk_min = get_min_timer_clock(f_sw, v_out_range.max())
+        dither_bits = m.ceil(m.log2(f_clk_min / f_clk))
+        print(
+            "  no format passes, smallest worst case V_IN limit cycle "
+            f"{pp.min() if len(pp) else np.nan} counts"
+        )
+        print(
+            f"  the DPWM needs a {f_clk_min / 1e6:.0f} MHz timer: dither the "
+            f"duty cycle over {2**dither_bits} periods ({dither_bits} extra "
+            "bits) or use a part with a high resolution timer"
+        )
+    else:
+        print(
+            f"  cheapest passing format: Q{fmt[0] - fmt[1] - 1}.{fmt[1]} "
+            f"in {fmt[0]} bits ({passing.sum()} formats pass)"
+        )
+
+    get_fixed_point_map({f"{f_clk / 1e6:.0f} MHz timer": results})
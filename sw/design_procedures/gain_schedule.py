@@ -0,0 +1,585 @@
+"""_summary_
+@file       gain_schedule.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Gain scheduled input voltage loop PI over the operating envelope.
+
+            The duty cycle to V_IN gain of the plant scales with V_OUT and
+            with the array dynamic resistance, which changes by orders of
+            magnitude from the current source region to the voltage source
+            region of the array. A single PI tuned at one corner crosses over
+            anywhere from a fraction to several times its design frequency
+            elsewhere. Instead, the PI is placed at one target crossover at
+            every (V_IN, V_OUT) (control_design.get_pi_at_crossover), the
+            target being a fraction of the worst case achievable bandwidth so
+            every point keeps its margins. The PI is integral only, which has
+            the most phase margin over the envelope, so the firmware
+            coefficients B0 = B1 (see fixed_point_design) are one table.
+
+            The table is tabulated on breakpoints spaced a power of two ADC
+            counts apart and stored as int16 in a Q-format. The lookup in
+            fw/include/gain_schedule_lookup.h is branch free: the reading is
+            saturated to the table, the cell index is a shift of it and the
+            coefficient is bilinearly interpolated with the remainder. The
+            smallest table whose interpolated gains keep
+            the margins and the crossover within tolerance of the target over
+            a finer verification grid is selected, and checked in closed loop
+            with the fixed point simulation of fixed_point_design.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import math as m
+import sys
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.control_design import (
+    get_achievable_bandwidth,
+    get_delayed_discretization,
+    get_frequency_grid,
+    get_frequency_response,
+    get_loop_delay,
+    get_pi_at_crossover,
+    get_pi_margins,
+    get_plant_grid,
+    gm_min,
+    pm_min,
+    v_step,
+)
+from design_procedures.converter_model import default_boost_design
+from design_procedures.firmware_export import get_c_array, write_c_header
+from design_procedures.fixed_point_design import (
+    adc_bits,
+    get_counts_scale,
+    simulate_fixed_point_loop,
+    v_in_fs,
+)
+
+v_out_fs = 150.0  # V, full scale of the V_OUT sense
+table_bits = 16
+target_ratio = 0.8  # Target crossover over the worst case achievable
+bw_tol = 0.1  # Allowed crossover deviation from the target
+shifts_in = range(4, 11)  # log2 of the V_IN breakpoint spacing (counts)
+shifts_out = range(6, 12)  # log2 of the V_OUT breakpoint spacing (counts)
+integ_bits = 32  # Integrator word length of the scheduled PI
+pi_ratios = [0]  # Integral only, see get_pi_at_crossover
+
+
+def get_adc_lsb():
+    """_summary_
+    Get the V_IN and V_OUT sense resolutions.
+
+    Returns:
+        (float, float): V_IN and V_OUT per ADC count.
+    """
+    return (v_in_fs / 2**adc_bits, v_out_fs / 2**adc_bits)
+
+
+def get_breakpoints(v_min, v_max, v_lsb, shift):
+    """_summary_
+    Get breakpoints spaced 2^SHIFT ADC counts apart that cover a range.
+
+    Args:
+        v_min (float): Lowest voltage
+        v_max (float): Highest voltage
+        v_lsb (float): Volts per ADC count
+        shift (int): log2 of the spacing in counts
+
+    Returns:
+        (int, np.ndarray): Base (counts) and the breakpoint voltages.
+    """
+    base = m.floor(v_min / v_lsb)
+    num = max(m.ceil((v_max / v_lsb - base) / 2**shift), 1) + 1
+    return (base, (base + np.arange(num) * 2**shift) * v_lsb)
+
+
+def get_scheduled_pi(design, v_in, v_out, num_cells, f_sw, w_t, w, g=1000):
+    """_summary_
+    Place the PI at a target crossover over an operating grid.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in ([float]): Array voltages
+        v_out ([float]): Output voltages
+        num_cells (int): Number of solar cells in series
+        f_sw (float): Switching (and sampling) frequency
+        w_t (float): Target crossover frequency (rad/s)
+        w (np.ndarray): Angular frequencies to check the margins over, see
+            get_frequency_grid
+        g (float, optional): Irradiance (W/m^2). Defaults to 1000.
+
+    Returns:
+        dict: See get_pi_at_crossover, with shape (V_IN, V_OUT), and "duty".
+    """
+    t_s = 1 / f_sw
+    a, b, c, duty = get_plant_grid(design, v_in, v_out, num_cells, g)
+    w = np.unique(np.append(w, w_t))
+    t_d = get_loop_delay(f_sw, duty)
+    phi, gamma_a, gamma_b, n_delay = get_delayed_discretization(a, b, t_s, t_d)
+    p = get_frequency_response(phi, gamma_a, gamma_b, c, n_delay, w, t_s)
+    pi = get_pi_at_crossover(p, w, w_t, t_s, ratios=pi_ratios)
+    pi["duty"] = duty
+    return pi
+
+
+def get_gain_table(k_i, t_s, scale, counts, bits=table_bits):
+    """_summary_
+    Quantize the integral only PI coefficient B = B0 = B1 = K_I T_S S into
+    signed integers, using the full word unless the integrator (a full period
+    of counts in the same format) would not fit in integ_bits.
+
+    Args:
+        k_i (np.ndarray): Integral gains
+        t_s (float): Sample period
+        scale (float): Counts per count scale, see get_counts_scale
+        counts (int): Timer counts per period
+        bits (int, optional): Word length. Defaults to table_bits.
+
+    Returns:
+        (np.ndarray, int): B and the fractional bits.
+    """
+    b = k_i * t_s * scale
+    frac = min(
+        bits - 2 - m.floor(m.log2(np.abs(b).max())),
+        integ_bits - 1 - m.ceil(m.log2(counts + 1)),
+    )
+    return (np.round(b * 2.0**frac).astype(np.int64), frac)
+
+
+def lookup_gain_schedule(schedule, adc_v_in, adc_v_out):
+    """_summary_
+    Integer reference of the firmware lookup, gain_schedule_lookup in
+    fw/include/gain_schedule_lookup.h.
+
+    Args:
+        schedule (dict): Table, see get_gain_schedule
+        adc_v_in (np.ndarray): V_IN readings (counts)
+        adc_v_out (np.ndarray): V_OUT readings (counts)
+
+    Returns:
+        np.ndarray: Interpolated B (Q frac integers).
+    """
+    s_in, s_out = schedule["shift_in"], schedule["shift_out"]
+    table = schedule["b"]
+    n_in, n_out = table.shape
+    x = np.clip(
+        np.asarray(adc_v_in, dtype=np.int64) - schedule["base_in"],
+        0,
+        (n_in - 1) << s_in,
+    )
+    y = np.clip(
+        np.asarray(adc_v_out, dtype=np.int64) - schedule["base_out"],
+        0,
+        (n_out - 1) << s_out,
+    )
+    i = np.clip(np.right_shift(x, s_in), 0, n_in - 2)
+    j = np.clip(np.right_shift(y, s_out), 0, n_out - 2)
+    fx = x - np.left_shift(i, s_in)
+    fy = y - np.left_shift(j, s_out)
+    c0 = (table[i, j] * ((1 << s_in) - fx) + table[i + 1, j] * fx) >> s_in
+    c1 = (table[i, j + 1] * ((1 << s_in) - fx) + table[i + 1, j + 1] * fx) >> s_in
+    return (c0 * ((1 << s_out) - fy) + c1 * fy) >> s_out
+
+
+def get_gain_schedule(
+    design, v_in_range, v_out_range, num_cells, f_sw, f_clk, w_t, w, shift_in, shift_out
+):
+    """_summary_
+    Build the gain table for one breakpoint spacing.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in_range ([float]): Array voltage envelope, lowest to highest
+        v_out_range ([float]): Output voltage envelope, lowest to highest
+        num_cells (int): Number of solar cells in series
+        f_sw (float): Switching (and sampling) frequency
+        f_clk (float): PWM timer clock
+        w_t (float): Target crossover frequency (rad/s)
+        w (np.ndarray): Angular frequencies to check the margins over
+        shift_in (int): log2 of the V_IN breakpoint spacing (counts)
+        shift_out (int): log2 of the V_OUT breakpoint spacing (counts)
+
+    Returns:
+        dict: base_in, base_out (counts), shift_in, shift_out, v_in, v_out
+            (breakpoint voltages), b (int table, (N_IN, N_OUT)), frac and
+            counts (timer counts per period the table is scaled for), or None
+            if a breakpoint has no valid PI.
+    """
+    lsb_in, lsb_out = get_adc_lsb()
+    base_in, v_in = get_breakpoints(min(v_in_range), max(v_in_range), lsb_in, shift_in)
+    base_out, v_out = get_breakpoints(
+        min(v_out_range), max(v_out_range), lsb_out, shift_out
+    )
+    # Breakpoints past the envelope hold the design at its edge.
+    pi = get_scheduled_pi(
+        design,
+        np.clip(v_in, min(v_in_range), max(v_in_range)),
+        np.clip(v_out, min(v_out_range), max(v_out_range)),
+        num_cells,
+        f_sw,
+        w_t,
+        w,
+    )
+    if np.isnan(pi["k_i"]).any():
+        return None
+    counts, _, scale = get_counts_scale(f_sw, f_clk)
+    b, frac = get_gain_table(pi["k_i"], 1 / f_sw, scale, counts)
+    return {
+        "base_in": base_in,
+        "base_out": base_out,
+        "shift_in": shift_in,
+        "shift_out": shift_out,
+        "v_in": v_in,
+        "v_out": v_out,
+        "b": b,
+        "frac": frac,
+        "counts": counts,
+    }
+
+
+def get_scheduled_margins(schedule, p, w, v_in, v_out, f_sw, f_clk):
+    """_summary_
+    Get the loop margins and crossover with the interpolated table gains.
+
+    Args:
+        schedule (dict): Table, see get_gain_schedule
+        p (np.ndarray): Plant responses, (V_IN, V_OUT, W)
+        w (np.ndarray): Angular frequencies, (W)
+        v_in (np.ndarray): Array voltages, (V_IN)
+        v_out (np.ndarray): Output voltages, (V_OUT)
+        f_sw (float): Switching (and sampling) frequency
+        f_clk (float): PWM timer clock
+
+    Returns:
+        dict: pm, gm, num_cross, w_c, k_p, k_i and b, (V_IN, V_OUT).
+    """
+    t_s = 1 / f_sw
+    lsb_in, lsb_out = get_adc_lsb()
+    _, _, scale = get_counts_scale(f_sw, f_clk)
+    adc_in, adc_out = np.meshgrid(
+        np.round(np.asarray(v_in) / lsb_in), np.round(np.asarray(v_out) / lsb_out)
+    )
+    b = lookup_gain_schedule(schedule, adc_in.T, adc_out.T)
+    k_i = b * 2.0 ** -schedule["frac"] / (t_s * scale)
+    k_p = np.zeros_like(k_i)
+    pm, gm, num_cross, w_c = get_pi_margins(p, w, k_p, k_i, t_s)
+    return {
+        "pm": pm,
+        "gm": gm,
+        "num_cross": num_cross,
+        "w_c": w_c,
+        "k_p": k_p,
+        "k_i": k_i,
+        "b": b,
+    }
+
+
+def get_gain_schedule_search(
+    design,
+    v_in_check,
+    v_out_check,
+    num_cells,
+    f_sw,
+    f_clk,
+    shifts_in=shifts_in,
+    shifts_out=shifts_out,
+):
+    """_summary_
+    Find the smallest gain table whose interpolated gains keep the margins and
+    a crossover within tolerance of the target over a verification grid.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_in_check ([float]): Array voltages to verify at, spanning the
+            envelope
+        v_out_check ([float]): Output voltages to verify at, spanning the
+            envelope
+        num_cells (int): Number of solar cells in series
+        f_sw (float): Switching (and sampling) frequency
+        f_clk (float): PWM timer clock
+        shifts_in ([int], optional): V_IN spacings to try. Defaults to
+            shifts_in.
+        shifts_out ([int], optional): V_OUT spacings to try. Defaults to
+            shifts_out.
+
+    Returns:
+        (dict, dict, list): Selected table (None if no spacing passes) with
+            "check" (see get_scheduled_margins), "w_t", "w_max" (achievable
+            bandwidths), "p", "w", "plant" and "duty" of the verification grid,
+            and
+            (entries, shift_in, shift_out, passed) of every spacing tried.
+    """
+    t_s = 1 / f_sw
+    a, b, c, duty = get_plant_grid(design, v_in_check, v_out_check, num_cells)
+    t_d = get_loop_delay(f_sw, duty)
+    phi, gamma_a, gamma_b, n_delay = get_delayed_discretization(a, b, t_s, t_d)
+    w = get_frequency_grid(a, t_s)
+    p = get_frequency_response(phi, gamma_a, gamma_b, c, n_delay, w, t_s)
+    w_max = get_achievable_bandwidth(p, w, t_s)["w_c"]
+    w_t = target_ratio * np.nanmin(w_max)
+
+    lsb_in, lsb_out = get_adc_lsb()
+    candidates = []
+    for s_in in shifts_in:
+        for s_out in shifts_out:
+            n_in = len(
+                get_breakpoints(min(v_in_check), max(v_in_check), lsb_in, s_in)[1]
+            )
+            n_out = len(
+                get_breakpoints(min(v_out_check), max(v_out_check), lsb_out, s_out)[1]
+            )
+            candidates.append((n_in * n_out, s_in, s_out))
+
+    tried = []
+    for entries, s_in, s_out in sorted(candidates, key=lambda x: (x[0], -x[1])):
+        schedule = get_gain_schedule(
+            design,
+            v_in_check,
+            v_out_check,
+            num_cells,
+            f_sw,
+            f_clk,
+            w_t,
+            w,
+            s_in,
+            s_out,
+        )
+        if schedule is None:
+            tried.append((entries, s_in, s_out, False))
+            continue
+        check = get_scheduled_margins(
+            schedule, p, w, v_in_check, v_out_check, f_sw, f_clk
+        )
+        passed = bool(
+            (check["pm"] >= pm_min).all()
+            and (check["gm"] >= gm_min).all()
+            and (check["num_cross"] == 1).all()
+            and (np.abs(check["w_c"] / w_t - 1) <= bw_tol).all()
+        )
+        tried.append((entries, s_in, s_out, passed))
+        if passed:
+            schedule["check"] = check
+            schedule.update({"w_t": w_t, "w_max": w_max, "p": p, "w": w})
+            schedule["plant"] = (phi, gamma_a, gamma_b, c, n_delay)
+            schedule["duty"] = duty
+            return (schedule, tried)
+    return (None, tried)
+
+
+def get_fixed_gain_margins(schedule, v_in_check, v_out_check, f_sw):
+    """_summary_
+    Get the crossover spread of a single PI tuned at the worst case corner
+    for the same target, for comparison with the schedule.
+
+    Args:
+        schedule (dict): Selected table, see get_gain_schedule_search
+        v_in_check ([float]): Array voltages of the verification grid
+        v_out_check ([float]): Output voltages of the verification grid
+        f_sw (float): Switching (and sampling) frequency
+
+    Returns:
+        dict: pm, gm, num_cross and w_c, (V_IN, V_OUT), and the corner index.
+    """
+    t_s = 1 / f_sw
+    p, w = schedule["p"], schedule["w"]
+    w_grid = np.unique(np.append(w, schedule["w_t"]))
+    corner = np.unravel_index(np.nanargmin(schedule["w_max"]), p.shape[:2])
+    p_corner = np.array(
+        [
+            np.interp(w_grid, w, p[corner].real)
+            + 1j * np.interp(w_grid, w, p[corner].imag)
+        ]
+    )
+    pi = get_pi_at_crossover(p_corner, w_grid, schedule["w_t"], t_s, ratios=pi_ratios)
+    pm, gm, num_cross, w_c = get_pi_margins(p, w, pi["k_p"][0], pi["k_i"][0], t_s)
+    return {"pm": pm, "gm": gm, "num_cross": num_cross, "w_c": w_c, "corner": corner}
+
+
+def get_gain_schedule_map(schedule, fixed, v_in_check, v_out_check):
+    """_summary_
+    Plot the scheduled gains and the crossover over the envelope against a
+    single fixed PI.
+
+    Args:
+        schedule (dict): Selected table, see get_gain_schedule_search
+        fixed (dict): Fixed PI margins, see get_fixed_gain_margins
+        v_in_check ([float]): Array voltages of the verification grid
+        v_out_check ([float]): Output voltages of the verification grid
+    """
+    fig, axs = plt.subplots(1, 3, figsize=(18, 6))
+    for idx, v_out in enumerate(v_out_check):
+        color = f"C{idx}"
+        axs[0].plot(
+            v_in_check,
+            -schedule["check"]["k_i"][:, idx],
+            color=color,
+            label=f"{v_out:.0f} V",
+        )
+        axs[1].plot(
+            v_in_check,
+            schedule["check"]["gm"][:, idx],
+            color=color,
+            label=f"Scheduled, {v_out:.0f} V",
+        )
+        axs[1].plot(
+            v_in_check,
+            fixed["gm"][:, idx],
+            color=color,
+            linestyle="--",
+            label=f"Fixed, {v_out:.0f} V",
+        )
+        axs[2].plot(
+            v_in_check,
+            schedule["check"]["w_c"][:, idx] / (2 * m.pi),
+            color=color,
+            label=f"Scheduled, {v_out:.0f} V",
+        )
+        axs[2].plot(
+            v_in_check,
+            fixed["w_c"][:, idx] / (2 * m.pi),
+            color=color,
+            linestyle="--",
+            label=f"Fixed, {v_out:.0f} V",
+        )
+    for v_in in schedule["v_in"]:
+        for ax in axs:
+            ax.axvline(v_in, color="k", linestyle=":", linewidth=0.5)
+    axs[1].axhline(gm_min, color="r", linestyle="--")
+    f_t = schedule["w_t"] / (2 * m.pi)
+    axs[2].axhspan(f_t * (1 - bw_tol), f_t * (1 + bw_tol), color="g", alpha=0.2)
+    axs[0].set_title("Integral gain -K_I (duty / V s)")
+    axs[1].set_title("Gain margin (dB)")
+    axs[2].set_title("Crossover frequency (Hz)")
+    axs[0].set_yscale("log")
+    axs[2].set_yscale("log")
+    for ax in axs:
+        ax.set_xlabel("Array voltage (V)")
+        ax.grid(True, which="both")
+        ax.legend(fontsize="small")
+    fig.suptitle(
+        f"Gain schedule, {schedule['b'].size} entry table "
+        f"({len(schedule['v_in'])} x {len(schedule['v_out'])})"
+    )
+    plt.savefig("gain_schedule_map.png")
+    plt.show()
+
+
+def export_gain_schedule(schedule, path=None):
+    """_summary_
+    Write the gain table to fw/include/gain_schedule.h, read by the lookup in
+    fw/include/gain_schedule_lookup.h.
+
+    Args:
+        schedule (dict): Selected table, see get_gain_schedule_search
+        path (str, optional): Output directory. Defaults to fw/include.
+
+    Returns:
+        str: Path of the written header.
+    """
+    n_in, n_out = schedule["b"].shape
+    constants = [
+        ("GAIN_SCHEDULE_N_IN", n_in, "V_IN breakpoints"),
+        ("GAIN_SCHEDULE_N_OUT", n_out, "V_OUT breakpoints"),
+        ("GAIN_SCHEDULE_BASE_IN", schedule["base_in"], "ADC counts, first V_IN"),
+        ("GAIN_SCHEDULE_BASE_OUT", schedule["base_out"], "ADC counts, first V_OUT"),
+        ("GAIN_SCHEDULE_SHIFT_IN", schedule["shift_in"], "log2 V_IN spacing"),
+        ("GAIN_SCHEDULE_SHIFT_OUT", schedule["shift_out"], "log2 V_OUT spacing"),
+        ("GAIN_SCHEDULE_FRAC", schedule["frac"], "Q-format of B = B0 = B1"),
+        ("GAIN_SCHEDULE_INTEG_BITS", integ_bits, "Integrator word length"),
+        ("GAIN_SCHEDULE_PWM_PERIOD", schedule["counts"], "Timer counts per period"),
+        ("GAIN_SCHEDULE_F_C", schedule["w_t"] / (2 * m.pi), "Hz, target crossover"),
+    ]
+    arrays = [get_c_array("GAIN_SCHEDULE_B", schedule["b"], "int16_t")]
+    return write_c_header(
+        "gain_schedule.h",
+        "Input voltage loop PI gain schedule, see "
+        "sw/design_procedures/gain_schedule.py.",
+        constants,
+        arrays,
+        path,
+    )
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    num_cells = 111
+    design = dict(default_boost_design)
+    f_sw, f_clk = design["f_sw"], design["f_clk"]
+
+    v_in_check = np.linspace(17.23, 71.7, 24)
+    v_out_check = np.linspace(85, 125, 5)
+
+    schedule, tried = get_gain_schedule_search(
+        design, v_in_check, v_out_check, num_cells, f_sw, f_clk
+    )
+    for entries, s_in, s_out, passed in tried:
+        print(
+            f"{entries:4d} entries (V_IN every {2**s_in:4d}, V_OUT every "
+            f"{2**s_out:4d} counts): {'pass' if passed else 'fail'}"
+        )
+    if schedule is None:
+        raise SystemExit("No table size meets the margins and crossover tolerance.")
+
+    f_t = schedule["w_t"] / (2 * m.pi)
+    print(
+        f"Target crossover {f_t:.1f} Hz ({target_ratio} x worst case achievable "
+        f"{np.nanmin(schedule['w_max']) / (2 * m.pi):.1f} Hz)"
+    )
+    print(
+        f"Selected {len(schedule['v_in'])} x {len(schedule['v_out'])} table, "
+        f"int16 Q{schedule['frac']}: "
+        f"crossover {np.min(schedule['check']['w_c']) / (2 * m.pi):.1f}-"
+        f"{np.max(schedule['check']['w_c']) / (2 * m.pi):.1f} Hz, "
+        f"PM >= {schedule['check']['pm'].min():.1f} deg, GM >= {schedule['check']['gm'].min():.1f} dB"
+    )
+
+    fixed = get_fixed_gain_margins(schedule, v_in_check, v_out_check, f_sw)
+    print(
+        "Fixed PI tuned at V_IN="
+        f"{v_in_check[fixed['corner'][0]]:.1f} V, V_OUT="
+        f"{v_out_check[fixed['corner'][1]]:.0f} V: crossover "
+        f"{np.nanmin(fixed['w_c']) / (2 * m.pi):.1f}-"
+        f"{np.nanmax(fixed['w_c']) / (2 * m.pi):.1f} Hz, "
+        f"PM >= {fixed['pm'].min():.1f} deg, GM >= {fixed['gm'].min():.1f} dB"
+    )
+
+    # Closed loop check of the scheduled fixed point PI.
+    counts, v_lsb, _ = get_counts_scale(f_sw, f_clk)
+    flat = lambda x: x.reshape((-1,) + x.shape[2:])
+    plant = tuple(flat(x) for x in schedule["plant"])
+    batch = len(plant[0])
+    sim = simulate_fixed_point_loop(
+        plant,
+        flat(schedule["check"]["b"]),
+        flat(schedule["check"]["b"]),
+        np.full(batch, integ_bits),
+        np.full(batch, schedule["frac"]),
+        counts,
+        v_lsb,
+        np.repeat(v_in_check, len(v_out_check)),
+        flat(schedule["duty"]),
+        round(v_step / v_lsb),
+    )
+    print(
+        f"Fixed point loop: worst V_IN limit cycle {sim['v_in_pp'].max()} counts, "
+        f"worst tracking error {np.abs(sim['error']).max():.2f} counts, "
+        f"overflow {'yes' if sim['overflow'].any() else 'no'}"
+    )
+    if sim["v_in_pp"].max() > 1:
+        print(
+            f"  {counts} timer counts per period are too coarse for the ADC, "
+            "see fixed_point_design: the table needs a dithered DPWM"
+        )
+
+    get_gain_schedule_map(schedule, fixed, v_in_check, v_out_check)
+    print(f"Wrote {export_gain_schedule(schedule)}")
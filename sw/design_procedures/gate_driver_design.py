@@ -0,0 +1,342 @@
+"""_summary_
+@file       gate_driver_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Gate drive and auxiliary supply losses and bootstrap sizing.
+
+            The switches are driven by an LMG1210 (hw/gate_driver.kicad_sch)
+            from the +12V bus, which comes in on the controller connector from
+            the car's low voltage system. Its internal LDO makes the +5V VDD
+            rail, which charges the low side gate directly and the high side
+            gate through the bootstrap diode D501 and capacitor C503. Per
+            cycle VDD delivers
+                I_DD = I_Q + (2 Q_G + Q_SW) F_SW,
+            Q_SW being the level shifter and output stage charge, and the LDO
+            drops (V_IN - V_DD) I_DD on top of it.
+
+            The Nucleo (hw/controller.kicad_sch) takes the same +12V bus and
+            regulates it linearly to +5V and +3.3V for the microcontroller,
+            debugger and LEDs; the current sense amplifiers run from +12V.
+
+            None of this is seen by the power analyzer on the power path, so
+            loss_calibration.get_loss_breakdown only adds it with aux=True:
+            for the efficiency of the whole converter, the array energy
+            studies and the enclosure heat. It is charged at the +12V
+            connector; the car's own DC-DC to the bus is outside the budget.
+            At low irradiance the rails are a fixed load against a few watts
+            of input, which is where they cost the most efficiency.
+
+            The bootstrap capacitor loses the high side gate charge and the HB
+            quiescent current over the longest high side on time, and gets
+            back a fraction 1 - exp(-T_ON,LS / (R_BOOT C_BOOT)) of its deficit
+            during the shortest low side on time. The steady state minimum
+            HB-HS voltage is then
+                V_BOOT - (Q_G + I_HB T_ON,HS) / C_BOOT / (1 - exp(...)),
+            which sets the smallest capacitor that holds the high side gate
+            above v_boot_min. A larger capacitor only helps down to the limit
+            (Q_G + I_HB T_ON,HS) R_BOOT / T_ON,LS of the recharge path.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+
+import matplotlib.pyplot as plt
+import numpy as np
+from scipy.optimize import brentq
+
+from design_procedures.converter_model import (
+    default_boost_design,
+    default_num_cells,
+    default_v_in_range,
+    default_v_out_range,
+)
+from design_procedures.nonideal_model import model_nonideal_cell_vec
+
+# LMG1210 and its bootstrap, hw/gate_driver.kicad_sch. Currents are nominal
+# datasheet values.
+gate_driver = {
+    "v_in": 12.0,  # V, VIN from +12V
+    "v_dd": 5.0,  # V, internal LDO (+5V)
+    "i_q_dd": 0.45e-3,  # A, VDD quiescent with both channels idle
+    "i_q_hb": 0.08e-3,  # A, HB quiescent
+    "q_sw": 0.9e-9,  # C per cycle, level shifter and output stages
+    "c_boot": 1e-6,  # F, C503
+    "c_dd": 10e-6,  # F, C505
+    "v_f_boot": 0.62,  # V, D501
+    "r_boot": 1.0,  # Ohm, diode and loop of the recharge path
+    "v_boot_min": 4.0,  # V, lowest high side drive before R_DS_ON climbs
+}
+
+# Auxiliary rails in source order, all linear. The sense amplifiers (2x
+# INA210, 2x OPA990) sit on +12V; the Nucleo makes +5V and +3.3V.
+aux_rails = {
+    "12v": {"v": 12.0, "source": None, "i_q": 0.0},
+    "5v": {"v": 5.0, "source": "12v", "i_q": 5e-3},
+    "3v3": {"v": 3.3, "source": "5v", "i_q": 0.25e-3},
+}
+aux_loads = {
+    "sensors": ("12v", 2 * 0.1e-3 + 2 * 0.25e-3),  # A
+    "mcu": ("3v3", 10e-3),  # STM32L432 at 80 MHz, ADC and timers running
+    "st_link": ("3v3", 20e-3),  # On board debugger of the Nucleo
+    "leds": ("3v3", 3 * 2e-3),  # Blue, red and yellow
+}
+
+
+def get_gate_drive_losses(design, f_sw, driver=gate_driver):
+    """_summary_
+    Get the power the gate driver draws from the +12V bus and where it goes.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        f_sw (float|np.ndarray): Switching frequency (Hz)
+        driver (dict, optional): Gate driver, see gate_driver. Defaults to
+            gate_driver.
+
+    Returns:
+        dict: Power (W) of "gate" (both gate loops), "boot" (bootstrap
+            diode), "switching" (level shifter and output stages),
+            "quiescent", "ldo" (VIN to VDD), their sum "total", and the VIN
+            current "i_in" (A).
+    """
+    f_sw = np.asarray(f_sw, dtype=float)
+    q_g, v_dd = design["q_g"], driver["v_dd"]
+    i_q = driver["i_q_dd"] + driver["i_q_hb"]
+    i_dd = i_q + (2 * q_g + driver["q_sw"]) * f_sw
+
+    loss = {
+        "gate": (2 * v_dd - driver["v_f_boot"]) * q_g * f_sw,
+        "boot": driver["v_f_boot"] * q_g * f_sw,
+        "switching": v_dd * driver["q_sw"] * f_sw,
+        "quiescent": np.full_like(f_sw, v_dd * i_q),
+        "ldo": (driver["v_in"] - v_dd) * i_dd,
+    }
+    loss["total"] = sum(loss.values())
+    loss["i_in"] = i_dd
+    return loss
+
+
+def get_bootstrap_sizing(design, f_sw, duty_min, driver=gate_driver):
+    """_summary_
+    Get the bootstrap voltage and the smallest bootstrap capacitor. In the
+    boost converter the high side is the synchronous switch SW2, on for
+    (1 - D) T_SW, and the capacitor recharges while SW1 is on for D T_SW.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        f_sw (float): Switching frequency (Hz)
+        duty_min (float): Smallest SW1 duty cycle
+        driver (dict, optional): Gate driver, see gate_driver. Defaults to
+            gate_driver.
+
+    Returns:
+        dict: "v_boot" (V) fully charged, "v_min" (V) steady state minimum
+            with driver["c_boot"], "c_min" (F) to hold v_boot_min (inf when
+            the recharge path cannot), "v_floor" (V) minimum with an
+            unlimited capacitor, "c_dd_ratio" of VDD to bootstrap
+            capacitance, and the longest high side "t_on_hs_max" and
+            shortest low side "t_on_ls_min" on times (s).
+    """
+    v_boot = driver["v_dd"] - driver["v_f_boot"]
+    t_on_hs = (1 - duty_min) / f_sw
+    t_on_ls = max(duty_min, 1e-3) / f_sw
+    q = design["q_g"] + driver["i_q_hb"] * t_on_hs
+
+    def get_v_min(c_boot):
+        tau = driver["r_boot"] * c_boot
+        return v_boot - q / c_boot / -np.expm1(-t_on_ls / tau)
+
+    v_floor = v_boot - q * driver["r_boot"] / t_on_ls
+    if v_floor <= driver["v_boot_min"]:
+        c_min = np.inf
+    else:
+        c_min = brentq(lambda c: get_v_min(c) - driver["v_boot_min"], 1e-12, 1e-2)
+
+    return {
+        "v_boot": v_boot,
+        "v_min": get_v_min(driver["c_boot"]),
+        "c_min": c_min,
+        "v_floor": v_floor,
+        "c_dd_ratio": driver["c_dd"] / driver["c_boot"],
+        "t_on_hs_max": t_on_hs,
+        "t_on_ls_min": t_on_ls,
+    }
+
+
+def get_aux_rail_losses(rails=aux_rails, loads=aux_loads, i_extra=None):
+    """_summary_
+    Get the current and loss of every auxiliary rail.
+
+    Args:
+        rails (dict, optional): Rails in source order, see aux_rails.
+            Defaults to aux_rails.
+        loads (dict, optional): Load name to (rail, current in A). Defaults
+            to aux_loads.
+        i_extra (dict, optional): Additional current (A) per rail, such as
+            the gate driver on "12v". Defaults to None.
+
+    Returns:
+        dict: For each rail a dict of "i_out" and "i_in" (A) and regulator
+            "loss" (W), and "p_bus" (W) drawn at the root rail, all of it
+            ending up as heat.
+    """
+    i_out = {name: 0.0 for name in rails}
+    for rail, i in loads.values():
+        i_out[rail] = i_out[rail] + i
+    for rail, i in (i_extra or {}).items():
+        i_out[rail] = i_out[rail] + i
+
+    result = {}
+    for name in reversed(list(rails)):
+        rail = rails[name]
+        i_in = i_out[name] + rail["i_q"]
+        loss = 0.0
+        if rail["source"] is not None:
+            v_src = rails[rail["source"]]["v"]
+            loss = (v_src - rail["v"]) * i_out[name] + v_src * rail["i_q"]
+            i_out[rail["source"]] = i_out[rail["source"]] + i_in
+        result[name] = {"i_out": i_out[name], "i_in": i_in, "loss": loss}
+
+    root = next(iter(rails))
+    result["p_bus"] = rails[root]["v"] * result[root]["i_in"]
+    return result
+
+
+def get_auxiliary_losses(design, f_sw, driver=gate_driver):
+    """_summary_
+    Get the gate drive and auxiliary rail power drawn from the +12V bus, for
+    loss_calibration.get_loss_breakdown.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        f_sw (float|np.ndarray): Switching frequency (Hz)
+        driver (dict, optional): Gate driver, see gate_driver. Defaults to
+            gate_driver.
+
+    Returns:
+        (np.ndarray, np.ndarray): Gate driver power and the power of the
+            remaining rails and loads (W), shaped like f_sw.
+    """
+    gate = get_gate_drive_losses(design, f_sw, driver)["total"]
+    aux = get_aux_rail_losses()["p_bus"]
+    return gate, np.full_like(gate, aux)
+
+
+def get_gate_driver_map(design, num_cells, v_out, f_sws, driver=gate_driver):
+    """_summary_
+    Plot the gate drive loss across switching frequency, the bootstrap
+    minimum voltage across capacitance, and the converter efficiency at the
+    array MPP across irradiance with and without the gate drive and rails.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        num_cells (int): Number of solar cells in the string
+        v_out (float): Output voltage (V)
+        f_sws (list): Switching frequencies of the efficiency curves (Hz)
+        driver (dict, optional): Gate driver, see gate_driver. Defaults to
+            gate_driver.
+    """
+    # Imported here, loss_calibration imports this module.
+    from design_procedures.loss_calibration import get_loss_breakdown
+
+    fig, axs = plt.subplots(1, 3, figsize=(18, 5.5))
+
+    f_sw = np.linspace(10e3, 500e3, 200)
+    loss = get_gate_drive_losses(design, f_sw, driver)
+    names = ["gate", "boot", "switching", "quiescent", "ldo"]
+    axs[0].stackplot(f_sw / 1e3, [loss[k] for k in names], labels=names)
+    axs[0].axhline(get_aux_rail_losses()["p_bus"], color="k", ls="--", label="rails")
+    axs[0].set_title("LMG1210 power from +12V")
+    axs[0].set_xlabel("F_SW (kHz)")
+    axs[0].set_ylabel("Power (W)")
+    axs[0].legend(loc="upper left")
+    axs[0].grid()
+
+    c_boot = np.logspace(-8, -5, 100)
+    for f in f_sws:
+        v_min = [
+            get_bootstrap_sizing(design, f, 0.12, dict(driver, c_boot=c))["v_min"]
+            for c in c_boot
+        ]
+        axs[1].semilogx(c_boot * 1e6, v_min, label=f"{f / 1e3 :.0f} kHz")
+    axs[1].axhline(driver["v_boot_min"], color="r", ls="--", label="V_BOOT_MIN")
+    axs[1].axvline(driver["c_boot"] * 1e6, color="k", ls=":", label="C503")
+    axs[1].set_ylim(0, driver["v_dd"])
+    axs[1].set_title("Minimum bootstrap voltage, D = 0.12")
+    axs[1].set_xlabel("C_BOOT (uF)")
+    axs[1].set_ylabel("V_HB - V_HS (V)")
+    axs[1].legend()
+    axs[1].grid(which="both")
+
+    # MPP of the string at 25 C across irradiance.
+    g = np.linspace(25, 1000, 80)
+    v = np.linspace(0.3, 0.72, 400)
+    i, _ = model_nonideal_cell_vec(g[:, None], 298.15, 0, 100, v[None, :])
+    k = np.argmax(v * i, axis=1)
+    v_in = num_cells * v[k]
+    i_in = i[np.arange(len(g)), k]
+    p_in = v_in * i_in
+    for f in f_sws:
+        power_path = get_loss_breakdown(design, v_in, i_in, v_out, f)["total"]
+        system = get_loss_breakdown(design, v_in, i_in, v_out, f, aux=True)["total"]
+        (line,) = axs[2].plot(g, (1 - power_path / p_in) * 100, ls="--")
+        axs[2].plot(
+            g,
+            (1 - system / p_in) * 100,
+            color=line.get_color(),
+            label=f"{f / 1e3 :.0f} kHz",
+        )
+    axs[2].set_ylim(90, 100)
+    axs[2].set_title(
+        f"Efficiency at the MPP, V_OUT {v_out :.0f} V (dashed: power path)"
+    )
+    axs[2].set_xlabel("Irradiance (W/m^2)")
+    axs[2].set_ylabel("Efficiency (%)")
+    axs[2].legend()
+    axs[2].grid()
+
+    fig.tight_layout()
+    plt.savefig("gate_driver_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    design = default_boost_design
+    num_cells = default_num_cells
+    v_in_range = default_v_in_range
+    v_out_range = default_v_out_range
+    f_sw = 100e3
+
+    duty_min = 1 - v_in_range[2] / v_out_range[0]
+    loss = get_gate_drive_losses(design, f_sw)
+    rails = get_aux_rail_losses(i_extra={"12v": loss["i_in"]})
+    boot = get_bootstrap_sizing(design, f_sw, duty_min)
+
+    print(f"Gate driver at {f_sw / 1e3 :.0f} kHz, Q_G {design['q_g'] * 1e9 :.1f} nC:")
+    for key in ("gate", "boot", "switching", "quiescent", "ldo", "total"):
+        print(f"\t{key:>10} {loss[key] * 1e3 :7.1f} mW")
+    print("Auxiliary rails, gate driver included:")
+    for name in aux_rails:
+        print(
+            f"\t{name:>10} {rails[name]['i_out'] * 1e3 :6.1f} mA out, "
+            f"{rails[name]['loss'] * 1e3 :6.1f} mW regulator loss"
+        )
+    print(f"\t{'+12V bus' :>10} {rails['p_bus'] :.3f} W")
+    print(
+        f"Bootstrap: {boot['v_boot'] :.2f} V charged, {boot['v_min'] :.2f} V "
+        f"minimum with {gate_driver['c_boot'] * 1e6 :.1f} uF over "
+        f"{boot['t_on_hs_max'] * 1e6 :.1f} us, C_BOOT >= "
+        f"{boot['c_min'] * 1e9 :.1f} nF for {gate_driver['v_boot_min'] :.1f} V, "
+        f"C_DD / C_BOOT {boot['c_dd_ratio'] :.0f}"
+    )
+
+    get_gate_driver_map(design, num_cells, v_out_range[1], [50e3, 100e3, 200e3])
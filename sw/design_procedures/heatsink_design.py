@@ -0,0 +1,254 @@
+"""_summary_
+@file       heatsink_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Heatsink catalogue and plate fin array model for R_SA.
+
+            A heatsink is a base of L x W (L along the fins) and N plate fins
+            of height H and thickness T_F, leaving channels of width S. The
+            fins see a channel heat transfer coefficient that combines
+                natural convection, Bar-Cohen and Rohsenow for isothermal
+                parallel plates,
+                    NU_S = (576 / EL^2 + 2.873 / EL^0.5)^-0.5,
+                    EL   = G BETA DT S^4 / (NU ALPHA L),
+                forced convection, the Teertstra et al. developing channel
+                flow composite,
+                    NU_S = ((RE* PR / 2)^-3
+                            + (0.664 RE*^0.5 PR^(1/3)
+                               (1 + 3.65 RE*^-0.5)^0.5)^-3)^(-1/3),
+                    RE*  = V_CH S^2 / (NU L),
+            as H = (H_NAT^3 + H_FORCED^3)^(1/3). The fins carry it at their
+            fin efficiency and the exposed base directly. The envelope of the
+            array radiates and, in still air, also carries the laminar
+            vertical plate coefficient 1.42 (DT / L)^0.25 on its outside,
+            which dominates for small, tightly finned parts. Orientation only
+            scales the natural convection: fins pointing up or down stall the
+            chimney flow of vertical channels.
+
+            Spreading in the base and the interface are left to
+            thermal_design.get_r_ja, which takes the base area as the contact
+            area.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+k_al = 200.0  # W/m/K, 6063 aluminum extrusion
+sigma = 5.670e-8  # W/m^2/K^4, Stefan-Boltzmann constant
+gravity = 9.81  # m/s^2
+channel_fraction = 0.6  # Share of the free stream entering unducted channels
+
+# Natural convection of the array relative to vertical fins and channels.
+orientation_factor = {
+    "vertical": 1.0,
+    "horizontal_up": 0.8,  # Base horizontal, fins up
+    "sideways": 0.6,  # Base vertical, channels horizontal
+    "horizontal_down": 0.4,  # Base horizontal, fins down
+}
+
+# Dimensions in m. The WayinTop part is the 20 x 15 mm footprint of
+# hw/footprints/WayinTop_HS.kicad_mod; its fin count and height, like the
+# generic extrusions, are nominal. Every part is a plate fin array; pin fin
+# parts are not modelled.
+heatsink_catalogue = {
+    "WayinTop_HS": {
+        "l": 20e-3,
+        "w": 15e-3,
+        "t_b": 2e-3,
+        "h": 8e-3,
+        "t_f": 1e-3,
+        "n": 6,
+        "emissivity": 0.85,  # Black anodized
+    },
+    "Extrusion_25x25x10": {
+        "l": 25e-3,
+        "w": 25e-3,
+        "t_b": 2.5e-3,
+        "h": 10e-3,
+        "t_f": 1.2e-3,
+        "n": 8,
+        "emissivity": 0.85,
+    },
+    "Extrusion_40x40x11": {
+        "l": 40e-3,
+        "w": 40e-3,
+        "t_b": 3e-3,
+        "h": 11e-3,
+        "t_f": 1.2e-3,
+        "n": 11,
+        "emissivity": 0.85,
+    },
+    "Extrusion_40x40x20": {
+        "l": 40e-3,
+        "w": 40e-3,
+        "t_b": 3e-3,
+        "h": 20e-3,
+        "t_f": 1.5e-3,
+        "n": 9,
+        "emissivity": 0.85,
+    },
+    "Plate_14x14x6_bare": {
+        "l": 14e-3,
+        "w": 14e-3,
+        "t_b": 1.5e-3,
+        "h": 6e-3,
+        "t_f": 1e-3,
+        "n": 5,
+        "emissivity": 0.1,  # Bare aluminum
+    },
+}
+
+
+def get_air_properties(t):
+    """_summary_
+    Get the properties of dry air at 1 atm.
+
+    Args:
+        t (float|np.ndarray): Temperature, in K
+
+    Returns:
+        (float|np.ndarray, ...): Thermal conductivity (W/m/K), kinematic
+            viscosity (m^2/s), thermal diffusivity (m^2/s) and Prandtl number.
+    """
+    k = 0.0241 + 7.4e-5 * (t - 273.15)
+    mu = 1.716e-5 * (t / 273.15) ** 1.5 * (273.15 + 110.4) / (t + 110.4)
+    nu = mu * 287.05 * t / 101325
+    pr = 0.71
+    return k, nu, nu / pr, pr
+
+
+def get_base_area(heatsink):
+    """_summary_
+    Get the contact area of a heatsink base.
+
+    Args:
+        heatsink (dict): Heatsink, see heatsink_catalogue
+
+    Returns:
+        float: Area, in m^2.
+    """
+    return heatsink["l"] * heatsink["w"]
+
+
+def get_r_sa(heatsink, v_air=0.0, orientation="vertical", dt=40.0, t_amb=60.0):
+    """_summary_
+    Get the sink to ambient thermal resistance of a plate fin heatsink.
+
+    Args:
+        heatsink (dict): Heatsink, see heatsink_catalogue
+        v_air (float|np.ndarray, optional): Approach air speed along the
+            fins, in m/s. Defaults to 0.0.
+        orientation (str, optional): Key of orientation_factor. Defaults to
+            "vertical".
+        dt (float|np.ndarray, optional): Sink over ambient temperature, in
+            K. Defaults to 40.0.
+        t_amb (float, optional): Ambient temperature, in C. Defaults to 60.0.
+
+    Returns:
+        float|np.ndarray: R_SA, in C/W.
+    """
+    l, w, h, t_f, n = (heatsink[k] for k in ("l", "w", "h", "t_f", "n"))
+    s = (w - n * t_f) / (n - 1)  # Channel width
+    v_air, dt = np.broadcast_arrays(
+        np.asarray(v_air, dtype=float), np.asarray(dt, dtype=float)
+    )
+
+    t_a = t_amb + 273.15
+    t_film = t_a + dt / 2
+    k, nu, alpha, pr = get_air_properties(t_film)
+
+    # Natural convection between the fins.
+    el = gravity / t_film * np.maximum(dt, 1e-3) * s**4 / (nu * alpha * l)
+    nu_nat = (576 / el**2 + 2.873 / np.sqrt(el)) ** -0.5
+    h_nat = nu_nat * k / s * orientation_factor[orientation]
+
+    # Forced convection in the channels.
+    v_ch = v_air * channel_fraction * (s + t_f) / s
+    re = np.maximum(v_ch, 1e-6) * s**2 / (nu * l)
+    nu_fd = re * pr / 2
+    nu_dev = 0.664 * np.sqrt(re) * pr ** (1 / 3) * np.sqrt(1 + 3.65 / np.sqrt(re))
+    h_forced = (nu_fd**-3 + nu_dev**-3) ** (-1 / 3) * k / s
+
+    h_conv = (h_nat**3 + h_forced**3) ** (1 / 3)
+
+    # Fins at their efficiency, exposed base between them.
+    h_c = h + t_f / 2
+    m = np.sqrt(2 * h_conv / (k_al * t_f))
+    eta = np.tanh(m * h_c) / (m * h_c)
+    a_fins = n * (2 * h + t_f) * l
+    a_base = (n - 1) * s * l
+    g_conv = h_conv * (eta * a_fins + a_base)
+
+    # The envelope radiates, the fins mostly see each other, and carries the
+    # outer boundary layer, blended with the forced flow like the channels.
+    t_s = t_a + dt
+    h_rad = heatsink["emissivity"] * sigma * (t_s**2 + t_a**2) * (t_s + t_a)
+    a_env = l * w + 2 * (l + w) * (h + heatsink["t_b"])
+    h_env = 1.42 * (np.maximum(dt, 1e-3) / l) ** 0.25
+    h_env = h_env * orientation_factor[orientation]
+    h_env = (h_env**3 + h_forced**3) ** (1 / 3)
+    g_env = (h_rad + h_env) * a_env
+
+    return 1 / (g_conv + g_env)
+
+
+def get_heatsink_map(v_air, orientation="vertical", dt=40.0, t_amb=60.0):
+    """_summary_
+    Plot R_SA across air speed for every heatsink in the catalogue.
+
+    Args:
+        v_air (np.ndarray): Approach air speeds, in m/s
+        orientation (str, optional): Key of orientation_factor. Defaults to
+            "vertical".
+        dt (float, optional): Sink over ambient temperature, in K. Defaults
+            to 40.0.
+        t_amb (float, optional): Ambient temperature, in C. Defaults to 60.0.
+    """
+    fig, axs = plt.subplots(1, 2, figsize=(14, 5.5))
+    for name, heatsink in heatsink_catalogue.items():
+        axs[0].plot(
+            v_air, get_r_sa(heatsink, v_air, orientation, dt, t_amb), label=name
+        )
+    axs[0].set_title(f"R_SA vs air speed, {orientation}, {dt :.0f} K rise")
+    axs[0].set_xlabel("Air speed (m/s)")
+    axs[0].set_ylabel("R_SA (C/W)")
+    axs[0].set_yscale("log")
+    axs[0].legend()
+    axs[0].grid(which="both")
+
+    names = list(heatsink_catalogue)
+    x = np.arange(len(names))
+    for k, orient in enumerate(orientation_factor):
+        r_sa = [get_r_sa(heatsink_catalogue[n], 0.0, orient, dt, t_amb) for n in names]
+        axs[1].bar(x + (k - 1.5) * 0.2, r_sa, 0.2, label=orient)
+    axs[1].set_xticks(x, names, rotation=15)
+    axs[1].set_title("Natural convection R_SA by orientation")
+    axs[1].set_ylabel("R_SA (C/W)")
+    axs[1].legend()
+    axs[1].grid(axis="y")
+
+    fig.tight_layout()
+    plt.savefig("heatsink_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    v_air = np.linspace(0, 5, 101)
+    print(f"{'':>20}" + "".join(f"{v :>9.1f} m/s" for v in (0, 0.5, 1, 2, 5)))
+    for name, heatsink in heatsink_catalogue.items():
+        r_sa = get_r_sa(heatsink, [0, 0.5, 1, 2, 5])
+        print(f"{name:>20}" + "".join(f"{r :>9.1f} C/W" for r in r_sa))
+    get_heatsink_map(v_air)
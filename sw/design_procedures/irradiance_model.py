@@ -0,0 +1,485 @@
+"""_summary_
+@file       irradiance_model.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Stochastic irradiance time series with cloud transients, for
+            exercising the tracker and the thermal models.
+
+            G(t) = G_CLEAR(t) K(t), with G_CLEAR the Haurwitz clear sky
+            irradiance on a horizontal surface and K the clear sky index.
+            K follows a semi-Markov sky regime, with the entry probabilities
+            and mean dwell times of the climate class:
+            - clear, K = 1,
+            - broken, alternating cloud and gap chords of lognormal length
+              blown past at the episode wind speed, with Beta distributed
+              cloud transmittance, edges that ramp over the edge width at the
+              wind speed, and cloud enhancement spikes above K = 1, up to
+              enh_max, as the sun leaves a cloud,
+            - overcast, a slow AR(1) walk of K around the class mean.
+            K is built as a piecewise linear curve of breakpoints, drawn an
+            episode at a time with vectorized draws, and sampled onto the
+            time grid with np.interp, so that years at 10 ms stream through
+            in chunks of bounded memory.
+
+            Partial shading events (trees, overpasses, other vehicles) arrive
+            as a Poisson process independent of the sky. During an event a
+            fraction of the array sees only the diffuse part of G.
+
+            The parameters of the classes are representative, not fitted to
+            measured data.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+from scipy.signal import lfilter
+
+CLEAR, BROKEN, OVERCAST = 0, 1, 2
+regime_names = ["Clear", "Broken", "Overcast"]
+
+latitude = 30.28  # deg, Austin, TX
+edge_width = 100.0  # m, median cloud edge width
+chord_sigma = 0.8  # lognormal sigma of cloud and gap chords
+overcast_step = 60.0  # s, breakpoint spacing of the overcast walk
+overcast_rho = 0.9  # AR(1) coefficient of the overcast walk per step
+enh_max = 0.6  # Highest enhancement above K = 1
+clear_sky_step = 1.0  # s, G_CLEAR is interpolated between these points
+
+# p_regime - relative probability of entering a clear, broken or overcast sky
+# dwell - mean regime duration (h)
+# cloud_k - Beta (a, b) of the cloud transmittance
+# chord_cloud, chord_gap - median cloud and gap chord (m)
+# wind - median cloud speed (m/s)
+# p_enh, enh_peak - probability and mean height of an enhancement spike
+# overcast_k - mean and standard deviation of K under overcast
+climate_classes = {
+    "arid": {
+        "p_regime": [0.8, 0.15, 0.05],
+        "dwell": [6.0, 1.5, 3.0],
+        "cloud_k": (5.0, 3.0),
+        "chord_cloud": 300.0,
+        "chord_gap": 1500.0,
+        "wind": 6.0,
+        "p_enh": 0.5,
+        "enh_peak": 0.25,
+        "overcast_k": (0.4, 0.1),
+    },
+    "temperate": {
+        "p_regime": [0.35, 0.4, 0.25],
+        "dwell": [3.0, 2.0, 6.0],
+        "cloud_k": (2.0, 4.0),
+        "chord_cloud": 800.0,
+        "chord_gap": 600.0,
+        "wind": 7.0,
+        "p_enh": 0.6,
+        "enh_peak": 0.35,
+        "overcast_k": (0.25, 0.08),
+    },
+    "tropical": {
+        "p_regime": [0.3, 0.55, 0.15],
+        "dwell": [2.0, 3.0, 2.0],
+        "cloud_k": (2.0, 5.0),
+        "chord_cloud": 1500.0,
+        "chord_gap": 800.0,
+        "wind": 4.0,
+        "p_enh": 0.7,
+        "enh_peak": 0.45,
+        "overcast_k": (0.2, 0.08),
+    },
+    "maritime": {
+        "p_regime": [0.2, 0.4, 0.4],
+        "dwell": [2.0, 2.0, 8.0],
+        "cloud_k": (2.0, 4.0),
+        "chord_cloud": 1000.0,
+        "chord_gap": 500.0,
+        "wind": 9.0,
+        "p_enh": 0.5,
+        "enh_peak": 0.3,
+        "overcast_k": (0.2, 0.06),
+    },
+}
+
+# Partial shading events while driving.
+shade_rate = 60.0  # events per hour
+shade_duration = 0.5  # s, median duration
+shade_fraction = (0.05, 0.6)  # range of the shaded fraction of the array
+diffuse_ratio = (0.1, 0.3)  # range of the diffuse share of G in the shade
+
+
+def get_solar_angles(t, latitude=latitude, day_0=172):
+    """_summary_
+    Get the approximate solar zenith and azimuth from the declination and the
+    hour angle in local solar time.
+
+    Args:
+        t (np.ndarray): Time from local solar midnight of day DAY_0 (s)
+        latitude (float, optional): Latitude (deg). Defaults to latitude.
+        day_0 (int, optional): Day of the year at t = 0. Defaults to 172.
+
+    Returns:
+        (np.ndarray, np.ndarray): Zenith and azimuth, clockwise from north
+            (rad).
+    """
+    day = day_0 + np.asarray(t) / 86400
+    decl = np.radians(23.45) * np.sin(2 * np.pi * (284 + day) / 365)
+    hour = 2 * np.pi * (np.asarray(t) % 86400 / 86400 - 0.5)
+    phi = np.radians(latitude)
+    cos_z = np.sin(phi) * np.sin(decl) + np.cos(phi) * np.cos(decl) * np.cos(hour)
+    zenith = np.arccos(np.clip(cos_z, -1, 1))
+    # Azimuth from the east and north components of the sun direction.
+    east = -np.cos(decl) * np.sin(hour)
+    north = np.cos(phi) * np.sin(decl) - np.sin(phi) * np.cos(decl) * np.cos(hour)
+    return (zenith, np.arctan2(east, north) % (2 * np.pi))
+
+
+def get_clear_sky_zenith(zenith):
+    """_summary_
+    Get the Haurwitz clear sky irradiance on a horizontal surface,
+        G_CLEAR = 1098 cos Z exp(-0.057 / cos Z).
+
+    Args:
+        zenith (np.ndarray): Solar zenith angle (rad)
+
+    Returns:
+        np.ndarray: Irradiance (W/m^2).
+    """
+    cos_z = np.maximum(np.cos(zenith), 1e-6)
+    return np.where(cos_z > 1e-3, 1098 * cos_z * np.exp(-0.057 / cos_z), 0.0)
+
+
+def get_clear_sky(t, latitude=latitude, day_0=172):
+    """_summary_
+    Get the Haurwitz clear sky irradiance on a horizontal surface at a time
+    of day, see get_clear_sky_zenith.
+
+    Args:
+        t (np.ndarray): Time from local solar midnight of day DAY_0 (s)
+        latitude (float, optional): Latitude (deg). Defaults to latitude.
+        day_0 (int, optional): Day of the year at t = 0. Defaults to 172.
+
+    Returns:
+        np.ndarray: Irradiance (W/m^2).
+    """
+    return get_clear_sky_zenith(get_solar_angles(t, latitude, day_0)[0])
+
+
+def get_broken_episode(rng, params, t_0, t_1):
+    """_summary_
+    Draw the clear sky index breakpoints of a broken sky episode.
+
+    Args:
+        rng (np.random.Generator): Random source
+        params (dict): Climate class, see climate_classes
+        t_0 (float): Episode start (s)
+        t_1 (float): Episode end (s)
+
+    Returns:
+        (np.ndarray, np.ndarray): Breakpoint times and clear sky indices.
+    """
+    wind = params["wind"] * rng.lognormal(0, 0.3)
+    mean_pair = (params["chord_cloud"] + params["chord_gap"]) / wind
+    num = int((t_1 - t_0) / mean_pair * 2) + 4
+
+    edge = edge_width * rng.lognormal(0, 0.5, (2, num)) / wind
+    enh_time = 2 * edge_width * rng.lognormal(0, 0.5, num) / wind
+    d_cloud = params["chord_cloud"] * rng.lognormal(0, chord_sigma, num) / wind
+    d_gap = params["chord_gap"] * rng.lognormal(0, chord_sigma, num) / wind
+    d_cloud = np.maximum(d_cloud, edge[0] + 0.01)
+    d_gap = np.maximum(d_gap, edge[1] + enh_time + 0.01)
+    k_cloud = rng.beta(*params["cloud_k"], num)
+    enh = rng.random(num) < params["p_enh"]
+    k_peak = 1 + enh * np.minimum(rng.exponential(params["enh_peak"], num), enh_max)
+
+    start = t_0 + np.concatenate([[0], np.cumsum(d_cloud + d_gap)[:-1]])
+    times = np.stack(
+        [
+            start + edge[0],
+            start + d_cloud,
+            start + d_cloud + edge[1],
+            start + d_cloud + edge[1] + enh_time,
+        ],
+        axis=1,
+    ).ravel()
+    values = np.stack([k_cloud, k_cloud, k_peak, np.ones(num)], axis=1).ravel()
+    keep = times < t_1
+    return (times[keep], values[keep])
+
+
+def get_episode(rng, params, regime, t_0, t_1):
+    """_summary_
+    Draw the clear sky index breakpoints of a sky regime episode.
+
+    Args:
+        rng (np.random.Generator): Random source
+        params (dict): Climate class, see climate_classes
+        regime (int): CLEAR, BROKEN or OVERCAST
+        t_0 (float): Episode start (s)
+        t_1 (float): Episode end (s)
+
+    Returns:
+        (np.ndarray, np.ndarray): Breakpoint times and clear sky indices.
+    """
+    if regime == BROKEN:
+        return get_broken_episode(rng, params, t_0, t_1)
+    ramp = edge_width / params["wind"]
+    if regime == CLEAR:
+        # A dwell shorter than the ramp reaches clear sky at its end.
+        return (np.array([min(t_0 + ramp, t_1), t_1]), np.ones(2))
+    mean, std = params["overcast_k"]
+    times = np.arange(t_0 + ramp, t_1, overcast_step)
+    noise = rng.standard_normal(len(times)) * std * (1 - overcast_rho**2) ** 0.5
+    walk = lfilter([1], [1, -overcast_rho], noise, zi=[std * rng.standard_normal()])
+    return (times, np.clip(mean + walk[0], 0.05, 0.9))
+
+
+def stream_irradiance(
+    climate="temperate",
+    seed=0,
+    duration=365 * 86400.0,
+    dt=0.01,
+    chunk=3600.0,
+    latitude=latitude,
+    day_0=172,
+    shade_rate=shade_rate,
+):
+    """_summary_
+    Stream a synthetic irradiance time series in chunks.
+
+    Args:
+        climate (str, optional): Climate class, see climate_classes. Defaults
+            to "temperate".
+        seed (int, optional): Random seed. Defaults to 0.
+        duration (float, optional): Length (s). Defaults to a year.
+        dt (float, optional): Time step (s). Defaults to 0.01.
+        chunk (float, optional): Chunk length (s). Defaults to an hour.
+        latitude (float, optional): Latitude (deg). Defaults to latitude.
+        day_0 (int, optional): Day of the year at the start, which is local
+            solar midnight. Defaults to 172.
+        shade_rate (float, optional): Partial shading events per hour, 0 for
+            none. Defaults to shade_rate.
+
+    Yields:
+        dict: Per chunk, arrays over its time steps:
+            t - time (s)
+            g - unshaded irradiance (W/m^2)
+            k - clear sky index
+            regime - sky regime
+            shade_fraction - fraction of the array in shade
+            g_shade - irradiance on the shaded part (W/m^2)
+    """
+    rng = np.random.default_rng(seed)
+    params = climate_classes[climate]
+    p_regime = np.asarray(params["p_regime"])
+
+    # Pending breakpoints of K and the regime changes, kept past each chunk.
+    bp_t, bp_k = np.array([0.0]), np.array([1.0])
+    reg_t, reg = np.array([0.0]), np.array([rng.choice(3, p=p_regime)])
+    # Shading events, starting with an empty one that has already ended.
+    sh_start, sh_end = np.array([-1.0]), np.array([-1.0])
+    sh_frac, sh_ratio = np.zeros(1), np.ones(1)
+    t_gen = 0.0
+    t_shade = rng.exponential(3600 / shade_rate) if shade_rate > 0 else np.inf
+
+    num_chunks = int(np.ceil(duration / chunk))
+    steps = int(round(chunk / dt))
+    for idx in range(num_chunks):
+        t = idx * chunk + np.arange(steps) * dt
+        t = t[t < duration]
+        t_end = t[-1] + dt
+
+        while t_gen < t_end:
+            regime = reg[-1]
+            dwell = rng.exponential(params["dwell"][regime] * 3600)
+            times, values = get_episode(rng, params, regime, t_gen, t_gen + dwell)
+            if len(times) and times[0] < bp_t[-1]:
+                raise Exception("Clear sky index breakpoints must not decrease.")
+            bp_t = np.concatenate([bp_t, times])
+            bp_k = np.concatenate([bp_k, values])
+            t_gen += dwell
+            # Next regime, with the entry probabilities of the others.
+            p_next = np.where(np.arange(3) == regime, 0, p_regime)
+            reg_t = np.append(reg_t, t_gen)
+            reg = np.append(reg, rng.choice(3, p=p_next / p_next.sum()))
+
+        while t_shade < t_end:
+            num = int(shade_rate * chunk / 3600 * 2) + 4
+            gaps = rng.exponential(3600 / shade_rate, num)
+            starts = t_shade + np.concatenate([[0], np.cumsum(gaps)[:-1]])
+            durations = np.minimum(
+                shade_duration * rng.lognormal(0, 1, num), 0.9 * gaps
+            )
+            sh_start = np.concatenate([sh_start, starts])
+            sh_end = np.concatenate([sh_end, starts + durations])
+            sh_frac = np.concatenate([sh_frac, rng.uniform(*shade_fraction, num)])
+            sh_ratio = np.concatenate([sh_ratio, rng.uniform(*diffuse_ratio, num)])
+            t_shade = starts[-1] + gaps[-1]
+
+        k = np.interp(t, bp_t, bp_k)
+        regime = reg[np.searchsorted(reg_t, t, side="right") - 1]
+        event = np.maximum(np.searchsorted(sh_start, t, side="right") - 1, 0)
+        in_shade = (t >= sh_start[event]) & (t < sh_end[event])
+        t_clear = np.arange(t[0], t_end + clear_sky_step, clear_sky_step)
+        g_clear = get_clear_sky(t_clear, latitude, day_0)
+        g = np.interp(t, t_clear, g_clear) * k
+
+        yield {
+            "t": t,
+            "g": g,
+            "k": k,
+            "regime": regime,
+            "shade_fraction": np.where(in_shade, sh_frac[event], 0.0),
+            "g_shade": np.where(in_shade, g * sh_ratio[event], g),
+        }
+
+        # Drop what the next chunk no longer needs.
+        keep = max(np.searchsorted(bp_t, t_end, side="right") - 1, 0)
+        bp_t, bp_k = bp_t[keep:], bp_k[keep:]
+        keep = max(np.searchsorted(reg_t, t_end, side="right") - 1, 0)
+        reg_t, reg = reg_t[keep:], reg[keep:]
+        keep = min(np.searchsorted(sh_end, t_end), len(sh_end) - 1)
+        sh_start, sh_end = sh_start[keep:], sh_end[keep:]
+        sh_frac, sh_ratio = sh_frac[keep:], sh_ratio[keep:]
+
+
+def get_irradiance_statistics(chunks, dt, latitude=latitude, day_0=172):
+    """_summary_
+    Get summary statistics of a streamed series, accumulated chunk by chunk.
+
+    Args:
+        chunks (iterable): Chunks, see stream_irradiance
+        dt (float): Time step (s)
+        latitude (float, optional): Latitude of the stream (deg). Defaults to
+            latitude.
+        day_0 (int, optional): Day of the year at the start of the stream.
+            Defaults to 172.
+
+    Returns:
+        dict:
+            energy - irradiation (kWh/m^2)
+            k_mean - daylight mean clear sky index
+            regime_fraction - daylight fraction of each regime
+            ramp_hist, ramp_edges - histogram of the 1 s daylight ramps of G
+                (% of G_CLEAR per s)
+            k_max - highest clear sky index
+            shade_fraction - fraction of the time with partial shading
+            samples - number of samples
+    """
+    ramp_edges = np.array([0, 1, 2, 5, 10, 20, 50, 100, np.inf])
+    hist = np.zeros(len(ramp_edges) - 1)
+    stats = {"energy": 0.0, "k_sum": 0.0, "day": 0, "k_max": 0.0}
+    regime = np.zeros(3)
+    shaded = samples = 0
+    step = int(round(1 / dt))
+    for chunk in chunks:
+        day = chunk["g"] > 0
+        stats["energy"] += chunk["g"].sum() * dt / 3.6e6
+        stats["k_sum"] += chunk["k"][day].sum()
+        stats["day"] += day.sum()
+        stats["k_max"] = max(stats["k_max"], chunk["k"].max())
+        regime += np.bincount(chunk["regime"][day], minlength=3)
+        shaded += (chunk["shade_fraction"] > 0).sum()
+        samples += len(chunk["t"])
+
+        g_clear = get_clear_sky(chunk["t"][::step], latitude, day_0)
+        g_1s = chunk["g"][::step]
+        ramp = np.abs(np.diff(g_1s)) / np.maximum(g_clear[1:], 1) * 100
+        hist += np.histogram(ramp[g_clear[1:] > 50], ramp_edges)[0]
+    return {
+        "energy": stats["energy"],
+        "k_mean": stats["k_sum"] / max(stats["day"], 1),
+        "regime_fraction": regime / max(regime.sum(), 1),
+        "ramp_hist": hist / max(hist.sum(), 1),
+        "ramp_edges": ramp_edges,
+        "k_max": stats["k_max"],
+        "shade_fraction": shaded / samples,
+        "samples": samples,
+    }
+
+
+def get_irradiance_map(days, statistics):
+    """_summary_
+    Plot a day of every climate class and their ramp rate distributions.
+
+    Args:
+        days ({str: dict}): Concatenated chunks of one day per climate class
+        statistics ({str: dict}): Statistics per climate class, see
+            get_irradiance_statistics
+    """
+    fig, axs = plt.subplots(2, 1, figsize=(14, 10))
+    for name, day in days.items():
+        axs[0].plot(day["t"][::10] / 3600, day["g"][::10], linewidth=0.5, label=name)
+    axs[0].plot(
+        days[next(iter(days))]["t"][::100] / 3600,
+        get_clear_sky(days[next(iter(days))]["t"][::100]),
+        "k--",
+        label="Clear sky",
+    )
+    axs[0].set_xlim(5, 19)
+    axs[0].set_xlabel("Solar time (h)")
+    axs[0].set_ylabel("Irradiance (W/m^2)")
+    axs[0].set_title("One day per climate class")
+    axs[0].grid(True)
+    axs[0].legend()
+
+    width = 0.8 / len(statistics)
+    for idx, (name, stats) in enumerate(statistics.items()):
+        axs[1].bar(
+            np.arange(len(stats["ramp_hist"])) + idx * width,
+            stats["ramp_hist"] * 100,
+            width,
+            label=name,
+        )
+    edges = statistics[next(iter(statistics))]["ramp_edges"]
+    axs[1].set_xticks(
+        np.arange(len(edges) - 1) + 0.4,
+        [f"{lo:g}-{hi:g}" for lo, hi in zip(edges[:-1], edges[1:])],
+    )
+    axs[1].set_yscale("log")
+    axs[1].set_xlabel("1 s ramp (% of clear sky per s)")
+    axs[1].set_ylabel("Share of daylight seconds (%)")
+    axs[1].grid(True)
+    axs[1].legend()
+    plt.savefig("irradiance_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    dt = 0.01
+    days, statistics = {}, {}
+    for climate in climate_classes:
+        day = list(stream_irradiance(climate, seed=1, duration=86400.0, dt=dt))
+        days[climate] = {key: np.concatenate([c[key] for c in day]) for key in day[0]}
+
+        start = time.perf_counter()
+        stats = get_irradiance_statistics(
+            stream_irradiance(climate, seed=2, duration=30 * 86400.0, dt=dt), dt
+        )
+        elapsed = time.perf_counter() - start
+        statistics[climate] = stats
+        ramps = stats["ramp_hist"][stats["ramp_edges"][:-1] >= 10].sum() * 100
+        print(
+            f"{climate:<10} 30 days: {stats['energy']:6.1f} kWh/m^2, mean K "
+            f"{stats['k_mean']:.2f}, regimes "
+            + "/".join(f"{p * 100:.0f}" for p in stats["regime_fraction"])
+            + f" %, 1 s ramps >= 10 %/s {ramps:.2f} %, max K {stats['k_max']:.2f}, "
+            f"shaded {stats['shade_fraction'] * 100:.2f} % of the time"
+        )
+        print(
+            f"           {stats['samples'] / elapsed / 1e6:.1f} M samples/s, a year "
+            f"at {dt * 1e3:.0f} ms in {365 * 86400 / dt / stats['samples'] * elapsed:.0f} s"
+        )
+
+    get_irradiance_map(days, statistics)
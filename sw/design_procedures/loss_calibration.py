@@ -0,0 +1,435 @@
+"""_summary_
+@file       loss_calibration.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Calibrate the converter loss model against measured efficiency.
+
+            The loss model is the sum of the switch conduction and C_OSS
+            losses, the inductor winding (DC and ripple) and core losses, the
+            capacitor ESR losses and a fixed power path loss. Correction
+            factors on R_DS_ON, the C_OSS energy and the winding AC
+            resistance, the Steinmetz coefficients of the core and the fixed
+            loss are fit to the bench points with a robust (soft L1)
+            trust-region least squares on the efficiency error, so that a
+            few bad readings do not pull the fit. The result is written to
+            calibration.json, which every design procedure reads through
+            calibration.get_calibration.
+
+            K_CORE, ALPHA and BETA are not separable at the bench's
+            frequencies and flux densities, where F^ALPHA is ~1e7. The fit
+            takes the core loss at a reference point in the middle of the
+            data instead,
+                P_V = K_REF (F_EQ / F_REF)^(ALPHA - 1) (B / B_REF)^BETA F
+            and converts K_REF back to K_CORE afterwards. A calibration
+            with any parameter's 1 sigma above sigma_limit of its value is
+            not written.
+
+            Run with a CSV of bench points (see load_efficiency_csv) to
+            calibrate, or without arguments to fit a synthetic data set with
+            known parameters.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+import time
+import warnings
+
+import matplotlib.pyplot as plt
+import numpy as np
+from scipy.optimize import least_squares
+
+from design_procedures.calibration import (
+    default_calibration,
+    get_calibration,
+    save_calibration,
+)
+from design_procedures.component_stress import (
+    get_component_stress,
+    get_inductor_ripple,
+)
+from design_procedures.converter_model import default_boost_design
+from design_procedures.gate_driver_design import get_auxiliary_losses
+from design_procedures.passives_design import (
+    core_a_c,
+    core_vol,
+    get_core_loss_density,
+)
+from design_procedures.switch_design import get_switch_losses_batch
+
+# Parameters fit by fit_loss_calibration, with their bounds. The k_core
+# bounds are on the core loss at the reference point, over the datasheet's.
+fit_keys = ["k_r_ds_on", "k_e_oss", "k_ac", "k_core", "alpha", "beta", "p_fixed"]
+fit_lower = [0.2, 0.2, 0.5, 1e-2, 1.0, 2.0, 0.0]
+fit_upper = [5.0, 5.0, 20.0, 1e2, 2.0, 3.2, 10.0]
+sigma_limit = 0.5  # Largest 1 sigma, over the value, of an identified parameter
+
+analyzer_noise = 5e-4  # 1 sigma of the efficiency error of the power analyzer
+outlier_threshold = 5  # Residual, in f_scale, beyond which a point is flagged
+
+
+def get_loss_breakdown(design, v_in, i_in, v_out, f_sw, params=None, t_j=25, aux=False):
+    """_summary_
+    Get the loss of each part of the converter at a set of operating points.
+    All operating point arguments broadcast against each other.
+
+    Args:
+        design (dict): Converter design, see default_boost_design. n_l is
+            the number of inductor turns.
+        v_in (float|np.ndarray): Input voltage (V)
+        i_in (float|np.ndarray): Input current (A)
+        v_out (float|np.ndarray): Output voltage (V)
+        f_sw (float|np.ndarray): Switching frequency (Hz)
+        params (dict, optional): Loss model parameters, see
+            calibration.default_calibration. Defaults to get_calibration().
+        t_j (float|np.ndarray, optional): Junction temperature (C). Defaults
+            to 25.
+        aux (bool, optional): Add the gate driver ("gate") and auxiliary
+            rail ("aux") power drawn from the +12V bus, which the power
+            analyzer does not see. design then needs q_g. Defaults to False.
+
+    Returns:
+        dict: Loss (W) of "sw_con", "sw_swi", "l_dc", "l_ac", "core", "ci",
+            "co", "fixed", with aux "gate" and "aux", and their sum "total".
+    """
+    params = get_calibration() if params is None else params
+    v_in, i_in, v_out, f_sw = np.broadcast_arrays(
+        *[np.asarray(x, dtype=float) for x in (v_in, i_in, v_out, f_sw)]
+    )
+    i_l_pp = get_inductor_ripple(v_in, v_out, f_sw, design["l"])
+    r_l = i_l_pp / (2 * np.maximum(i_in, 1e-6))
+    sw_con, sw_swi, _, _ = get_switch_losses_batch(
+        v_in,
+        i_in,
+        v_out,
+        f_sw,
+        design["r_ds_on"],
+        design["c_oss"],
+        r_l,
+        t_j=t_j,
+        calibration=params,
+    )
+    stress = get_component_stress(v_in, i_in, v_out, f_sw, i_l_pp)
+    b_ac = design["l"] * i_l_pp / (2 * design["n_l"] * core_a_c)
+    p_v = get_core_loss_density(f_sw, b_ac, stress["duty"], params)
+
+    loss = {
+        "sw_con": sw_con,
+        "sw_swi": sw_swi,
+        "l_dc": i_in**2 * design["r_dcr"],
+        "l_ac": params["k_ac"] * design["r_dcr"] * i_l_pp**2 / 12,
+        "core": p_v * core_vol * 1e3,
+        "ci": stress["ci"]["i_rms"] ** 2 * design["r_ci"],
+        "co": stress["co"]["i_rms"] ** 2 * design["r_co"],
+        "fixed": np.full_like(v_in, params["p_fixed"]),
+    }
+    if aux:
+        loss["gate"], loss["aux"] = get_auxiliary_losses(design, f_sw)
+    loss["total"] = sum(loss.values())
+    return loss
+
+
+def load_efficiency_csv(path):
+    """_summary_
+    Load bench points exported from the power analyzer.
+
+    Args:
+        path (str): CSV with a header row and the columns v_in (V), i_in (A),
+            v_out (V), f_sw (Hz), p_in (W) and p_out (W), in any order.
+
+    Returns:
+        dict: Column name to np.ndarray.
+    """
+    data = np.genfromtxt(path, delimiter=",", names=True)
+    return {
+        key: np.asarray(data[key], dtype=float)
+        for key in ("v_in", "i_in", "v_out", "f_sw", "p_in", "p_out")
+    }
+
+
+def get_efficiency_residual(points, design, params):
+    """_summary_
+    Get the model minus measured efficiency of each bench point.
+
+    Args:
+        points (dict): Bench points, see load_efficiency_csv
+        design (dict): Converter design, see default_boost_design
+        params (dict): Loss model parameters
+
+    Returns:
+        np.ndarray: Efficiency error, positive where the model is optimistic.
+    """
+    loss = get_loss_breakdown(
+        design, points["v_in"], points["i_in"], points["v_out"], points["f_sw"], params
+    )["total"]
+    return (points["p_in"] - loss - points["p_out"]) / points["p_in"]
+
+
+def get_core_reference(points, design=default_boost_design):
+    """_summary_
+    Get the geometric mean equivalent frequency and peak flux density of the
+    bench points, about which the core loss is fit.
+
+    Args:
+        points (dict): Bench points, see load_efficiency_csv
+        design (dict, optional): Converter design under test. Defaults to
+            default_boost_design.
+
+    Returns:
+        (float, float): F_REF (Hz) and B_REF (T).
+    """
+    i_l_pp = get_inductor_ripple(
+        points["v_in"], points["v_out"], points["f_sw"], design["l"]
+    )
+    duty = np.clip(1 - points["v_in"] / points["v_out"], 0.01, 0.99)
+    f_eq = 2 * points["f_sw"] / (np.pi**2 * duty * (1 - duty))
+    b_ac = design["l"] * i_l_pp / (2 * design["n_l"] * core_a_c)
+    return np.exp(np.mean(np.log(f_eq))), np.exp(np.mean(np.log(b_ac)))
+
+
+def get_core_reference_loss(params, f_ref, b_ref):
+    """_summary_
+    Get the core loss per cycle at the reference point, the part of the
+    Steinmetz fit the bench points determine.
+
+    Args:
+        params (dict): Loss model parameters
+        f_ref (float): Reference equivalent frequency (Hz)
+        b_ref (float): Reference peak flux density (T)
+
+    Returns:
+        float: Core loss per cycle (J/m^3).
+    """
+    return params["k_core"] * f_ref ** (params["alpha"] - 1) * b_ref ** params["beta"]
+
+
+def fit_loss_calibration(points, design=default_boost_design, x0=None, f_scale=1e-3):
+    """_summary_
+    Fit the loss model parameters to measured efficiency.
+
+    Args:
+        points (dict): Bench points, see load_efficiency_csv
+        design (dict, optional): Converter design under test. Defaults to
+            default_boost_design.
+        x0 (dict, optional): Initial parameters. Defaults to
+            default_calibration.
+        f_scale (float, optional): Efficiency error at which the soft L1
+            loss turns from quadratic to linear. Defaults to 1e-3.
+
+    Returns:
+        (dict, dict, dict): Fit parameters, their standard errors, and a
+            summary of "rms" efficiency error of the inliers, number of
+            "outliers", solver "nfev", "residual" per point, the core loss
+            reference "f_ref" and "b_ref", and whether every parameter is
+            "identified" to within sigma_limit. The k_core error is that of
+            the core loss at the reference point.
+    """
+    x0 = default_calibration if x0 is None else x0
+    params = dict(default_calibration)
+    f_ref, b_ref = get_core_reference(points, design)
+    core = fit_keys.index("k_core")
+
+    e_ref = get_core_reference_loss(default_calibration, f_ref, b_ref)
+
+    def update(x):
+        params.update(zip(fit_keys, x))
+        params["k_core"] = (
+            x[core]
+            * e_ref
+            / get_core_reference_loss(dict(params, k_core=1.0), f_ref, b_ref)
+        )
+
+    def residual(x):
+        update(x)
+        return get_efficiency_residual(points, design, params)
+
+    start = [x0[key] for key in fit_keys]
+    start[core] = get_core_reference_loss(x0, f_ref, b_ref) / e_ref
+    start = np.clip(start, fit_lower, fit_upper)
+    result = least_squares(
+        residual,
+        start,
+        bounds=(fit_lower, fit_upper),
+        loss="soft_l1",
+        f_scale=f_scale,
+        x_scale="jac",
+        method="trf",
+    )
+    update(result.x)
+
+    # Standard errors from the Jacobian at the solution, over the inliers.
+    inlier = np.abs(result.fun) < outlier_threshold * f_scale
+    jac = result.jac[inlier]
+    dof = max(inlier.sum() - len(fit_keys), 1)
+    sigma_2 = np.sum(result.fun[inlier] ** 2) / dof
+    cov = np.linalg.pinv(jac.T @ jac) * sigma_2
+    errors = dict(zip(fit_keys, np.sqrt(np.diag(cov))))
+    errors["k_core"] *= params["k_core"] / result.x[core]
+
+    identified = all(
+        errors[key] <= sigma_limit * np.abs(params[key]) for key in fit_keys
+    )
+    if not identified:
+        warnings.warn(
+            "Loss calibration is not identified, 1 sigma above "
+            f"{sigma_limit * 100 :.0f} % of "
+            + ", ".join(
+                key
+                for key in fit_keys
+                if errors[key] > sigma_limit * np.abs(params[key])
+            )
+        )
+
+    summary = {
+        "rms": np.sqrt(np.mean(result.fun[inlier] ** 2)),
+        "outliers": int((~inlier).sum()),
+        "nfev": result.nfev,
+        "residual": result.fun,
+        "f_ref": f_ref,
+        "b_ref": b_ref,
+        "identified": identified,
+    }
+    return params, errors, summary
+
+
+def get_synthetic_points(params, design=default_boost_design, num=3000, seed=0):
+    """_summary_
+    Generate bench points from a known set of parameters, with power analyzer
+    noise and a share of bad readings.
+
+    Args:
+        params (dict): Loss model parameters of the simulated converter
+        design (dict, optional): Converter design. Defaults to
+            default_boost_design.
+        num (int, optional): Number of points. Defaults to 3000.
+        seed (int, optional): Random seed. Defaults to 0.
+
+    Returns:
+        dict: Bench points, see load_efficiency_csv.
+    """
+    rng = np.random.default_rng(seed)
+    v_out = rng.choice([85.0, 105.0, 125.0], num)
+    v_in = rng.uniform(25, 75, num)
+    i_in = rng.uniform(0.5, 6.0, num)
+    f_sw = rng.choice([50e3, 75e3, 100e3, 150e3, 200e3], num)
+    loss = get_loss_breakdown(design, v_in, i_in, v_out, f_sw, params)["total"]
+    p_in = v_in * i_in
+    eff = 1 - loss / p_in + rng.normal(0, analyzer_noise, num)
+    bad = rng.random(num) < 0.02
+    eff[bad] += rng.normal(0, 0.02, bad.sum())
+    return {
+        "v_in": v_in,
+        "i_in": i_in,
+        "v_out": v_out,
+        "f_sw": f_sw,
+        "p_in": p_in,
+        "p_out": eff * p_in,
+    }
+
+
+def get_loss_calibration_map(points, design, params):
+    """_summary_
+    Plot the efficiency error of the bench points before and after the
+    calibration, and the calibrated loss breakdown across input power.
+
+    Args:
+        points (dict): Bench points, see load_efficiency_csv
+        design (dict): Converter design
+        params (dict): Calibrated loss model parameters
+    """
+    fig, axs = plt.subplots(1, 3, figsize=(18, 5.5))
+    for ax, p, name in (
+        (axs[0], default_calibration, "Datasheet"),
+        (axs[1], params, "Calibrated"),
+    ):
+        res = get_efficiency_residual(points, design, p) * 100
+        sc = ax.scatter(
+            points["p_in"], res, c=points["f_sw"] / 1e3, s=4, cmap="viridis"
+        )
+        ax.set_ylim(-3, 3)
+        ax.set_title(f"{name} model, median |error| {np.median(np.abs(res)) :.3f} %")
+        ax.set_xlabel("Input power (W)")
+        ax.set_ylabel("Model - measured efficiency (%)")
+        ax.grid()
+    fig.colorbar(sc, ax=axs[1], label="F_SW (kHz)")
+
+    i_in = np.linspace(0.25, 6.0, 100)
+    loss = get_loss_breakdown(design, 50.0, i_in, 105.0, 100e3, params)
+    names = [key for key in loss if key != "total"]
+    axs[2].stackplot(50.0 * i_in, [loss[key] for key in names], labels=names)
+    axs[2].set_title("Calibrated losses, 50 V to 105 V at 100 kHz")
+    axs[2].set_xlabel("Input power (W)")
+    axs[2].set_ylabel("Loss (W)")
+    axs[2].legend(loc="upper left")
+    axs[2].grid()
+
+    fig.tight_layout()
+    plt.savefig("loss_calibration_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    design = default_boost_design
+
+    if len(sys.argv) > 1:
+        points = load_efficiency_csv(sys.argv[1])
+        truth = None
+    else:
+        truth = dict(
+            default_calibration,
+            k_r_ds_on=1.35,
+            k_e_oss=1.6,
+            k_ac=3.0,
+            k_core=3.2,
+            alpha=1.5,
+            beta=2.7,
+            p_fixed=0.85,
+        )
+        points = get_synthetic_points(truth, design)
+
+    start = time.perf_counter()
+    params, errors, summary = fit_loss_calibration(points, design)
+    elapsed = time.perf_counter() - start
+
+    print(
+        f"Fit {len(points['p_in'])} points in {elapsed :.2f} s "
+        f"({summary['nfev']} evaluations), RMS efficiency error "
+        f"{summary['rms'] * 100 :.3f} %, {summary['outliers']} outliers"
+    )
+    print(f"{'':>10}{'default':>10}{'fit':>10}{'1 sigma':>10}{'true':>10}")
+    for key in fit_keys:
+        true = f"{truth[key] :10.3f}" if truth else f"{'':>10}"
+        print(
+            f"{key:>10}{default_calibration[key] :10.3f}{params[key] :10.3f}"
+            f"{errors[key] :10.3f}{true}"
+        )
+
+    # K_CORE alone is not determined, the core loss at the reference is.
+    f_ref, b_ref = summary["f_ref"], summary["b_ref"]
+    e_core = [
+        get_core_reference_loss(p, f_ref, b_ref) * 1e3
+        for p in (default_calibration, params, truth or params)
+    ]
+    true = f"{e_core[2] :10.3f}" if truth else f"{'':>10}"
+    print(
+        f"{'e_ref':>10}{e_core[0] :10.3f}{e_core[1] :10.3f}"
+        f"{errors['k_core'] / params['k_core'] * e_core[1] :10.3f}{true}"
+        f"  mJ/m^3 per cycle at F_EQ {f_ref / 1e3 :.1f} kHz, "
+        f"B {b_ref * 1e3 :.1f} mT"
+    )
+    if truth is None:
+        if summary["identified"]:
+            print(f"Saved {save_calibration(params)}")
+        else:
+            print("Calibration not saved, the bench points do not identify it")
+
+    get_loss_calibration_map(points, design, params)
@@ -0,0 +1,448 @@
+"""_summary_
+@file       mppt_tuning.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Tuning of the perturb and observe maximum power point tracker
+            against the array by batch simulation.
+
+            The tracker runs once every perturbation period T_P:
+            - the firmware averages V_IN and P_IN over the last
+              avg_fraction of the period,
+            - if the power fell since the last period the direction reverses,
+              and at either end of the V_IN reference range it turns back,
+              so that above the V_OC of a hot array, where the power is flat
+              at zero, it walks down until there is power to track,
+            - the V_IN reference moves by
+                  STEP = STEP_0 + K_A min(|dP / dV| / I_NORM, 1),
+              so that it moves faster far from the maximum power point, where
+              the slope of the P-V curve is steep, and settles to STEP_0 near
+              it.
+            The input voltage loop (control_design, gain_schedule) is much
+            faster than any useful T_P and is modelled as a first order lag at
+            the crossover the control design has to meet, and T_P may not be
+            shorter than its settling time. The array is the uniform series
+            string of nonideal_model at a fixed cell temperature or along a
+            cell temperature trace (cell_temperature), and the tracker starts
+            at its open circuit voltage, where the soft start
+            (startup_analysis) leaves it.
+
+            Every combination of STEP_0, T_P and K_A is simulated against
+            every irradiance test profile at once, one column per
+            (parameters, profile), and ranked by the mean tracking efficiency
+            over the profiles, the energy drawn over the energy available at
+            the maximum power point. The profiles follow the static and ramp
+            tests of EN 50530 plus cloud edge steps and the flicker of
+            roadside shadows.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import itertools
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.control_design import get_required_bandwidth, v_step
+from design_procedures.firmware_export import write_c_header
+from design_procedures.nonideal_model import model_nonideal_cell_vec
+from design_procedures.startup_analysis import get_array_open_circuit
+from design_procedures.transient_analysis import r_sh
+
+i_mpp = 5.84  # A, cell maximum power point current
+avg_fraction = 0.25  # Fraction of the period averaged for the measurement
+p_noise = 0.002  # 1 sigma of the averaged power measurement, relative
+v_ref_min = 0.25  # Lowest V_IN reference, fraction of the array V_OC
+
+# Search space.
+step_range = v_step * np.array([1, 2, 3, 4, 6, 8, 12, 16])  # V
+period_range = np.array([5e-3, 10e-3, 20e-3, 50e-3, 100e-3, 200e-3])  # s
+gain_range = np.array([0.0, 2.0, 4.0, 8.0, 16.0])  # V
+
+
+def get_array_mpp(num_cells, g, t=298.15, num_iter=40):
+    """_summary_
+    Get the array maximum power point by golden section search on the cell
+    voltage.
+
+    Args:
+        num_cells (int): Number of solar cells in series
+        g (np.ndarray): Irradiance (W/m^2)
+        t (float|np.ndarray, optional): Cell temperature (K). Defaults to
+            298.15.
+        num_iter (int, optional): Iterations. Defaults to 40.
+
+    Returns:
+        (np.ndarray, np.ndarray): V_MPP and P_MPP of the array.
+    """
+    ratio = (5**0.5 - 1) / 2
+    lo = np.zeros(np.broadcast(np.asarray(g), np.asarray(t)).shape)
+    hi = get_array_open_circuit(1, g, t)
+    power = lambda v: v * model_nonideal_cell_vec(g, t, 0, r_sh, v)[0]
+    for _ in range(num_iter):
+        v_1 = hi - ratio * (hi - lo)
+        v_2 = lo + ratio * (hi - lo)
+        left = power(v_1) > power(v_2)
+        hi = np.where(left, v_2, hi)
+        lo = np.where(left, lo, v_1)
+    v = (lo + hi) / 2
+    return (v * num_cells, power(v) * num_cells)
+
+
+def get_loop_settling_time():
+    """_summary_
+    Get the 90 % settling time of the input voltage loop, treated as first
+    order at the crossover the control design has to meet.
+
+    Returns:
+        float: Settling time (s).
+    """
+    return 2.3 / get_required_bandwidth()
+
+
+def get_test_profiles(dt, t_end=60.0):
+    """_summary_
+    Get the irradiance test profiles.
+
+    Args:
+        dt (float): Time step
+        t_end (float, optional): Length of every profile. Defaults to 60.
+
+    Returns:
+        ([str], np.ndarray): Names and irradiance (W/m^2), (R, K).
+    """
+    t = np.arange(round(t_end / dt)) * dt
+
+    def ramp(g_lo, g_hi, slope, hold=5.0):
+        # Trapezoid g_hi -> g_lo -> g_hi at SLOPE W/m^2/s, repeated.
+        t_ramp = (g_hi - g_lo) / slope
+        cycle = 2 * (t_ramp + hold)
+        phase = t % cycle
+        down = np.clip((phase - hold) / t_ramp, 0, 1)
+        up = np.clip((phase - 2 * hold - t_ramp) / t_ramp, 0, 1)
+        return g_hi - (g_hi - g_lo) * (down - up)
+
+    profiles = {
+        "Static 1000 W/m^2": np.full_like(t, 1000.0),
+        "Static 200 W/m^2": np.full_like(t, 200.0),
+        "Ramp 100-500 at 5 W/m^2/s": ramp(100, 500, 5),
+        "Ramp 300-1000 at 20 W/m^2/s": ramp(300, 1000, 20),
+        "Ramp 300-1000 at 100 W/m^2/s": ramp(300, 1000, 100, 2.0),
+        "Cloud edge 1000-300 steps": np.where((t // 10) % 2 == 0, 1000.0, 300.0),
+        "Shadow flicker 1 Hz": np.where((t % 1.0) < 0.3, 400.0, 1000.0),
+        "Shadow flicker 5 Hz": np.where((t % 0.2) < 0.05, 300.0, 1000.0),
+    }
+    return (list(profiles), np.array(list(profiles.values())))
+
+
+def simulate_mppt_batch(
+    g, profile, step, period, gain, num_cells, t=298.15, dt=2e-3, seed=0, record=False
+):
+    """_summary_
+    Simulate a batch of perturb and observe trackers, one per column.
+
+    Args:
+        g (np.ndarray): Irradiance profiles (W/m^2), (R, K)
+        profile (np.ndarray): Profile of every column, (B)
+        step (np.ndarray): Base step STEP_0 (V), (B)
+        period (np.ndarray): Perturbation period T_P (s), (B)
+        gain (np.ndarray): Adaptive step gain K_A (V), (B)
+        num_cells (int): Number of solar cells in series
+        t (float|np.ndarray, optional): Cell temperature (K), or its trace
+            per profile, (R, K). Defaults to 298.15.
+        dt (float, optional): Time step. Defaults to 2e-3.
+        seed (int, optional): Measurement noise seed. Defaults to 0.
+        record (bool, optional): Whether to return the V_IN waveforms.
+            Defaults to False.
+
+    Returns:
+        dict: Per column:
+            efficiency - tracking efficiency
+            e_in, e_mpp - energy drawn and available (J)
+            v_in_pp - V_IN peak to peak over the last 10 periods
+            and "v_in", "v_mpp" (B, K) when recording.
+    """
+    rng = np.random.default_rng(seed)
+    batch, num_steps = len(profile), g.shape[1]
+    n_period = np.maximum(np.round(period / dt).astype(int), 1)
+    n_avg = np.maximum(np.round(n_period * avg_fraction).astype(int), 1)
+    alpha = 1 - np.exp(-get_required_bandwidth() * dt)
+    t = np.broadcast_to(np.asarray(t, dtype=float), g.shape)
+    v_mpp, p_mpp = get_array_mpp(num_cells, g, t)
+    v_oc = get_array_open_circuit(num_cells, 1000, t.min())
+
+    # After the soft start the tracker takes over at the array open circuit.
+    v_ref = get_array_open_circuit(num_cells, g[profile, 0], t[profile, 0])
+    v_in = v_ref.copy()
+    direction = np.ones(batch)
+    p_prev = np.zeros(batch)
+    v_prev = v_ref - step
+    acc_p = np.zeros(batch)
+    acc_v = np.zeros(batch)
+    e_in = np.zeros(batch)
+    trace = np.zeros((num_steps, batch)) if record else None
+    v_hi = np.full(batch, -np.inf)
+    v_lo = np.full(batch, np.inf)
+    tail_start = num_steps - 10 * n_period
+
+    for k in range(num_steps):
+        v_in = v_in + alpha * (v_ref - v_in)
+        i_in, _ = model_nonideal_cell_vec(
+            g[profile, k], t[profile, k], 0, r_sh, v_in / num_cells
+        )
+        p_in = v_in * np.maximum(i_in, 0)
+        e_in += p_in * dt
+        if record:
+            trace[k] = v_in
+        in_tail = k >= tail_start
+        v_hi = np.where(in_tail, np.maximum(v_hi, v_in), v_hi)
+        v_lo = np.where(in_tail, np.minimum(v_lo, v_in), v_lo)
+
+        phase = k % n_period
+        averaging = phase >= n_period - n_avg
+        acc_p += np.where(averaging, p_in, 0)
+        acc_v += np.where(averaging, v_in, 0)
+        update = phase == n_period - 1
+        if not update.any():
+            continue
+
+        p_meas = acc_p / n_avg * (1 + p_noise * rng.standard_normal(batch))
+        v_meas = acc_v / n_avg
+        d_p = p_meas - p_prev
+        d_v = v_meas - v_prev
+        slope = np.abs(d_p) / np.maximum(np.abs(d_v), 1e-3)
+        new_dir = np.where(d_p < 0, -direction, direction)
+        new_dir = np.where(v_ref >= v_oc, -1.0, new_dir)
+        new_dir = np.where(v_ref <= v_ref_min * v_oc, 1.0, new_dir)
+        new_step = step + gain * np.minimum(slope / i_mpp, 1)
+        new_ref = np.clip(v_ref + new_dir * new_step, v_ref_min * v_oc, v_oc)
+
+        direction = np.where(update, new_dir, direction)
+        v_ref = np.where(update, new_ref, v_ref)
+        p_prev = np.where(update, p_meas, p_prev)
+        v_prev = np.where(update, v_meas, v_prev)
+        acc_p = np.where(update, 0, acc_p)
+        acc_v = np.where(update, 0, acc_v)
+
+    e_mpp = p_mpp.sum(axis=1)[profile] * dt
+    results = {
+        "efficiency": e_in / e_mpp,
+        "e_in": e_in,
+        "e_mpp": e_mpp,
+        "v_in_pp": v_hi - v_lo,
+    }
+    if record:
+        results["v_in"] = trace.T
+        results["v_mpp"] = v_mpp[profile]
+    return results
+
+
+def tune_mppt(
+    num_cells,
+    step_range=step_range,
+    period_range=period_range,
+    gain_range=gain_range,
+    dt=2e-3,
+    t_end=60.0,
+    t=298.15,
+):
+    """_summary_
+    Simulate every parameter combination against every test profile and rank
+    them by the mean tracking efficiency.
+
+    Args:
+        num_cells (int): Number of solar cells in series
+        step_range ([float], optional): Base steps (V). Defaults to
+            step_range.
+        period_range ([float], optional): Perturbation periods (s). Defaults
+            to period_range.
+        gain_range ([float], optional): Adaptive step gains (V). Defaults to
+            gain_range.
+        dt (float, optional): Time step. Defaults to 2e-3.
+        t_end (float, optional): Length of every profile. Defaults to 60.
+        t (float|np.ndarray, optional): Cell temperature (K), or its trace
+            per test profile, (R, K). Defaults to 298.15.
+
+    Returns:
+        (dict, dict): Best parameters (step, period, gain, efficiency) among
+            periods of at least the loop settling time, and the results, efficiency and v_in_pp with shape (STEP, PERIOD, GAIN, R),
+            and "profiles".
+    """
+    names, profiles = get_test_profiles(dt, t_end)
+    combos = np.array(list(itertools.product(step_range, period_range, gain_range)))
+    num_combos, num_profiles = len(combos), len(profiles)
+
+    step = np.repeat(combos[:, 0], num_profiles)
+    period = np.repeat(combos[:, 1], num_profiles)
+    gain = np.repeat(combos[:, 2], num_profiles)
+    profile = np.tile(np.arange(num_profiles), num_combos)
+    sim = simulate_mppt_batch(
+        profiles, profile, step, period, gain, num_cells, t=t, dt=dt
+    )
+
+    shape = (len(step_range), len(period_range), len(gain_range), num_profiles)
+    results = {key: sim[key].reshape(shape) for key in ("efficiency", "v_in_pp")}
+    results["profiles"] = names
+    mean = results["efficiency"].mean(axis=-1)
+    # The first order loop model hides the ringing a period shorter than the
+    # loop settling time would measure, so those are not eligible.
+    eligible = np.asarray(period_range) >= get_loop_settling_time()
+    ranked = np.where(eligible[None, :, None], mean, -np.inf)
+    idx = np.unravel_index(ranked.argmax(), mean.shape)
+    params = {
+        "step": step_range[idx[0]],
+        "period": period_range[idx[1]],
+        "gain": gain_range[idx[2]],
+        "efficiency": mean[idx],
+        "index": idx,
+    }
+    return (params, results)
+
+
+def get_mppt_tuning_map(params, results, trace, dt):
+    """_summary_
+    Plot the tracking efficiency over the search space and a trace of the
+    tuned tracker.
+
+    Args:
+        params (dict): Best parameters, see tune_mppt
+        results (dict): Search results, see tune_mppt
+        trace (dict): Recorded simulation of the best parameters on one
+            profile, see simulate_mppt_batch
+        dt (float): Time step
+    """
+    i_s, i_p, i_g = params["index"]
+    mean = results["efficiency"].mean(axis=-1) * 100
+
+    fig, axs = plt.subplots(2, 2, figsize=(16, 12))
+    ax = axs[0, 0]
+    im = ax.pcolormesh(
+        period_range * 1e3,
+        step_range,
+        mean[:, :, i_g],
+        shading="nearest",
+        vmin=max(mean.min(), 90),
+        vmax=100,
+    )
+    ax.plot(params["period"] * 1e3, params["step"], "r*", markersize=15)
+    ax.set_xscale("log")
+    ax.set_xlabel("Perturbation period (ms)")
+    ax.set_ylabel("Base step (V)")
+    ax.set_title(f"Mean tracking efficiency (%), K_A = {params['gain']} V")
+    fig.colorbar(im, ax=ax)
+
+    ax = axs[0, 1]
+    for idx, gain in enumerate(gain_range):
+        ax.plot(period_range * 1e3, mean[i_s, :, idx], "o-", label=f"K_A={gain} V")
+    ax.set_xscale("log")
+    ax.set_xlabel("Perturbation period (ms)")
+    ax.set_ylabel("Mean tracking efficiency (%)")
+    ax.set_title(f"Base step {params['step']:.2f} V")
+    ax.grid(True, which="both")
+    ax.legend()
+
+    ax = axs[1, 0]
+    best = results["efficiency"][i_s, i_p, i_g] * 100
+    ax.barh(results["profiles"], best)
+    ax.set_xlim(min(best.min() - 1, 99), 100)
+    ax.set_xlabel("Tracking efficiency (%)")
+    ax.set_title("Tuned tracker per profile")
+    ax.grid(True)
+
+    ax = axs[1, 1]
+    t = np.arange(trace["v_in"].shape[1]) * dt
+    ax.plot(t, trace["v_mpp"][0], label="V_MPP")
+    ax.plot(t, trace["v_in"][0], label="V_IN")
+    ax.set_xlabel("Time (s)")
+    ax.set_ylabel("Array voltage (V)")
+    ax.set_title(results["profiles"][3])
+    ax.grid(True)
+    ax.legend()
+
+    plt.savefig("mppt_tuning_map.png")
+    plt.show()
+
+
+def export_mppt_tuning(params, num_cells, path=None):
+    """_summary_
+    Write the tracker parameters to fw/include/mppt_tuning.h.
+
+    Args:
+        params (dict): Best parameters, see tune_mppt
+        num_cells (int): Number of solar cells in series
+        path (str, optional): Output directory. Defaults to fw/include.
+
+    Returns:
+        str: Path of the written header.
+    """
+    v_oc = float(get_array_open_circuit(num_cells))
+    constants = [
+        ("MPPT_STEP", params["step"], "V, base V_IN reference step"),
+        ("MPPT_PERIOD", params["period"], "s, perturbation period"),
+        ("MPPT_AVG_FRACTION", avg_fraction, "Fraction of the period averaged"),
+        ("MPPT_ADAPT_GAIN", params["gain"], "V, adaptive step at full slope"),
+        ("MPPT_I_NORM", i_mpp, "A, dP/dV of a full slope"),
+        ("MPPT_V_REF_MIN", v_ref_min * v_oc, "V, lowest V_IN reference"),
+        ("MPPT_V_REF_MAX", v_oc, "V, highest V_IN reference"),
+    ]
+    return write_c_header(
+        "mppt_tuning.h",
+        "Perturb and observe tracker parameters, see "
+        "sw/design_procedures/mppt_tuning.py.",
+        constants,
+        path=path,
+    )
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    num_cells = 111
+    dt = 2e-3
+
+    start = time.perf_counter()
+    params, results = tune_mppt(num_cells, dt=dt)
+    elapsed = time.perf_counter() - start
+    print(
+        f"{results['efficiency'].size} tracker simulations of "
+        f"{get_test_profiles(dt)[1].shape[1] * dt:.0f} s in {elapsed:.1f} s"
+    )
+    print(
+        f"Best: step {params['step']:.3f} V, period {params['period'] * 1e3:.0f} ms, "
+        f"K_A {params['gain']} V, mean efficiency {params['efficiency'] * 100:.2f} %"
+    )
+    i_s, i_p, i_g = params["index"]
+    for name, eff, v_pp in zip(
+        results["profiles"],
+        results["efficiency"][i_s, i_p, i_g],
+        results["v_in_pp"][i_s, i_p, i_g],
+    ):
+        print(f"  {name:<30} {eff * 100:6.2f} %, V_IN ripple {v_pp:5.2f} V")
+    mean = results["efficiency"].mean(axis=-1)
+    print(
+        f"Search space spans {mean.min() * 100:.2f}-{mean.max() * 100:.2f} % mean "
+        f"efficiency; fixed step (K_A = 0) best {mean[..., 0].max() * 100:.2f} %, "
+        f"loop settling time {get_loop_settling_time() * 1e3:.1f} ms"
+    )
+
+    names, profiles = get_test_profiles(dt)
+    trace = simulate_mppt_batch(
+        profiles[3:4],
+        np.array([0]),
+        np.array([params["step"]]),
+        np.array([params["period"]]),
+        np.array([params["gain"]]),
+        num_cells,
+        dt=dt,
+        record=True,
+    )
+    get_mppt_tuning_map(params, results, trace, dt)
+    print(f"Wrote {export_mppt_tuning(params, num_cells)}")
@@ -13,7 +13,9 @@ i_sc_ref = 6.15
 v_oc_ref = 0.721
 G_ref = 1000
 T_ref = 298.15
-t_coeff_i_sc = 0.005
+# 1/K, the 2.9 mA/K of docs/images/maxeon_gen_iii_cell_characteristics.png
+# over I_SC_REF.
+t_coeff_i_sc = 0.00047
 t_coeff_v_oc = -0.0022
 n = 1.0
 i_resolution = 0.0025
@@ -205,3 +207,79 @@ def model_nonideal_cell_many(v, g, t, r_s, r_sh, i=None):
             break
 
     return prediction
+
+
+def get_cell_dynamic_resistance(g, t, r_s, r_sh, v):
+    """_summary_
+    Gets the small signal (dynamic) resistance -dV/dI of a nonideal cell at a
+    load voltage, from the derivative of the single diode equation.
+
+    Args:
+        g (double): Incident irradiance (W/m^2).
+        t (double): Cell temperature (K).
+        r_s (double): Series resistance (Ohms).
+        r_sh (double): Shunt resistance (Ohms).
+        v (double|[double]): Load voltage (V).
+
+    Returns:
+        double|[double]: Dynamic resistance (Ohms).
+    """
+    v_t = k_b * t / q
+    i_sc = i_sc_ref * (g / G_ref) * (1 - t_coeff_i_sc * (T_ref - t))
+    v_oc = v_oc_ref * (1 - t_coeff_v_oc * (T_ref - t)) + n * v_t * m.log(g / G_ref)
+    i_0 = i_sc / (m.exp(v_oc / v_t) - 1)
+
+    # -dV/dI of I = I_L - I_0 (exp((V + I R_S) / V_T) - 1) - (V + I R_S) / R_SH
+    # is 1 / g_d + R_S. The diode conductance is evaluated at V rather than
+    # V + I R_S, which is exact for the R_S = 0 used across the design.
+    g_d = i_0 / v_t * np.exp(np.asarray(v) / v_t) + 1 / r_sh
+    return 1 / g_d + r_s
+
+
+def model_nonideal_cell_vec(g, t, r_s, r_sh, v, num_iter=6):
+    """_summary_
+    Gets the current and conductance of a nonideal cell for many load voltages
+    (and optionally irradiances and temperatures) at once, using Newton's
+    method on the single diode equation.
+
+    Args:
+        g (double|[double]): Incident irradiance (W/m^2).
+        t (double|[double]): Cell temperature (K).
+        r_s (double): Series resistance (Ohms).
+        r_sh (double): Shunt resistance (Ohms).
+        v (double|[double]): Load voltage (V).
+        num_iter (int): Newton iterations, unused when r_s is 0 since the
+            equation is then explicit.
+
+    Returns:
+        ([double], [double]): Current (A) and small signal conductance -dI/dV
+            (S).
+    """
+    g, t, v = np.broadcast_arrays(
+        np.asarray(g, dtype=float),
+        np.asarray(t, dtype=float),
+        np.asarray(v, dtype=float),
+    )
+    v_t = k_b * t / q
+    i_sc = i_sc_ref * (g / G_ref) * (1 - t_coeff_i_sc * (T_ref - t))
+    v_oc = v_oc_ref * (1 - t_coeff_v_oc * (T_ref - t)) + n * v_t * np.log(
+        np.maximum(g, 1e-9) / G_ref
+    )
+    i_0 = i_sc / (np.exp(v_oc / v_t) - 1)
+    term_1 = i_sc * (r_sh + r_s) / r_sh
+
+    # Seed with the R_S = 0 solution, exact when there is no series resistance.
+    e = np.exp(np.minimum(v / v_t, 200))
+    i = term_1 - i_0 * (e - 1) - v / r_sh
+    g_d = i_0 / v_t * e + 1 / r_sh
+    if r_s == 0:
+        return (i, g_d)
+
+    for _ in range(num_iter):
+        e = np.exp(np.minimum((v + i * r_s) / v_t, 200))
+        f = term_1 - i_0 * (e - 1) - (v + i * r_s) / r_sh - i
+        g_d = i_0 / v_t * e + 1 / r_sh
+        i = i + f / (1 + r_s * g_d)
+
+    # dI/dV = -g_d / (1 + R_S g_d).
+    return (i, g_d / (1 + r_s * g_d))
@@ -14,6 +14,16 @@ import sys
 
 import matplotlib.pyplot as plt
 import numpy as np
+from scipy.optimize import least_squares, nnls
+
+from design_procedures.calibration import get_calibration
+from design_procedures.component_stress import (get_component_stress,
+                                                get_inductor_ripple,
+                                                get_triangle_stress)
+
+# PQ 26/25, B65877A
+core_a_c = 0.0001088  # cross sectional area of core, m^2
+core_vol = 6.54e-6  # m^3
 
 
 def get_passive_sizing(
@@ -42,6 +52,8 @@ def get_passive_sizing(
             Minimum VDC for input capacitor
             Minimum VDC for output capacitor
             Minimum I_D for inductor
+            Minimum I_RMS for input capacitor
+            Minimum I_RMS for output capacitor
     """
 
     # Given that the PV is a nonlinear current source, it's not directly
@@ -54,6 +66,8 @@ def get_passive_sizing(
     i_l_max = []
     v_ci_max = []
     v_co_max = []
+    i_ci_rms = []
+    i_co_rms = []
 
     x_v_in = []
     y_v_out = []
@@ -91,10 +105,14 @@ def get_passive_sizing(
             # print(f"Min out. cap.: {co * 1E6 :.3f} uF")
             # print(f"Out. cap. ripple voltage: {r_co_v_op :.3f} V")
 
+            stress = get_component_stress(v_in, i_in, v_out, f_sw, r_l_a_op, eff)
+
             ci_min.append(ci)
             co_min.append(co)
             l_min.append(l)
-            i_l_max.append(i_in + r_l_a_op)
+            i_l_max.append(stress["l"]["i_pk"])
+            i_ci_rms.append(stress["ci"]["i_rms"])
+            i_co_rms.append(stress["co"]["i_rms"])
             v_ci_max.append(v_in + r_ci_v)
             v_co_max.append(v_out + r_co_v_op)
 
@@ -151,8 +169,19 @@ def get_passive_sizing(
     ci_vdc_min = np.max(v_ci_max) * sf
     co_vdc_min = np.max(v_co_max) * sf
     l_a_min = np.max(i_l_max) * 1.05 # override * sf
+    ci_rms_min = np.max(i_ci_rms) * sf
+    co_rms_min = np.max(i_co_rms) * sf
 
-    return (ci_min, co_min, l_min, ci_vdc_min, co_vdc_min, l_a_min)
+    return (
+        ci_min,
+        co_min,
+        l_min,
+        ci_vdc_min,
+        co_vdc_min,
+        l_a_min,
+        ci_rms_min,
+        co_rms_min,
+    )
 
 
 def get_inductor_sizing(l, i_max, b_sat, r_l):
@@ -179,7 +208,7 @@ def get_inductor_sizing(l, i_max, b_sat, r_l):
 
     # Assume PQ 26/25, B65877A
     k_g_target = 0.125  # cm^5
-    A_c = 0.0001088  # cross sectional area of core, m^2
+    A_c = core_a_c
     A_n = 4.7e-5  # cross sectional area of winding, m^2
     l_n = 0.056  # length of turn, m
     rho = 2 * 1e-8
@@ -200,9 +229,13 @@ def get_inductor_sizing(l, i_max, b_sat, r_l):
     # Get resistance of wire
     r_real = rho * l_w / A_w
 
-    # Get power loss from conduction
-    i_rms = i_max / m.sqrt(2)
-    p_cond = i_rms**2 * r_real
+    # Get power loss from conduction. The ripple ratio splits i_max into the
+    # average current and the triangular ripple on top of it; the ripple sees
+    # the calibrated AC resistance factor of the winding.
+    i_avg = i_max / (1 + r_l)
+    _, i_rms, _, _ = get_triangle_stress(i_avg, 2 * r_l * i_avg)
+    k_ac = get_calibration()["k_ac"]
+    p_cond = (i_avg**2 + k_ac * (i_rms**2 - i_avg**2)) * r_real
 
     # Derive required k_g
     k_g = l**2 * i_max**2 * rho / (b_pk**2 * r_real * k_u) * 1e10
@@ -223,11 +256,223 @@ def get_inductor_core_loss(p_v):
     Returns:
         float: loss, in W
     """
-    vol = 6.54e-6  # m^3
-    return p_v * vol * 1e3
+    return p_v * core_vol * 1e3
+
+
+def get_core_loss_density(f_sw, b_ac, duty=0.5, calibration=None):
+    """_summary_
+    Get the core loss density of the triangular inductor flux from the
+    calibrated Steinmetz parameters, using the equivalent frequency of the
+    modified Steinmetz equation, F_EQ = 2 F / (PI^2 D (1 - D)).
+
+    Args:
+        f_sw (float|np.ndarray): Switching frequency, in Hz
+        b_ac (float|np.ndarray): Peak AC flux density, in T
+        duty (float|np.ndarray, optional): Duty cycle. Defaults to 0.5.
+        calibration (dict, optional): Loss model parameters, see
+            calibration.default_calibration. Defaults to get_calibration().
+
+    Returns:
+        float|np.ndarray: loss, in kW/m^3, as taken by get_inductor_core_loss
+    """
+    if calibration is None:
+        calibration = get_calibration()
+    duty = np.clip(duty, 0.01, 0.99)
+    f_eq = 2 * f_sw / (np.pi**2 * duty * (1 - duty))
+    return (
+        calibration["k_core"]
+        * f_eq ** (calibration["alpha"] - 1)
+        * np.abs(b_ac) ** calibration["beta"]
+        * f_sw
+        * 1e-3
+    )
+
+
+def get_capacitor_esr_f(esr_model, f, t=20):
+    """_summary_
+    Evaluate a compact ESR(f, T) model:
+
+        ESR = (R_S + K_D / f + K_S sqrt(f)) * (1 + A_T (T - 20))
+
+    where R_S is the electrode/electrolyte resistance, K_D the dielectric loss
+    (DF / (2 pi C)) and K_S the skin/proximity term.
+
+    Args:
+        esr_model (np.ndarray): [R_S, K_D, K_S, A_T] in the last axis.
+            Leading axes broadcast against f, e.g. (parts, 1, 4) against
+            (1, harmonics).
+        f (float|np.ndarray): Frequency, in Hz
+        t (float|np.ndarray, optional): Temperature, in C. Defaults to 20.
+
+    Returns:
+        float|np.ndarray: ESR, in Ohm.
+    """
+    esr_model = np.asarray(esr_model)
+    r_s, k_d, k_s, a_t = (esr_model[..., k] for k in range(4))
+    f = np.asarray(f)
+    return (r_s + k_d / f + k_s * np.sqrt(f)) * (1 + a_t * (np.asarray(t) - 20))
+
+
+def fit_capacitor_esr(f, esr, t=None):
+    """_summary_
+    Fit a compact ESR(f, T) model (see get_capacitor_esr_f) to datasheet
+    points. The frequency terms are fit with non-negative least squares on the
+    relative error; the temperature coefficient is then fit if the points span
+    more than one temperature.
+
+    Args:
+        f ([float]): Frequency of each point, in Hz
+        esr ([float]): ESR of each point, in Ohm
+        t ([float], optional): Temperature of each point, in C. Defaults to
+            20 C for all points.
+
+    Returns:
+        np.ndarray: [R_S, K_D, K_S, A_T].
+    """
+    f = np.asarray(f, dtype=float)
+    esr = np.asarray(esr, dtype=float)
+    t = np.full_like(f, 20.0) if t is None else np.asarray(t, dtype=float)
+
+    def fit_f(a_t):
+        scale = 1 + a_t * (t - 20)
+        basis = np.column_stack([np.ones_like(f), 1 / f, np.sqrt(f)]) * scale[:, None]
+        # Weight rows by 1 / ESR so that every decade counts equally.
+        x, _ = nnls(basis / esr[:, None], np.ones_like(f))
+        return x
 
-def get_capacitor_loss():
-    pass
+    if np.ptp(t) == 0:
+        return np.append(fit_f(0.0), 0.0)
+
+    def residual(a_t):
+        model = np.append(fit_f(a_t[0]), a_t[0])
+        return get_capacitor_esr_f(model, f, t) / esr - 1
+
+    a_t = least_squares(residual, [0.0], bounds=(-0.009, 0.05)).x[0]
+    return np.append(fit_f(a_t), a_t)
+
+
+def fit_capacitor_impedance(f, z, c=None):
+    """_summary_
+    Fit capacitance, ESL and a compact ESR(f) model to points read off a
+    datasheet |Z| curve:
+
+        |Z| = |ESR(f) + j (2 pi f ESL - 1 / (2 pi f C))|
+
+    Args:
+        f ([float]): Frequency of each point, in Hz
+        z ([float]): Impedance magnitude of each point, in Ohm
+        c (float, optional): Known capacitance, in F. Fit when not given.
+
+    Returns:
+        (np.ndarray, float, float): ESR model [R_S, K_D, K_S, A_T],
+            capacitance and ESL.
+    """
+    f = np.asarray(f, dtype=float)
+    z = np.asarray(z, dtype=float)
+    w = 2 * m.pi * f
+
+    # Seed from the curve: C from the lowest point, ESR from the minimum,
+    # ESL from the highest point.
+    c_0 = c if c is not None else 1 / (w[0] * z[0])
+    esl_0 = max(z[-1] / w[-1], 1e-10)
+    r_0 = max(np.min(z), 1e-4)
+    x_0 = np.log([r_0, 1e-3 * r_0 * f[0], 1e-9, c_0, esl_0])
+
+    def residual(x):
+        r_s, k_d, k_s, c_, esl = np.exp(x)
+        if c is not None:
+            c_ = c
+        esr = r_s + k_d / f + k_s * np.sqrt(f)
+        z_model = np.hypot(esr, w * esl - 1 / (w * c_))
+        return np.log(z_model / z)
+
+    x = np.exp(least_squares(residual, x_0).x)
+    c_fit = c if c is not None else x[3]
+    return (np.array([x[0], x[1], x[2], 0.0]), c_fit, x[4])
+
+
+def get_capacitor_loss(esr_model, i_spectrum, f_sw, t=20, num_parallel=1):
+    """_summary_
+    Get capacitor loss from the full ripple harmonic spectrum, evaluating the
+    ESR at every harmonic of the switching frequency:
+
+        P = sum(I_N^2 / 2 * ESR(N F_SW, T))
+
+    Args:
+        esr_model (np.ndarray): [R_S, K_D, K_S, A_T], or (parts, 4) to
+            evaluate several parts at once.
+        i_spectrum (np.ndarray): Peak harmonic amplitudes 1..N of the bank
+            current (see get_component_stress), (..., N).
+        f_sw (float): Switching frequency, in Hz
+        t (float|np.ndarray, optional): Temperature, in C, broadcast against
+            the leading axes of i_spectrum. Defaults to 20.
+        num_parallel (int|np.ndarray, optional): Number of identical
+            capacitors sharing the current. Defaults to 1.
+
+    Returns:
+        float|np.ndarray: Loss of the bank, in W. Shaped (parts, ...) when
+            several parts are given.
+    """
+    esr_model = np.asarray(esr_model, dtype=float)
+    i_spectrum = np.asarray(i_spectrum, dtype=float)
+    t = np.asarray(t, dtype=float)
+    f_n = f_sw * np.arange(1, i_spectrum.shape[-1] + 1)
+
+    # Each of the num_parallel capacitors carries 1 / num_parallel of the
+    # current, so the bank ESR is ESR / num_parallel.
+    i_sq = i_spectrum**2 / 2
+    if esr_model.ndim == 1:
+        esr = get_capacitor_esr_f(esr_model, f_n, t[..., None])
+        return np.sum(i_sq * esr, axis=-1) / num_parallel
+
+    # The temperature factor does not depend on frequency, so sum the
+    # harmonics at 20 C and scale per part and point afterwards.
+    esr = get_capacitor_esr_f(esr_model[:, None, :], f_n[None, :])
+    loss = np.tensordot(esr, i_sq, axes=([-1], [-1]))
+    per_part = (-1,) + (1,) * (loss.ndim - 1)
+    loss = loss * (1 + esr_model[:, 3].reshape(per_part) * (t - 20))
+    num_parallel = np.asarray(num_parallel, dtype=float)
+    return loss / num_parallel.reshape((-1,) + (1,) * (loss.ndim - 1))
+
+
+def get_capacitor_loss_map(
+    parts, position, v_in, i_in, v_out, f_sw, l, t=20, num_harmonics=50
+):
+    """_summary_
+    Get the loss of every candidate capacitor bank at every operating point in
+    one vectorized pass.
+
+    Args:
+        parts ({str: (dict, int)}): Part name to (catalogue entry with an
+            "esr_curve", number in parallel).
+        position (str): "ci" or "co".
+        v_in (np.ndarray): Input voltage of each point
+        i_in (np.ndarray): Input current of each point
+        v_out (np.ndarray): Output voltage of each point
+        f_sw (float): Switching frequency
+        l (float): Inductance
+        t (float|np.ndarray, optional): Capacitor temperature, in C, scalar
+            or per point. Defaults to 20.
+        num_harmonics (int, optional): Harmonics of F_SW to include.
+            Defaults to 50.
+
+    Returns:
+        ([str], np.ndarray): Part names and their loss, (parts, ...points).
+    """
+    names = list(parts.keys())
+    models = np.array(
+        [fit_capacitor_esr(*zip(*parts[name][0]["esr_curve"])) for name in names]
+    )
+    num_parallel = np.array([parts[name][1] for name in names])
+
+    i_l_pp = get_inductor_ripple(v_in, v_out, f_sw, l)
+    stress = get_component_stress(
+        v_in, i_in, v_out, f_sw, i_l_pp, num_harmonics=num_harmonics
+    )
+    loss = get_capacitor_loss(
+        models, stress[position]["i_spectrum"], f_sw, t, num_parallel
+    )
+    return (names, loss)
 
 def get_capacitor_esr(c, f_sw, df):
     ESR = df / (2 * m.pi * f_sw * c)
@@ -313,8 +558,10 @@ if __name__ == "__main__":
     # print(f"V_RMS: {v_rms} V, I_RMS: {i_rms} A")
 
     inductor_current_pk_pk = 2.75 # A
-    i_rms = inductor_current_pk_pk / (2 * m.sqrt(2))
-    print(f"I_RMS: {i_rms} A")
+    v_in, i_in, v_out, f_sw = 68.931, 5.84, 85, 104 * 1E3
+    stress = get_component_stress(v_in, i_in, v_out, f_sw, inductor_current_pk_pk)
+    i_rms = stress["ci"]["i_rms"]
+    print(f"I_RMS (C_I): {i_rms} A")
 
     # Input cap
     # 80-A759KS156M2AAAE52
@@ -324,6 +571,9 @@ if __name__ == "__main__":
     print(f"P_DIS: {p_dis} W")
 
     # Output cap
+    i_rms = stress["co"]["i_rms"]
+    print(f"I_RMS (C_O): {i_rms} A")
+
     # 810-CGA9P3X7T2E225MA
     # @ 125 V bias, 125 C, 109 kHz
     c = 1.034 * 1E-6 # uF
@@ -0,0 +1,336 @@
+"""_summary_
+@file       sensor_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Array current sense selection: shunt, amplifier gain and ADC range.
+
+            The array current is sensed by a shunt in the array return with
+            an INA21x amplifier into the microcontroller ADC
+            (hw/sensors.kicad_sch, 2 mOhm with an INA210). The shunt burns
+            I^2 R, and the perturb and observe tracker (mppt_tuning) decides
+            on P = V I measured through it. Two measurement errors cost
+            tracking efficiency:
+            - an offset current I_OS (amplifier V_OS over R, ADC offset) moves
+              the maximum of the measured power by I_OS / KAPPA, where
+              KAPPA = -d^2P/dV^2 at the MPP, which loses I_OS^2 / (2 KAPPA),
+            - noise and quantization of the averaged current, SIGMA_I, hide
+              the power change of a step DV close to the MPP, where it is
+              KAPPA DV |V - V_MPP|. The tracker wanders over the band where
+              that is below SIGMA_P = V_MPP SIGMA_I, which loses about
+              SIGMA_P^2 / (KAPPA DV^2). Averaging only beats the quantization
+              down when the amplifier noise dithers it.
+            A gain error scales every power reading alike and does not move
+            the maximum, so it is left out.
+
+            Both losses depend on the irradiance through KAPPA and the
+            current, and are weighted by the mission irradiance distribution
+            (irradiance_model) together with the shunt loss. Every E-series
+            shunt value, INA21x gain and ADC reference is evaluated in one
+            broadcast pass; combinations whose full scale current is below
+            the array short circuit current at the highest irradiance are
+            infeasible.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.converter_model import default_boost_design
+from design_procedures.firmware_export import read_c_header
+from design_procedures.fixed_point_design import adc_bits
+from design_procedures.irradiance_model import stream_irradiance
+from design_procedures.mppt_tuning import get_array_mpp
+from design_procedures.nonideal_model import model_nonideal_cell_vec
+from design_procedures.transient_analysis import r_sh
+
+e_series = {
+    "E12": [1.0, 1.2, 1.5, 1.8, 2.2, 2.7, 3.3, 3.9, 4.7, 5.6, 6.8, 8.2],
+    "E24": [
+        1.0, 1.1, 1.2, 1.3, 1.5, 1.6, 1.8, 2.0, 2.2, 2.4, 2.7, 3.0,
+        3.3, 3.6, 3.9, 4.3, 4.7, 5.1, 5.6, 6.2, 6.8, 7.5, 8.2, 9.1,
+    ],
+}  # fmt: skip
+
+# INA21x family: gain (V/V), offset voltage (V, max) and bandwidth (Hz).
+amplifiers = {
+    "INA213": (50.0, 100e-6, 80e3),
+    "INA215": (75.0, 60e-6, 60e3),
+    "INA214": (100.0, 60e-6, 30e3),
+    "INA210": (200.0, 35e-6, 14e3),
+    "INA211": (500.0, 35e-6, 7e3),
+    "INA212": (1000.0, 35e-6, 4e3),
+}
+e_n = 25e-9  # V/rt(Hz), INA21x input noise density
+adc_ranges = [2.048, 2.5, 3.3]  # V, VREFBUF settings and VDDA
+adc_noise = 1.0  # LSB rms, per conversion
+adc_offset = 1.5  # LSB
+f_sample = default_boost_design["f_sw"]  # Hz, one sample per switching period
+k_enhancement = 1.3  # Cloud edge enhancement over the 1000 W/m^2 full scale
+num_cells = 111
+
+baseline = {"r": 2e-3, "amplifier": "INA210", "v_ref": 3.3}  # hw/sensors
+
+
+def get_shunt_values(series="E24", decades=(1e-4, 1e-3, 1e-2)):
+    """_summary_
+    Get the shunt values of an E-series across decades.
+
+    Args:
+        series (str, optional): Key of e_series. Defaults to "E24".
+        decades (tuple, optional): Decade multipliers (Ohm). Defaults to 0.1
+            mOhm to 99 mOhm.
+
+    Returns:
+        np.ndarray: Shunt values (Ohm), ascending.
+    """
+    return np.round(np.outer(decades, e_series[series]).ravel(), 12)
+
+
+def get_mission_irradiance(climate="temperate", days=7, seed=0, bin_width=25.0):
+    """_summary_
+    Get the daylight irradiance distribution of the mission.
+
+    Args:
+        climate (str, optional): Climate class, see
+            irradiance_model.climate_classes. Defaults to "temperate".
+        days (int, optional): Days streamed. Defaults to 7.
+        seed (int, optional): Random seed. Defaults to 0.
+        bin_width (float, optional): Histogram bin (W/m^2). Defaults to 25.
+
+    Returns:
+        (np.ndarray, np.ndarray): Bin centres (W/m^2) and the share of
+            daylight time in each.
+    """
+    edges = np.arange(0.0, 1000 * k_enhancement + bin_width, bin_width)
+    hist = np.zeros(len(edges) - 1)
+    for chunk in stream_irradiance(climate, seed, days * 86400.0, dt=1.0):
+        g = chunk["g"][chunk["g"] > 0]
+        hist += np.histogram(np.minimum(g, edges[-1] - 1e-9), edges)[0]
+    centres = (edges[:-1] + edges[1:]) / 2
+    keep = hist > 0
+    return centres[keep], hist[keep] / hist.sum()
+
+
+def get_mpp_curvature(g, t=298.15):
+    """_summary_
+    Get the array maximum power point and the curvature of the P-V curve
+    there.
+
+    Args:
+        g (np.ndarray): Irradiance (W/m^2)
+        t (float, optional): Cell temperature (K). Defaults to 298.15.
+
+    Returns:
+        (np.ndarray, np.ndarray, np.ndarray): V_MPP (V), I_MPP (A) and
+            KAPPA = -d^2P/dV^2 (W/V^2).
+    """
+    v_mpp, p_mpp = get_array_mpp(num_cells, g, t)
+    h = 0.01 * v_mpp
+
+    def power(v):
+        return v * model_nonideal_cell_vec(g, t, 0, r_sh, v / num_cells)[0]
+
+    kappa = -(power(v_mpp + h) - 2 * power(v_mpp) + power(v_mpp - h)) / h**2
+    return v_mpp, p_mpp / v_mpp, kappa
+
+
+def get_sense_losses(r, gain, v_os, bw, v_ref, g, weight, tuning=None):
+    """_summary_
+    Get the shunt and tracking losses of current sense designs over the
+    mission. Design arguments broadcast against each other.
+
+    Args:
+        r (np.ndarray): Shunt (Ohm)
+        gain (np.ndarray): Amplifier gain (V/V)
+        v_os (np.ndarray): Amplifier offset voltage (V)
+        bw (np.ndarray): Amplifier bandwidth (Hz)
+        v_ref (np.ndarray): ADC full scale (V)
+        g (np.ndarray): Irradiance bins (W/m^2), see get_mission_irradiance
+        weight (np.ndarray): Share of the time in each bin
+        tuning (dict, optional): Tracker perturbation period MPPT_PERIOD (s),
+            step MPPT_STEP (V) and averaged fraction of the period
+            MPPT_AVG_FRACTION, as tuned by mppt_tuning. Defaults to the
+            values exported to the firmware, mppt_tuning.h.
+
+    Returns:
+        dict: Per design, mission mean power (W) of "shunt", "offset",
+            "noise", their sum "total", the sum relative to the mean MPP
+            power "penalty", "feasible", and the per bin "total_g" (..., G).
+    """
+    tuning = read_c_header("mppt_tuning.h") if tuning is None else tuning
+    step = tuning["MPPT_STEP"]
+    v_mpp, i_mpp, kappa = get_mpp_curvature(g)
+    i_max = model_nonideal_cell_vec(1000 * k_enhancement, 298.15, 0, r_sh, 0.0)[0]
+    r, gain, v_os, bw, v_ref = (
+        x[..., None]
+        for x in np.broadcast_arrays(
+            *[np.asarray(x, dtype=float) for x in (r, gain, v_os, bw, v_ref)]
+        )
+    )
+
+    q = v_ref / 2**adc_bits  # ADC LSB (V)
+    i_per_v = 1 / (r * gain)
+    i_os = (v_os * gain + adc_offset * q) * i_per_v
+
+    # Amplifier noise over its bandwidth and ADC noise, in V at the ADC. The
+    # average of N samples beats the quantization down only as far as the
+    # noise dithers it.
+    sigma_n = np.sqrt(e_n**2 * np.pi / 2 * bw * gain**2 + (adc_noise * q) ** 2)
+    n_avg = f_sample * tuning["MPPT_PERIOD"] * tuning["MPPT_AVG_FRACTION"]
+    n_eff = 1 + (n_avg - 1) * np.minimum(1, (2 * sigma_n / q) ** 2)
+    sigma_i = np.sqrt((sigma_n**2 + q**2 / 12) / n_eff) * i_per_v
+
+    p_mpp = v_mpp * i_mpp
+    shunt = i_mpp**2 * r
+    offset = np.minimum(i_os**2 / (2 * kappa), p_mpp)
+    noise = np.minimum((v_mpp * sigma_i) ** 2 / (kappa * step**2), p_mpp)
+    total_g = shunt + offset + noise
+
+    mean = lambda x: np.sum(x * weight, axis=-1)
+    losses = {
+        "shunt": mean(shunt),
+        "offset": mean(offset),
+        "noise": mean(noise),
+        "total": mean(total_g),
+        "total_g": total_g,
+        "feasible": (v_ref * i_per_v)[..., 0] >= i_max,
+    }
+    losses["penalty"] = losses["total"] / mean(p_mpp)
+    return losses
+
+
+def optimize_current_sense(g, weight, series="E24", ranges=adc_ranges, tuning=None):
+    """_summary_
+    Evaluate every shunt value, amplifier and ADC range at once and pick the
+    lowest mission loss.
+
+    Args:
+        g (np.ndarray): Irradiance bins (W/m^2), see get_mission_irradiance
+        weight (np.ndarray): Share of the time in each bin
+        series (str, optional): Key of e_series. Defaults to "E24".
+        ranges ([float], optional): ADC full scales (V). Defaults to
+            adc_ranges.
+        tuning (dict, optional): Tracker tuning, see get_sense_losses.
+
+    Returns:
+        (dict, dict): Best design ("r", "amplifier", "v_ref" and its losses)
+            and the losses of every design, shaped (R, AMPLIFIER, RANGE),
+            with the "r" axis values.
+    """
+    r = get_shunt_values(series)
+    names = list(amplifiers)
+    gain, v_os, bw = np.array([amplifiers[n] for n in names]).T
+    losses = get_sense_losses(
+        r[:, None, None],
+        gain[None, :, None],
+        v_os[None, :, None],
+        bw[None, :, None],
+        np.asarray(ranges)[None, None, :],
+        g,
+        weight,
+        tuning,
+    )
+    ranked = np.where(losses["feasible"], losses["total"], np.inf)
+    idx = np.unravel_index(np.argmin(ranked), ranked.shape)
+    best = {"r": r[idx[0]], "amplifier": names[idx[1]], "v_ref": ranges[idx[2]]}
+    best.update({k: v[idx] for k, v in losses.items()})
+    losses["r"] = r
+    return best, losses
+
+
+def get_design_losses(design, g, weight, tuning=None):
+    """_summary_
+    Get the losses of one current sense design.
+
+    Args:
+        design (dict): "r" (Ohm), "amplifier" (key of amplifiers) and
+            "v_ref" (V), see baseline
+        g (np.ndarray): Irradiance bins (W/m^2)
+        weight (np.ndarray): Share of the time in each bin
+        tuning (dict, optional): Tracker tuning, see get_sense_losses.
+
+    Returns:
+        dict: Losses, see get_sense_losses.
+    """
+    gain, v_os, bw = amplifiers[design["amplifier"]]
+    losses = get_sense_losses(
+        design["r"], gain, v_os, bw, design["v_ref"], g, weight, tuning
+    )
+    return {k: v[()] if k != "total_g" else v for k, v in losses.items()}
+
+
+def get_sensor_design_map(g, weight, losses, designs):
+    """_summary_
+    Plot the mission loss across shunt values for every amplifier at each
+    ADC range, and the loss across irradiance of a few designs.
+
+    Args:
+        g (np.ndarray): Irradiance bins (W/m^2)
+        weight (np.ndarray): Share of the time in each bin
+        losses (dict): Losses of every design, see optimize_current_sense
+        designs (dict): Label to design, see baseline
+    """
+    fig, axs = plt.subplots(1, len(adc_ranges) + 1, figsize=(22, 5.5))
+    total = np.where(losses["feasible"], losses["total"], np.nan)
+    for k, v_ref in enumerate(adc_ranges):
+        for j, name in enumerate(amplifiers):
+            axs[k].loglog(losses["r"] * 1e3, total[:, j, k] * 1e3, label=name)
+        axs[k].set_title(f"Mission loss, ADC full scale {v_ref} V")
+        axs[k].set_xlabel("Shunt (mOhm)")
+        axs[k].set_ylabel("Shunt + tracking loss (mW)")
+        axs[k].grid(which="both")
+    axs[0].legend()
+
+    ax = axs[-1]
+    ax.bar(g, weight * 100, width=g[1] - g[0], color="0.85", label="Time share")
+    ax.set_xlabel("Irradiance (W/m^2)")
+    ax.set_ylabel("Daylight time (%)")
+    twin = ax.twinx()
+    for label, design in designs.items():
+        twin.semilogy(g, get_design_losses(design, g, weight)["total_g"], label=label)
+    twin.set_ylabel("Shunt + tracking loss (W)")
+    twin.legend()
+    ax.set_title("Loss across the mission irradiance")
+
+    fig.tight_layout()
+    plt.savefig("sensor_design_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    g, weight = get_mission_irradiance()
+    tuning = read_c_header("mppt_tuning.h")
+
+    start = time.perf_counter()
+    best, losses = optimize_current_sense(g, weight, tuning=tuning)
+    elapsed = time.perf_counter() - start
+    print(
+        f"{losses['total'].size} shunt, gain and ADC range combinations over "
+        f"{len(g)} irradiance bins in {elapsed * 1e3 :.0f} ms, "
+        f"{losses['feasible'].sum()} feasible"
+    )
+
+    ref = get_design_losses(baseline, g, weight, tuning)
+    for label, design in (("Current", {**baseline, **ref}), ("Best", best)):
+        print(
+            f"{label:>8}: {design['r'] * 1e3 :.2f} mOhm, {design['amplifier']}, "
+            f"{design['v_ref']} V full scale: shunt {design['shunt'] * 1e3 :.1f} mW, "
+            f"offset {design['offset'] * 1e3 :.2f} mW, noise "
+            f"{design['noise'] * 1e3 :.3f} mW, tracking and shunt penalty "
+            f"{design['penalty'] * 100 :.4f} %"
+        )
+
+    get_sensor_design_map(g, weight, losses, {"Current": baseline, "Best": best})
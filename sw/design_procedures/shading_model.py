@@ -0,0 +1,488 @@
+"""_summary_
+@file       shading_model.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Geometric shading of the array cells on a moving vehicle.
+
+            Frames:
+            - world, x east, y north, z up (m),
+            - vehicle, x forward, y left, z up, with its origin on the road
+              under the rear axle, turned by the heading (clockwise from
+              north) and moved along the route.
+            The sun direction is S = (sin A cos E, cos A cos E, sin E) in the
+            world frame for azimuth A (clockwise from north) and elevation E.
+
+            The irradiance of a cell with unit normal N is
+                G = DNI max(N . S, 0) LIT + DHI (1 + N_Z) / 2,
+            the beam part where the ray from the cell center towards the sun
+            is not blocked, and the isotropic diffuse part seen by the tilt of
+            the cell. Rays are tested against:
+            - the vehicle's own geometry (canopy, fairings), as axis aligned
+              boxes in the vehicle frame, with the sun direction turned into
+              the vehicle frame,
+            - roadside geometry (buildings, overpasses as boxes, tree crowns
+              as spheres) in the world frame, from the cell positions moved
+              along the route.
+            Every test is a vectorized slab or sphere intersection over
+            (time, cell, object), in chunks of time, with the roadside
+            objects culled to those near the chunk of route. An object of
+            height H can shadow the road out to H / tan(E), so the cull
+            distance grows as the sun sets.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.irradiance_model import get_clear_sky_zenith, get_solar_angles
+
+cell_pitch = 0.127  # m, 125 mm cells with a 2 mm gap
+diffuse_fraction = 0.15  # Diffuse share of the clear sky irradiance
+# m, margin added to the shadow reach when culling, for the cell offsets from
+# the route point.
+cull_margin = 10.0
+
+
+def get_array_layout(
+    num_cells,
+    rows=6,
+    pitch=cell_pitch,
+    radius=3.0,
+    x_0=0.4,
+    z_0=1.0,
+):
+    """_summary_
+    Get the cell centers and normals of a rectangular array on a top surface
+    curved across the width.
+
+    Args:
+        num_cells (int): Number of solar cells
+        rows (int, optional): Cells across the width. Defaults to 6.
+        pitch (float, optional): Cell pitch (m). Defaults to cell_pitch.
+        radius (float, optional): Radius of the curvature across the width
+            (m). Defaults to 3.
+        x_0 (float, optional): Rear edge of the array (m). Defaults to 0.4.
+        z_0 (float, optional): Height of the center line (m). Defaults to 1.
+
+    Returns:
+        (np.ndarray, np.ndarray): Centers and unit normals in the vehicle
+            frame, (N, 3).
+    """
+    col, row = np.divmod(np.arange(num_cells), rows)
+    x = x_0 + (col + 0.5) * pitch
+    # Arc length across the width, centered.
+    angle = (row - (rows - 1) / 2) * pitch / radius
+    y = radius * np.sin(angle)
+    z = z_0 - radius * (1 - np.cos(angle))
+    normal = np.stack([np.zeros(num_cells), np.sin(angle), np.cos(angle)], axis=1)
+    return (np.stack([x, y, z], axis=1), normal)
+
+
+def get_example_vehicle(num_cells):
+    """_summary_
+    Get the array of the example vehicle with its own shading geometry, a
+    driver canopy ahead of the array and a low rear fairing.
+
+    Args:
+        num_cells (int): Number of solar cells
+
+    Returns:
+        (np.ndarray, np.ndarray, (np.ndarray, np.ndarray)): Cell centers and
+            normals, see get_array_layout, and the lower and upper corners
+            of the vehicle boxes, see get_cell_irradiance.
+    """
+    cells, normals = get_array_layout(num_cells)
+    canopy = (
+        np.array([[2.9, -0.35, 0.9], [-0.2, -0.5, 0.0]]),
+        np.array([[3.7, 0.35, 1.45], [0.2, 0.5, 1.05]]),
+    )
+    return (cells, normals, canopy)
+
+
+def get_clear_sky_components(zenith):
+    """_summary_
+    Split the clear sky irradiance into its beam and diffuse parts, with a
+    fixed diffuse fraction.
+
+    Args:
+        zenith (np.ndarray): Solar zenith angle (rad)
+
+    Returns:
+        (np.ndarray, np.ndarray, np.ndarray): GHI, DNI and DHI (W/m^2).
+    """
+    ghi = get_clear_sky_zenith(zenith)
+    dhi = diffuse_fraction * ghi
+    dni = (ghi - dhi) / np.maximum(np.cos(zenith), 0.05)
+    return (ghi, dni, dhi)
+
+
+def get_sun_direction(azimuth, elevation):
+    """_summary_
+    Get the unit vector towards the sun in the world frame.
+
+    Args:
+        azimuth (np.ndarray): Azimuth, clockwise from north (rad)
+        elevation (np.ndarray): Elevation (rad)
+
+    Returns:
+        np.ndarray: Direction, (..., 3).
+    """
+    return np.stack(
+        [
+            np.sin(azimuth) * np.cos(elevation),
+            np.cos(azimuth) * np.cos(elevation),
+            np.sin(elevation),
+        ],
+        axis=-1,
+    )
+
+
+def get_vehicle_axes(heading):
+    """_summary_
+    Get the forward and left unit vectors of the vehicle in the world frame.
+
+    Args:
+        heading (np.ndarray): Heading, clockwise from north (rad)
+
+    Returns:
+        (np.ndarray, np.ndarray): Forward and left, (..., 3).
+    """
+    zero = np.zeros_like(heading)
+    forward = np.stack([np.sin(heading), np.cos(heading), zero], axis=-1)
+    left = np.stack([-np.cos(heading), np.sin(heading), zero], axis=-1)
+    return (forward, left)
+
+
+def get_ray_box_hits(origin, direction, lo, hi):
+    """_summary_
+    Test rays against axis aligned boxes with the slab method.
+
+    Args:
+        origin (np.ndarray): Ray origins, (..., 3)
+        direction (np.ndarray): Ray directions, (..., 3)
+        lo (np.ndarray): Lower corners, (B, 3)
+        hi (np.ndarray): Upper corners, (B, 3)
+
+    Returns:
+        np.ndarray: Whether each ray hits any box ahead of its origin, (...).
+    """
+    if len(lo) == 0:
+        return np.zeros(origin.shape[:-1], dtype=bool)
+    with np.errstate(divide="ignore", invalid="ignore"):
+        inv = 1 / direction[..., None, :]
+        t_1 = (lo - origin[..., None, :]) * inv
+        t_2 = (hi - origin[..., None, :]) * inv
+    # A ray parallel to a slab is inside it or misses it entirely.
+    inside = (origin[..., None, :] >= lo) & (origin[..., None, :] <= hi)
+    parallel = direction[..., None, :] == 0
+    t_near = np.where(parallel, np.where(inside, -np.inf, np.inf), np.minimum(t_1, t_2))
+    t_far = np.where(parallel, np.where(inside, np.inf, -np.inf), np.maximum(t_1, t_2))
+    t_enter = t_near.max(axis=-1)
+    t_exit = t_far.min(axis=-1)
+    return ((t_exit >= np.maximum(t_enter, 1e-6))).any(axis=-1)
+
+
+def get_ray_sphere_hits(origin, direction, center, radius):
+    """_summary_
+    Test rays of unit direction against spheres.
+
+    Args:
+        origin (np.ndarray): Ray origins, (..., 3)
+        direction (np.ndarray): Unit ray directions, (..., 3)
+        center (np.ndarray): Sphere centers, (S, 3)
+        radius (np.ndarray): Sphere radii, (S)
+
+    Returns:
+        np.ndarray: Whether each ray hits any sphere ahead of its origin,
+            (...).
+    """
+    if len(center) == 0:
+        return np.zeros(origin.shape[:-1], dtype=bool)
+    offset = center - origin[..., None, :]
+    t_c = np.einsum("...sj,...j->...s", offset, direction)
+    miss = np.einsum("...sj,...sj->...s", offset, offset) - t_c**2
+    return ((t_c > 0) & (miss <= radius**2)).any(axis=-1)
+
+
+def get_cell_irradiance(
+    cells,
+    normals,
+    route,
+    azimuth,
+    elevation,
+    dni,
+    dhi,
+    canopy=None,
+    boxes=None,
+    spheres=None,
+    chunk=16,
+):
+    """_summary_
+    Get the irradiance of every cell along a route.
+
+    Args:
+        cells (np.ndarray): Cell centers in the vehicle frame, (N, 3)
+        normals (np.ndarray): Cell unit normals in the vehicle frame, (N, 3)
+        route (dict): Arrays over time (T): x, y (m) and heading (rad)
+        azimuth (np.ndarray): Sun azimuth (rad), (T)
+        elevation (np.ndarray): Sun elevation (rad), (T)
+        dni (np.ndarray): Direct normal irradiance (W/m^2), (T)
+        dhi (np.ndarray): Diffuse horizontal irradiance (W/m^2), (T)
+        canopy ((np.ndarray, np.ndarray), optional): Lower and upper corners
+            of vehicle frame boxes, (B, 3). Defaults to none.
+        boxes ((np.ndarray, np.ndarray), optional): Lower and upper corners
+            of world frame boxes, (B, 3). Defaults to none.
+        spheres ((np.ndarray, np.ndarray), optional): Centers (S, 3) and radii
+            (S) of world frame spheres. Defaults to none.
+        chunk (int, optional): Time steps per vectorized chunk, short enough
+            for the culling to stay tight. Defaults to 16.
+
+    Returns:
+        (np.ndarray, np.ndarray): Irradiance (T, N) and whether the beam
+            reaches each cell (T, N).
+    """
+    empty = (np.zeros((0, 3)), np.zeros((0, 3)))
+    canopy = empty if canopy is None else canopy
+    boxes = empty if boxes is None else boxes
+    spheres = (np.zeros((0, 3)), np.zeros(0)) if spheres is None else spheres
+
+    num_steps = len(azimuth)
+    g = np.zeros((num_steps, len(cells)))
+    lit = np.zeros((num_steps, len(cells)), dtype=bool)
+    sun = get_sun_direction(np.asarray(azimuth), np.asarray(elevation))
+    forward, left = get_vehicle_axes(np.asarray(route["heading"]))
+    position = np.stack([route["x"], route["y"], np.zeros(num_steps)], axis=-1)
+    # Highest point of any roadside object above the lowest cell.
+    top = max(
+        np.max(boxes[1][:, 2], initial=0.0),
+        np.max(spheres[0][:, 2] + spheres[1], initial=0.0),
+    ) - min(cells[:, 2].min(), 0.0)
+
+    for start in range(0, num_steps, chunk):
+        sl = slice(start, min(start + chunk, num_steps))
+        # Sun in the vehicle frame, and the cells in the world frame.
+        s_v = np.stack(
+            [
+                np.einsum("tj,tj->t", sun[sl], forward[sl]),
+                np.einsum("tj,tj->t", sun[sl], left[sl]),
+                sun[sl, 2],
+            ],
+            axis=-1,
+        )
+        cos_i = np.maximum(s_v @ normals.T, 0) * (s_v[:, None, 2] > 0)
+        origin_v = np.broadcast_to(cells, (len(s_v),) + cells.shape)
+        dir_v = np.broadcast_to(s_v[:, None, :], origin_v.shape)
+        blocked = get_ray_box_hits(origin_v, dir_v, *canopy)
+
+        origin_w = (
+            position[sl, None, :]
+            + cells[None, :, 0, None] * forward[sl, None, :]
+            + cells[None, :, 1, None] * left[sl, None, :]
+            + cells[None, :, 2, None] * np.array([0, 0, 1.0])
+        )
+        dir_w = np.broadcast_to(sun[sl, None, :], origin_w.shape)
+        # Cull roadside objects beyond the reach of their shadows at the
+        # lowest sun of this chunk. Below the horizon there is no beam.
+        elevation_min = np.min(np.asarray(elevation)[sl])
+        if elevation_min > 0:
+            reach = top / np.tan(elevation_min) + cull_margin
+        else:
+            reach = -np.inf if np.all(sun[sl, 2] <= 0) else np.inf
+        p_lo = position[sl].min(axis=0) - reach
+        p_hi = position[sl].max(axis=0) + reach
+        near = ((boxes[1][:, :2] >= p_lo[:2]) & (boxes[0][:, :2] <= p_hi[:2])).all(
+            axis=1
+        )
+        blocked |= get_ray_box_hits(origin_w, dir_w, boxes[0][near], boxes[1][near])
+        r = spheres[1][:, None]
+        near = (
+            (spheres[0][:, :2] + r >= p_lo[:2]) & (spheres[0][:, :2] - r <= p_hi[:2])
+        ).all(axis=1)
+        blocked |= get_ray_sphere_hits(
+            origin_w, dir_w, spheres[0][near], spheres[1][near]
+        )
+
+        lit[sl] = (cos_i > 0) & ~blocked
+        g[sl] = (
+            np.asarray(dni)[sl, None] * cos_i * lit[sl]
+            + np.asarray(dhi)[sl, None] * (1 + normals[:, 2]) / 2
+        )
+    return (g, lit)
+
+
+def get_example_route(duration=3600.0, dt=1.0, speed=15.0, seed=0):
+    """_summary_
+    Get a route of straight legs joined by turns, lined with trees,
+    buildings and overpasses.
+
+    Args:
+        duration (float, optional): Length (s). Defaults to an hour.
+        dt (float, optional): Time step (s). Defaults to 1.
+        speed (float, optional): Vehicle speed (m/s). Defaults to 15.
+        seed (int, optional): Random seed. Defaults to 0.
+
+    Returns:
+        (dict, (np.ndarray, np.ndarray), (np.ndarray, np.ndarray)): Route
+            (t, x, y, heading), world boxes and spheres.
+    """
+    rng = np.random.default_rng(seed)
+    num_steps = int(round(duration / dt))
+    t = np.arange(num_steps) * dt
+    # Heading holds for legs of a few minutes and turns at 10 deg/s.
+    num_legs = int(duration / 120) + 2
+    leg_end = np.cumsum(rng.uniform(60, 300, num_legs))
+    leg_heading = np.cumsum(rng.choice([-np.pi / 2, np.pi / 2, 0.3, -0.3], num_legs))
+    target = leg_heading[np.minimum(np.searchsorted(leg_end, t), num_legs - 1)]
+    heading = np.zeros(num_steps)
+    for k in range(1, num_steps):
+        err = (target[k] - heading[k - 1] + np.pi) % (2 * np.pi) - np.pi
+        heading[k] = heading[k - 1] + np.clip(
+            err, -np.radians(10) * dt, np.radians(10) * dt
+        )
+    x = np.cumsum(speed * dt * np.sin(heading))
+    y = np.cumsum(speed * dt * np.cos(heading))
+
+    # Objects placed beside the road every so many meters of travel.
+    forward, left = get_vehicle_axes(heading)
+    along = np.arange(0, num_steps, max(int(12 / (speed * dt)), 1))
+    side = rng.choice([-1, 1], len(along))
+    kind = rng.random(len(along))
+    offset = rng.uniform(5, 12, len(along))
+    base = (
+        np.stack([x[along], y[along]], axis=1)
+        + (side * offset)[:, None] * left[along, :2]
+    )
+
+    trees = kind < 0.5
+    crown = rng.uniform(2, 4, trees.sum())
+    centers = np.column_stack([base[trees], crown + rng.uniform(2, 5, trees.sum())])
+
+    buildings = (kind >= 0.5) & (kind < 0.6)
+    half = rng.uniform(4, 10, buildings.sum())[:, None]
+    height = rng.uniform(5, 20, buildings.sum())
+    lo = np.column_stack([base[buildings] - half, np.zeros(buildings.sum())])
+    hi = np.column_stack([base[buildings] + half, height])
+
+    # Overpasses across the road, 6 to 7 m up and 15 m wide.
+    bridges = along[rng.random(len(along)) < 0.01]
+    b_lo = np.column_stack([x[bridges] - 8, y[bridges] - 8, np.full(len(bridges), 6.0)])
+    b_hi = np.column_stack([x[bridges] + 8, y[bridges] + 8, np.full(len(bridges), 7.0)])
+    route = {"t": t, "x": x, "y": y, "heading": heading}
+    boxes = (np.concatenate([lo, b_lo]), np.concatenate([hi, b_hi]))
+    return (route, boxes, (centers, crown))
+
+
+def get_shading_map(route, g, cells, boxes, spheres):
+    """_summary_
+    Plot the per cell irradiance along a route.
+
+    Args:
+        route (dict): Route, see get_example_route
+        g (np.ndarray): Cell irradiance (T, N), see get_cell_irradiance
+        cells (np.ndarray): Cell centers in the vehicle frame, (N, 3)
+        boxes ((np.ndarray, np.ndarray)): World frame boxes
+        spheres ((np.ndarray, np.ndarray)): World frame spheres
+    """
+    fig, axs = plt.subplots(2, 2, figsize=(16, 12))
+    ax = axs[0, 0]
+    ax.plot(route["x"] / 1e3, route["y"] / 1e3, "k", linewidth=1)
+    ax.scatter(
+        spheres[0][:, 0] / 1e3, spheres[0][:, 1] / 1e3, s=2, c="g", label="Trees"
+    )
+    centers = (boxes[0] + boxes[1]) / 2
+    ax.scatter(centers[:, 0] / 1e3, centers[:, 1] / 1e3, s=4, c="C1", label="Buildings")
+    ax.set_aspect("equal")
+    ax.set_xlabel("East (km)")
+    ax.set_ylabel("North (km)")
+    ax.set_title("Route")
+    ax.legend()
+
+    ax = axs[0, 1]
+    im = ax.pcolormesh(
+        route["t"] / 60, np.arange(g.shape[1]), g.T, shading="auto", cmap="inferno"
+    )
+    ax.set_xlabel("Time (min)")
+    ax.set_ylabel("Cell")
+    ax.set_title("Cell irradiance (W/m^2)")
+    fig.colorbar(im, ax=ax)
+
+    ax = axs[1, 0]
+    ax.plot(route["t"] / 60, g.mean(axis=1), label="Mean")
+    ax.plot(route["t"] / 60, g.min(axis=1), label="Lowest cell", alpha=0.7)
+    ax.set_xlabel("Time (min)")
+    ax.set_ylabel("Irradiance (W/m^2)")
+    ax.grid(True)
+    ax.legend()
+
+    ax = axs[1, 1]
+    shaded = (g.max(axis=1) - g.min(axis=1)).argmax()
+    sc = ax.scatter(cells[:, 0], cells[:, 1], c=g[shaded], s=60, marker="s")
+    ax.set_aspect("equal")
+    ax.set_xlabel("Forward (m)")
+    ax.set_ylabel("Left (m)")
+    ax.set_title(f"Array at t = {route['t'][shaded] / 60:.1f} min")
+    fig.colorbar(sc, ax=ax)
+
+    plt.savefig("shading_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    num_cells = 111
+    cells, normals, canopy = get_example_vehicle(num_cells)
+
+    route, boxes, spheres = get_example_route(duration=3600.0, dt=1.0)
+    # Afternoon drive, from 14:00 local solar time.
+    t_day = 14 * 3600 + route["t"]
+    zenith, azimuth = get_solar_angles(t_day)
+    _, dni, dhi = get_clear_sky_components(zenith)
+
+    start = time.perf_counter()
+    g, lit = get_cell_irradiance(
+        cells,
+        normals,
+        route,
+        azimuth,
+        np.pi / 2 - zenith,
+        dni,
+        dhi,
+        canopy,
+        boxes,
+        spheres,
+    )
+    elapsed = time.perf_counter() - start
+    print(
+        f"{len(route['t'])} s route x {num_cells} cells against "
+        f"{len(boxes[0]) + len(canopy[0])} boxes and {len(spheres[0])} spheres in "
+        f"{elapsed:.2f} s"
+    )
+
+    g_open, _ = get_cell_irradiance(
+        cells, normals, route, azimuth, np.pi / 2 - zenith, dni, dhi
+    )
+    print(
+        f"Beam blocked for {(~lit).mean() * 100:.1f} % of cell seconds, "
+        f"{(~lit).any(axis=1).mean() * 100:.1f} % of the time on some cell; "
+        f"irradiation {g.sum() / g_open.sum() * 100:.1f} % of unshaded"
+    )
+    # A series string is held to its lowest cell unless the bypass diodes
+    # conduct.
+    print(
+        f"Lowest cell over mean: {(g.min(axis=1) / g.mean(axis=1)).mean() * 100:.1f} "
+        "% on average"
+    )
+
+    get_shading_map(route, g, cells, boxes, spheres)
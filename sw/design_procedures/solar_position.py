@@ -0,0 +1,552 @@
+"""_summary_
+@file       solar_position.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Sun position and plane of array irradiance for mission data.
+
+            The sun position is the PSA algorithm (Blanco-Muriel et al.,
+            2001) from UTC timestamps: mean longitude, mean anomaly and the
+            ascending node of the moon give the ecliptic longitude and the
+            obliquity, then the right ascension, the declination and the
+            local hour angle. Parallax and atmospheric refraction (the NREL
+            SPA correction) are applied to the zenith. It is within about
+            0.01 deg of NREL SPA, far below the spread of the cell normals,
+            and every step is a numpy expression over the timestamps.
+
+            Weather files give GHI, DNI and DHI; when only GHI is logged the
+            Erbs correlation splits it. The sky diffuse part on a tilted cell
+            comes from either transposition model:
+            - Hay-Davies, a circumsolar share A = DNI / I_0 of DHI treated as
+              beam and the rest isotropic,
+            - Perez (1990), circumsolar and horizon brightening coefficients
+              F1, F2 binned by the sky clearness and scaled by the sky
+              brightness.
+            The cell normals of shading_model are turned by the vehicle
+            heading, pitch and roll into the world frame, and the beam and
+            circumsolar parts are dropped where the beam is blocked.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.irradiance_model import latitude, stream_irradiance
+from design_procedures.shading_model import (
+    get_array_layout,
+    get_cell_irradiance,
+    get_example_route,
+    get_sun_direction,
+    get_vehicle_axes,
+)
+
+longitude = -97.74  # deg, Austin, TX
+solar_constant = 1361.0  # W/m^2
+albedo = 0.2  # Ground reflectance, asphalt and grass
+earth_radius = 6371.01  # km
+astronomical_unit = 149597890.0  # km
+chunk_size = 4096  # Timestamps per vectorized chunk of the cell irradiance
+
+# Perez (1990) all sites composite coefficients, per clearness bin.
+perez_epsilon = np.array([1.065, 1.23, 1.5, 1.95, 2.8, 4.5, 6.2])
+perez_f1 = np.array(
+    [
+        [-0.0083117, 0.5877285, -0.0620636],
+        [0.1299457, 0.6825954, -0.1513752],
+        [0.3296958, 0.4868735, -0.2210958],
+        [0.5682053, 0.1874525, -0.2951290],
+        [0.8730280, -0.3920403, -0.3616149],
+        [1.1326077, -1.2367284, -0.4118494],
+        [1.0601591, -1.5999137, -0.3589221],
+        [0.6777470, -0.3272588, -0.2504286],
+    ]
+)
+perez_f2 = np.array(
+    [
+        [-0.0596012, 0.0721249, -0.0220216],
+        [-0.0189325, 0.0659650, -0.0288748],
+        [0.0554140, -0.0639588, -0.0260542],
+        [0.1088631, -0.1519229, -0.0139754],
+        [0.2255647, -0.4620442, 0.0012448],
+        [0.2877813, -0.8230357, 0.0558651],
+        [0.2642124, -1.1272340, 0.1310694],
+        [0.1561313, -1.3765031, 0.2506212],
+    ]
+)
+
+
+def get_unix_time(t):
+    """_summary_
+    Get seconds since 1970-01-01 UTC.
+
+    Args:
+        t (np.ndarray): UTC datetime64 or seconds since the epoch
+
+    Returns:
+        np.ndarray: Seconds since the epoch.
+    """
+    t = np.asarray(t)
+    if np.issubdtype(t.dtype, np.datetime64):
+        return (t - np.datetime64("1970-01-01T00:00:00")) / np.timedelta64(1, "s")
+    return t.astype(float)
+
+
+def get_solar_position(
+    t, latitude=latitude, longitude=longitude, pressure=1010.0, temperature=25.0
+):
+    """_summary_
+    Get the apparent solar zenith and azimuth with the PSA algorithm.
+
+    Args:
+        t (np.ndarray): UTC datetime64 or seconds since the epoch
+        latitude (float, optional): Latitude (deg). Defaults to latitude.
+        longitude (float, optional): Longitude, positive east (deg).
+            Defaults to longitude.
+        pressure (float, optional): Air pressure for the refraction (mbar).
+            Defaults to 1010.
+        temperature (float, optional): Air temperature for the refraction
+            (C). Defaults to 25.
+
+    Returns:
+        (np.ndarray, np.ndarray, np.ndarray): Zenith and azimuth, clockwise
+            from north (rad), and the sun distance (AU).
+    """
+    unix = get_unix_time(t)
+    n = unix / 86400 + (2440587.5 - 2451545.0)
+    hours = unix % 86400 / 3600
+
+    # Ecliptic coordinates.
+    omega = 2.1429 - 0.0010394594 * n
+    mean_longitude = 4.8950630 + 0.017202791698 * n
+    mean_anomaly = 6.2400600 + 0.0172019699 * n
+    sin_g = np.sin(mean_anomaly)
+    cos_g = np.cos(mean_anomaly)
+    ecliptic_longitude = (
+        mean_longitude
+        + 0.03341607 * sin_g
+        + 0.00034894 * 2 * sin_g * cos_g
+        - 0.0001134
+        - 0.0000203 * np.sin(omega)
+    )
+    obliquity = 0.4090928 - 6.2140e-9 * n + 0.0000396 * np.cos(omega)
+
+    # Celestial coordinates.
+    sin_lambda = np.sin(ecliptic_longitude)
+    right_ascension = np.arctan2(
+        np.cos(obliquity) * sin_lambda, np.cos(ecliptic_longitude)
+    )
+    sin_decl = np.sin(obliquity) * sin_lambda
+    cos_decl = np.sqrt(1 - sin_decl**2)
+
+    # Local coordinates.
+    sidereal = np.radians((6.6974243242 + 0.0657098283 * n + hours) * 15 + longitude)
+    hour_angle = sidereal - right_ascension
+    phi = np.radians(latitude)
+    cos_hour = np.cos(hour_angle)
+    zenith = np.arccos(
+        np.clip(
+            np.cos(phi) * cos_hour * cos_decl + sin_decl * np.sin(phi),
+            -1,
+            1,
+        )
+    )
+    azimuth = np.arctan2(
+        -np.sin(hour_angle) * cos_decl,
+        sin_decl * np.cos(phi) - np.sin(phi) * cos_hour * cos_decl,
+    ) % (2 * np.pi)
+    zenith = zenith + earth_radius / astronomical_unit * np.sin(zenith)
+
+    # Refraction of the NREL SPA, only with the sun near or above the
+    # horizon.
+    elevation = 90 - np.degrees(zenith)
+    refraction = (
+        pressure
+        / 1010
+        * 283
+        / (273 + temperature)
+        * 1.02
+        / (60 * np.tan(np.radians(elevation + 10.3 / (elevation + 5.11))))
+    )
+    zenith = zenith - np.radians(np.where(elevation >= -0.8333, refraction, 0.0))
+
+    distance = 1.00014 - 0.01671 * cos_g - 0.00014 * (1 - 2 * sin_g**2)
+    return (zenith, azimuth, distance)
+
+
+def get_extraterrestrial(distance):
+    """_summary_
+    Get the extraterrestrial normal irradiance, I_0 = S / R^2.
+
+    Args:
+        distance (np.ndarray): Sun distance (AU)
+
+    Returns:
+        np.ndarray: Irradiance (W/m^2).
+    """
+    return solar_constant / np.asarray(distance) ** 2
+
+
+def get_airmass(zenith):
+    """_summary_
+    Get the Kasten-Young relative airmass.
+
+    Args:
+        zenith (np.ndarray): Apparent zenith (rad)
+
+    Returns:
+        np.ndarray: Airmass, NaN below the horizon.
+    """
+    z = np.degrees(np.asarray(zenith))
+    with np.errstate(invalid="ignore"):
+        airmass = 1 / (np.cos(np.radians(z)) + 0.50572 * (96.07995 - z) ** -1.6364)
+    return np.where(z < 90, airmass, np.nan)
+
+
+def get_erbs_decomposition(ghi, zenith, i_0):
+    """_summary_
+    Split GHI into DNI and DHI with the Erbs diffuse fraction correlation on
+    the clearness index K_T = GHI / (I_0 cos Z).
+
+    Args:
+        ghi (np.ndarray): Global horizontal irradiance (W/m^2)
+        zenith (np.ndarray): Apparent zenith (rad)
+        i_0 (np.ndarray): Extraterrestrial normal irradiance (W/m^2)
+
+    Returns:
+        (np.ndarray, np.ndarray): DNI and DHI (W/m^2).
+    """
+    ghi = np.asarray(ghi, dtype=float)
+    cos_z = np.cos(zenith)
+    k_t = np.clip(ghi / (i_0 * np.maximum(cos_z, 0.065)), 0, 1)
+    k_d = np.where(
+        k_t <= 0.22,
+        1 - 0.09 * k_t,
+        np.where(
+            k_t <= 0.8,
+            0.9511 - 0.1604 * k_t + 4.388 * k_t**2 - 16.638 * k_t**3 + 12.336 * k_t**4,
+            0.165,
+        ),
+    )
+    dhi = k_d * ghi
+    # Close to the horizon the beam is all diffuse.
+    dni = np.where(cos_z > 0.065, (ghi - dhi) / np.maximum(cos_z, 0.065), 0.0)
+    return (dni, np.where(cos_z > 0.065, dhi, ghi))
+
+
+def load_weather(path, latitude=latitude, longitude=longitude):
+    """_summary_
+    Load a weather CSV with a header row. Columns are matched by name, case
+    insensitive: a UTC timestamp (ISO 8601, or seconds since the epoch)
+    named time or timestamp, and GHI, with DNI and DHI split from GHI when
+    they are missing.
+
+    Args:
+        path (str): CSV file
+        latitude (float, optional): Latitude (deg). Defaults to latitude.
+        longitude (float, optional): Longitude (deg). Defaults to longitude.
+
+    Returns:
+        dict: Arrays t (datetime64), ghi, dni, dhi (W/m^2).
+    """
+    data = np.genfromtxt(path, delimiter=",", names=True, dtype=None, encoding="utf-8")
+    columns = {name.lower(): name for name in data.dtype.names}
+    key = columns.get("time", columns.get("timestamp"))
+    if key is None or "ghi" not in columns:
+        raise ValueError(f"{path} needs a time or timestamp column and a GHI column")
+    raw = data[key]
+    if np.issubdtype(raw.dtype, np.number):
+        t = (raw * 1e6).astype("datetime64[us]")
+    else:
+        t = np.array([s.rstrip("Z") for s in raw], dtype="datetime64[us]")
+
+    weather = {"t": t, "ghi": data[columns["ghi"]].astype(float)}
+    if "dni" in columns and "dhi" in columns:
+        weather["dni"] = data[columns["dni"]].astype(float)
+        weather["dhi"] = data[columns["dhi"]].astype(float)
+    else:
+        zenith, _, distance = get_solar_position(t, latitude, longitude)
+        weather["dni"], weather["dhi"] = get_erbs_decomposition(
+            weather["ghi"], zenith, get_extraterrestrial(distance)
+        )
+    return weather
+
+
+def get_world_normals(normals, heading, pitch=0.0, roll=0.0):
+    """_summary_
+    Turn vehicle frame cell normals into the world frame.
+
+    Args:
+        normals (np.ndarray): Unit normals in the vehicle frame, (N, 3)
+        heading (np.ndarray): Heading, clockwise from north (rad), (T)
+        pitch (np.ndarray, optional): Nose up pitch (rad), (T). Defaults to 0.
+        roll (np.ndarray, optional): Left side up roll (rad), (T). Defaults
+            to 0.
+
+    Returns:
+        np.ndarray: Unit normals in the world frame, (T, N, 3).
+    """
+    heading = np.asarray(heading, dtype=float)
+    pitch = np.broadcast_to(pitch, heading.shape)[..., None]
+    roll = np.broadcast_to(roll, heading.shape)[..., None]
+    forward, left = get_vehicle_axes(heading)
+    up = np.broadcast_to(np.array([0, 0, 1.0]), forward.shape)
+    # Pitch about the left axis, then roll about the pitched forward axis.
+    forward, up = (
+        forward * np.cos(pitch) + up * np.sin(pitch),
+        up * np.cos(pitch) - forward * np.sin(pitch),
+    )
+    left, up = (
+        left * np.cos(roll) + up * np.sin(roll),
+        up * np.cos(roll) - left * np.sin(roll),
+    )
+    return (
+        normals[None, :, 0, None] * forward[:, None, :]
+        + normals[None, :, 1, None] * left[:, None, :]
+        + normals[None, :, 2, None] * up[:, None, :]
+    )
+
+
+def get_poa_irradiance(
+    normals,
+    zenith,
+    azimuth,
+    dni,
+    dhi,
+    ghi,
+    i_0,
+    model="perez",
+    lit=None,
+    albedo=albedo,
+):
+    """_summary_
+    Get the plane of array irradiance of every cell,
+        G = DNI max(cos T, 0) + G_SKY + GHI RHO (1 - cos B) / 2,
+    for the incidence angle T and tilt B of each cell. The beam and the
+    circumsolar part of G_SKY are dropped where LIT is false.
+
+    Args:
+        normals (np.ndarray): Unit normals in the world frame, (T, N, 3) or
+            (N, 3) for a fixed array
+        zenith (np.ndarray): Apparent zenith (rad), (T)
+        azimuth (np.ndarray): Azimuth, clockwise from north (rad), (T)
+        dni (np.ndarray): Direct normal irradiance (W/m^2), (T)
+        dhi (np.ndarray): Diffuse horizontal irradiance (W/m^2), (T)
+        ghi (np.ndarray): Global horizontal irradiance (W/m^2), (T)
+        i_0 (np.ndarray): Extraterrestrial normal irradiance (W/m^2), (T)
+        model (str, optional): "perez", "haydavies" or "isotropic". Defaults
+            to "perez".
+        lit (np.ndarray, optional): Whether the beam reaches each cell,
+            (T, N), see shading_model.get_cell_irradiance. Defaults to all.
+        albedo (float, optional): Ground reflectance. Defaults to albedo.
+
+    Returns:
+        np.ndarray: Irradiance (T, N) (W/m^2).
+    """
+    num_steps = len(zenith)
+    normals = np.asarray(normals)
+    g = np.zeros((num_steps, normals.shape[-2]))
+    for start in range(0, num_steps, chunk_size):
+        sl = slice(start, min(start + chunk_size, num_steps))
+        n = normals[sl] if normals.ndim == 3 else normals[None]
+        z = zenith[sl, None]
+        cos_z = np.cos(z)
+        up = cos_z > 0
+        sun = get_sun_direction(azimuth[sl], np.pi / 2 - zenith[sl])
+        cos_t = np.maximum(np.einsum("tnj,tj->tn", n, sun), 0) * up
+        cos_b = n[..., 2]
+        beam_mask = 1.0 if lit is None else lit[sl]
+        d_hi = dhi[sl, None]
+        isotropic = (1 + cos_b) / 2
+
+        if model == "isotropic":
+            sky = d_hi * isotropic
+            circumsolar = 0.0
+        elif model == "haydavies":
+            a_i = np.clip(dni[sl, None] / i_0[sl, None], 0, 1) * up
+            sky = d_hi * (1 - a_i) * isotropic
+            circumsolar = d_hi * a_i * cos_t / np.maximum(cos_z, np.cos(np.radians(85)))
+        elif model == "perez":
+            kappa = 1.041 * z**3
+            with np.errstate(divide="ignore", invalid="ignore"):
+                epsilon = ((d_hi + dni[sl, None]) / d_hi + kappa) / (1 + kappa)
+            epsilon = np.where(d_hi > 0, epsilon, 1.0)
+            delta = d_hi * np.nan_to_num(get_airmass(z)) / i_0[sl, None]
+            idx = np.searchsorted(perez_epsilon, epsilon, side="right")
+            f_1 = (
+                np.maximum(
+                    perez_f1[idx, 0] + perez_f1[idx, 1] * delta + perez_f1[idx, 2] * z,
+                    0,
+                )
+                * up
+            )
+            f_2 = (
+                perez_f2[idx, 0] + perez_f2[idx, 1] * delta + perez_f2[idx, 2] * z
+            ) * up
+            sin_b = np.sqrt(np.maximum(1 - cos_b**2, 0))
+            sky = d_hi * ((1 - f_1) * isotropic + f_2 * sin_b)
+            circumsolar = d_hi * f_1 * cos_t / np.maximum(cos_z, np.cos(np.radians(85)))
+        else:
+            raise ValueError(f"Unknown transposition model {model}")
+
+        g[sl] = (
+            (dni[sl, None] * cos_t + circumsolar) * beam_mask
+            + np.maximum(sky, 0)
+            + ghi[sl, None] * albedo * (1 - cos_b) / 2
+        )
+    return g
+
+
+def get_solar_position_map(t, zenith, azimuth, weather, g, window=60):
+    """_summary_
+    Plot the sun path, the weather and the plane of array irradiance.
+
+    Args:
+        t (np.ndarray): Timestamps, datetime64
+        zenith (np.ndarray): Apparent zenith (rad)
+        azimuth (np.ndarray): Azimuth (rad)
+        weather (dict): ghi, dni, dhi (W/m^2)
+        g (dict): Mean array irradiance per transposition model (W/m^2)
+        window (int, optional): Samples averaged per plotted point. Defaults
+            to 60.
+    """
+    num_points = len(t) // window
+
+    def block_mean(x):
+        return np.asarray(x)[: num_points * window].reshape(num_points, -1).mean(axis=1)
+
+    hours = block_mean((t - t[0]) / np.timedelta64(1, "h"))
+    weather = {name: block_mean(value) for name, value in weather.items()}
+    g = {name: block_mean(value) for name, value in g.items()}
+    fig, axs = plt.subplots(2, 2, figsize=(16, 12))
+    ax = axs[0, 0]
+    ax.plot(np.degrees(azimuth), 90 - np.degrees(zenith))
+    ax.set_xlabel("Azimuth (deg)")
+    ax.set_ylabel("Elevation (deg)")
+    ax.set_title("Sun path")
+    ax.grid(True)
+
+    ax = axs[0, 1]
+    for name in ["ghi", "dni", "dhi"]:
+        ax.plot(hours, weather[name], label=name.upper())
+    ax.set_xlabel("Time (h)")
+    ax.set_ylabel("Irradiance (W/m^2)")
+    ax.set_title("Weather")
+    ax.grid(True)
+    ax.legend()
+
+    ax = axs[1, 0]
+    for name, value in g.items():
+        ax.plot(hours, value, label=name)
+    ax.plot(hours, weather["ghi"], "k", label="GHI", alpha=0.5)
+    ax.set_xlabel("Time (h)")
+    ax.set_ylabel("Irradiance (W/m^2)")
+    ax.set_title(f"Mean array irradiance, {window} sample means")
+    ax.grid(True)
+    ax.legend()
+
+    ax = axs[1, 1]
+    for name, value in g.items():
+        if name != "Perez":
+            ax.plot(hours, value - g["Perez"], label=f"{name} - Perez")
+    ax.set_xlabel("Time (h)")
+    ax.set_ylabel("Irradiance (W/m^2)")
+    ax.set_title("Transposition model difference")
+    ax.grid(True)
+    ax.legend()
+
+    plt.savefig("solar_position_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    # NREL SPA reference case, 2003-10-17 12:30:30 MST at Golden, CO.
+    zenith, azimuth, _ = get_solar_position(
+        np.array(["2003-10-17T19:30:30"], dtype="datetime64[s]"),
+        39.742476,
+        -105.1786,
+        820.0,
+        11.0,
+    )
+    print(
+        f"NREL SPA case: zenith {np.degrees(zenith[0]):.4f} deg (50.1116), "
+        f"azimuth {np.degrees(azimuth[0]):.4f} deg (194.3402)"
+    )
+
+    # Throughput over a year at 1 s.
+    t_year = np.arange(
+        np.datetime64("2026-01-01T00:00:00"), np.datetime64("2027-01-01T00:00:00")
+    )
+    start = time.perf_counter()
+    for sl in range(0, len(t_year), 1 << 20):
+        get_solar_position(t_year[sl : sl + (1 << 20)])
+    elapsed = time.perf_counter() - start
+    print(f"Sun position: {len(t_year) / elapsed / 1e6:.1f} M timestamps/s")
+
+    # A race day, 09:00 to 17:00 CDT, with logged GHI synthesized from the
+    # clear sky index of the irradiance generator.
+    num_cells = 111
+    duration = 8 * 3600
+    t = np.datetime64("2026-06-21T14:00:00") + np.arange(duration).astype(
+        "timedelta64[s]"
+    )
+    zenith, azimuth, distance = get_solar_position(t)
+    i_0 = get_extraterrestrial(distance)
+    cos_z = np.maximum(np.cos(zenith), 0)
+    stream = stream_irradiance("temperate", seed=3, duration=duration, dt=1.0)
+    k = np.concatenate([chunk["k"] for chunk in stream])[:duration]
+    ghi = (
+        np.where(
+            cos_z > 1e-3, 1098 * cos_z * np.exp(-0.057 / np.maximum(cos_z, 1e-3)), 0
+        )
+        * k
+    )
+    dni, dhi = get_erbs_decomposition(ghi, zenith, i_0)
+    weather = {"ghi": ghi, "dni": dni, "dhi": dhi}
+
+    cells, normals = get_array_layout(num_cells)
+    route, boxes, spheres = get_example_route(duration=duration, dt=1.0)
+    # Gentle grades and road camber.
+    pitch = np.radians(2) * np.sin(2 * np.pi * route["t"] / 600)
+    roll = np.radians(1) * np.sin(2 * np.pi * route["t"] / 137)
+    world = get_world_normals(normals, route["heading"], pitch, roll)
+    _, lit = get_cell_irradiance(
+        cells,
+        normals,
+        route,
+        azimuth,
+        np.pi / 2 - zenith,
+        dni,
+        dhi,
+        boxes=boxes,
+        spheres=spheres,
+    )
+
+    g = {}
+    for name, model in [
+        ("Perez", "perez"),
+        ("Hay-Davies", "haydavies"),
+        ("Isotropic", "isotropic"),
+    ]:
+        start = time.perf_counter()
+        poa = get_poa_irradiance(world, zenith, azimuth, dni, dhi, ghi, i_0, model, lit)
+        elapsed = time.perf_counter() - start
+        g[name] = poa.mean(axis=1)
+        print(
+            f"{name:>10}: {poa.size / elapsed / 1e6:.1f} M cell timestamps/s, "
+            f"irradiation {poa.mean(axis=1).sum() / 3.6e6:.3f} kWh/m^2 "
+            f"({poa.sum() / ghi.sum() / num_cells * 100:.1f} % of GHI)"
+        )
+
+    get_solar_position_map(t, zenith, azimuth, weather, g)
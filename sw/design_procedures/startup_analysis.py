@@ -0,0 +1,430 @@
+"""_summary_
+@file       startup_analysis.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Start-up and pre-charge inrush analysis of the synchronous DC-DC
+            boost converter, and design of the soft-start duty ramp.
+
+            At t = 0 the pack contactor closes onto C_O through an optional
+            pre-charge resistor R_PRE, which is bypassed at T_PRE. The array
+            is already connected, so C_I starts at the array open circuit
+            voltage and, while V_OUT < V_IN, the inductor and the reverse
+            conduction of SW2 form an uncontrolled path from the array into
+            C_O.
+
+            The firmware holds both switches off for T_PRE + T_DELAY, so that
+            the pre-charge and the ring of C_I into C_O have settled. It then
+            samples V_IN and V_OUT, starts at the duty cycle that matches them,
+            D_0 = max(1 - V_IN / V_OUT, 0), and ramps at a fixed rate towards
+            the duty cycle of the array maximum power point. Starting at D_0
+            rather than 0 avoids forcing the input to the pack voltage.
+
+            Stress is computed with the averaged model of transient_analysis
+            over a grid of initial conditions (pack voltage, C_O state,
+            irradiance). The battery path is R_B and R_PRE only; harness
+            inductance would lower the contactor inrush peak but not its
+            energy.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+from design_procedures.converter_model import default_boost_design
+from design_procedures.firmware_export import write_c_header
+from design_procedures.nonideal_model import model_nonideal_cell_vec
+from design_procedures.transient_analysis import (
+    default_tvs,
+    get_averaged_operating_point,
+    r_sh,
+    step_averaged_boost,
+    v_ci_max,
+    v_sd,
+)
+
+# Pack voltage range, see docs/DESIGN.md.
+v_b_range = [80, 134.4]
+v_mpp = 0.621  # V, cell maximum power point
+i_mpp = 5.84  # A, cell maximum power point current
+# Inductor current overshoot over I_MPP allowed during the ramp. Matching D_0
+# to the measured voltages keeps even a duty step within the 1.25 I_SC the
+# inductor is sized for, so the limit is set by the ramp overshoot instead.
+ramp_overshoot = 0.1
+d_max = 0.9  # Maximum duty cycle of the ramp
+t_delay = 1e-3  # s, wait after the pre-charge bypass before switching
+
+
+def get_array_open_circuit(num_cells, g=1000, t=298.15):
+    """_summary_
+    Get the open circuit voltage of the array.
+
+    Args:
+        num_cells (int): Number of solar cells in series
+        g (float|np.ndarray, optional): Irradiance (W/m^2). Defaults to 1000.
+        t (float|np.ndarray, optional): Cell temperature (K). Defaults to
+            298.15.
+
+    Returns:
+        np.ndarray: Open circuit voltage.
+    """
+    v = np.full(np.broadcast(np.asarray(g), np.asarray(t)).shape, 0.7)
+    for _ in range(30):
+        i, g_d = model_nonideal_cell_vec(g, t, 0, r_sh, v)
+        v = v + i / g_d
+    return v * num_cells
+
+
+def get_duty_ramp(duty_0, duty_final, step):
+    """_summary_
+    Get the soft-start duty cycle after ramping a given distance.
+
+    Args:
+        duty_0 (np.ndarray): Start of the ramp
+        duty_final (np.ndarray): End of the ramp
+        step (np.ndarray): Distance ramped so far
+
+    Returns:
+        (np.ndarray, np.ndarray): Duty cycle, and whether the ramp has reached
+            its end. The latter compares the distance rather than the duty
+            with its end, which rounding may never reach exactly.
+    """
+    duty = duty_0 + np.clip(duty_final - duty_0, -step, step)
+    return (duty, step >= np.abs(duty_final - duty_0))
+
+
+def simulate_startup_batch(
+    design,
+    v_b,
+    v_co_0,
+    g,
+    r_pre,
+    ramp_rate,
+    num_cells,
+    t=298.15,
+    t_pre=None,
+    t_end=None,
+    dt=2e-6,
+):
+    """_summary_
+    Simulate a batch of start-ups. Every per-scenario argument is broadcast
+    against the others.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_b (float|np.ndarray): Pack voltage
+        v_co_0 (float|np.ndarray): Initial output capacitor voltage
+        g (float|np.ndarray): Irradiance (W/m^2)
+        r_pre (float|np.ndarray): Pre-charge resistance, 0 for none
+        ramp_rate (float|np.ndarray): Soft-start duty ramp rate (1/s)
+        num_cells (int): Number of solar cells in series
+        t (float|np.ndarray, optional): Cell temperature (K). Defaults to
+            298.15.
+        t_pre (float|np.ndarray, optional): Pre-charge bypass time. Defaults
+            to 5 R_PRE C_O.
+        t_end (float, optional): Simulated time. Defaults to the end of the
+            slowest ramp plus 2 ms.
+        dt (float, optional): Step. Defaults to 2e-6.
+
+    Returns:
+        dict: Arrays of the broadcast shape:
+            i_b_pk - peak pack (contactor) current
+            e_pre - energy dissipated in R_PRE
+            i_l_pk, i_l_min - peak and minimum inductor current
+            i_l_ramp_pk - peak absolute inductor current once switching
+            i_sw2_pk - peak SW2 current, including reverse conduction
+            e_sw2_rev - energy dissipated in SW2 reverse conduction
+            i_co_pk - peak absolute C_O current
+            v_in_pk, v_out_pk - peak capacitor voltages
+            t_start - time switching starts
+            t_ready - time the ramp reaches the maximum power point duty
+            duty_0, duty_final - start and end of the ramp
+    """
+    args = np.broadcast_arrays(
+        *[np.asarray(a, dtype=float) for a in (v_b, v_co_0, g, r_pre, ramp_rate, t)]
+    )
+    shape = args[0].shape
+    v_b, v_co_0, g, r_pre, ramp_rate, t = [a.ravel() for a in args]
+    c_o, r_b = design["c_o"], design["r_b"]
+    t_pre = 5 * r_pre * c_o if t_pre is None else np.broadcast_to(t_pre, shape).ravel()
+
+    # Ramp target: the averaged steady state at the array maximum power point.
+    _, duty_final, _ = get_averaged_operating_point(
+        design, v_mpp * num_cells, v_b, num_cells, g, t
+    )
+    duty_final = np.clip(duty_final, 0, d_max)
+    v_ci = get_array_open_circuit(num_cells, g, t)
+    if t_end is None:
+        t_end = t_pre.max() + t_delay + duty_final.max() / ramp_rate.min() + 2e-3
+
+    i_l = np.zeros_like(v_b)
+    v_co = v_co_0.copy()
+    zero = np.zeros_like(v_b)
+    v_br = np.full_like(v_b, default_tvs["v_br"])
+    r_tvs = np.full_like(v_b, default_tvs["r_tvs"])
+
+    started = np.zeros(v_b.shape, dtype=bool)
+    t_start = np.full_like(v_b, np.nan)
+    t_ready = np.full_like(v_b, np.nan)
+    duty_0 = np.zeros_like(v_b)
+
+    i_b_pk, e_pre = zero.copy(), zero.copy()
+    i_l_pk, i_l_min, i_l_ramp_pk = zero.copy(), zero.copy(), zero.copy()
+    i_sw2_pk, e_sw2_rev, i_co_pk = zero.copy(), zero.copy(), zero.copy()
+    v_in_pk, v_out_pk = v_ci.copy(), v_co.copy()
+
+    for k in range(int(round(t_end / dt))):
+        t_k = k * dt
+        precharge = t_k < t_pre
+        g_b = 1 / (r_b + np.where(precharge, r_pre, 0))
+
+        # Firmware start condition and duty ramp.
+        newly = ~started & (t_k >= t_pre + t_delay)
+        duty_0 = np.where(
+            newly, np.clip(1 - v_ci / np.maximum(v_co, 1), 0, d_max), duty_0
+        )
+        t_start = np.where(newly, t_k, t_start)
+        started |= newly
+        step = ramp_rate * (t_k - np.nan_to_num(t_start))
+        duty, reached = get_duty_ramp(duty_0, duty_final, step)
+        t_ready = np.where(started & np.isnan(t_ready) & reached, t_k, t_ready)
+
+        # Pack current before the (implicit) step catches the closing edge.
+        i_b = g_b * (v_b - v_co)
+        np.maximum(i_b_pk, np.abs(i_b), out=i_b_pk)
+        e_pre += np.where(precharge, i_b**2 * r_pre, 0) * dt
+
+        i_l, v_ci, v_co, i_x, _ = step_averaged_boost(
+            design,
+            (i_l, v_ci, v_co),
+            duty,
+            started,
+            g_b,
+            v_b,
+            1.0,
+            zero,
+            v_br,
+            r_tvs,
+            g,
+            t,
+            num_cells,
+            dt,
+        )
+
+        rev = ~started & (i_l > 0)
+        e_sw2_rev += np.where(rev, v_sd * i_l, 0) * dt
+        np.maximum(i_l_pk, i_l, out=i_l_pk)
+        np.minimum(i_l_min, i_l, out=i_l_min)
+        np.maximum(i_l_ramp_pk, np.where(started, np.abs(i_l), 0), out=i_l_ramp_pk)
+        np.maximum(i_sw2_pk, np.where(started | rev, np.abs(i_l), 0), out=i_sw2_pk)
+        np.maximum(i_co_pk, np.abs(i_x + g_b * (v_b - v_co)), out=i_co_pk)
+        np.maximum(v_in_pk, v_ci, out=v_in_pk)
+        np.maximum(v_out_pk, v_co, out=v_out_pk)
+
+    results = {
+        "i_b_pk": i_b_pk,
+        "e_pre": e_pre,
+        "i_l_pk": i_l_pk,
+        "i_l_min": i_l_min,
+        "i_l_ramp_pk": i_l_ramp_pk,
+        "i_sw2_pk": i_sw2_pk,
+        "e_sw2_rev": e_sw2_rev,
+        "i_co_pk": i_co_pk,
+        "v_in_pk": v_in_pk,
+        "v_out_pk": v_out_pk,
+        "t_start": t_start,
+        "t_ready": t_ready,
+        "duty_0": duty_0,
+        "duty_final": duty_final,
+    }
+    return {key: val.reshape(shape) for key, val in results.items()}
+
+
+def design_soft_start(
+    design,
+    v_b_range,
+    v_co_0_range,
+    g_range,
+    r_pre_range,
+    ramp_rate_range,
+    num_cells,
+    i_l_max,
+    i_b_max,
+):
+    """_summary_
+    Pick the pre-charge resistor and soft-start ramp rate over a grid of
+    initial conditions.
+
+    The smallest R_PRE that keeps the contactor inrush under I_B_MAX is
+    chosen first (the slowest pre-charge is the one the pack waits on), then
+    the fastest ramp rate that keeps the inductor current under I_L_MAX and
+    V_IN under the C_I rating for every initial condition.
+
+    Args:
+        design (dict): Converter design, see default_boost_design
+        v_b_range ([float]): Pack voltages
+        v_co_0_range ([float]): Initial C_O voltages, as a fraction of V_B
+        g_range ([float]): Irradiances (W/m^2)
+        r_pre_range ([float]): Candidate pre-charge resistances, ascending
+        ramp_rate_range ([float]): Candidate ramp rates (1/s), ascending
+        num_cells (int): Number of solar cells in series
+        i_l_max (float): Maximum inductor (and switch) current
+        i_b_max (float): Maximum contactor inrush current
+
+    Returns:
+        (dict, dict): Soft-start parameters (None where no candidate meets
+            the limits) and the results, with shape (V_B, V_CO_0, G, R_PRE,
+            RAMP_RATE).
+    """
+    if (np.diff(r_pre_range) <= 0).any() or (np.diff(ramp_rate_range) <= 0).any():
+        raise Exception("R_PRE and ramp rate candidates must be ascending.")
+
+    v_b = np.asarray(v_b_range, dtype=float)[:, None, None, None, None]
+    v_co_0 = v_b * np.asarray(v_co_0_range)[None, :, None, None, None]
+    g = np.asarray(g_range, dtype=float)[None, None, :, None, None]
+    r_pre = np.asarray(r_pre_range, dtype=float)[None, None, None, :, None]
+    ramp_rate = np.asarray(ramp_rate_range, dtype=float)[None, None, None, None, :]
+
+    results = simulate_startup_batch(
+        design, v_b, v_co_0, g, r_pre, ramp_rate, num_cells
+    )
+
+    # Worst case over the initial conditions.
+    worst = {key: np.nanmax(val, axis=(0, 1, 2)) for key, val in results.items()}
+    ok_pre = worst["i_b_pk"].max(axis=-1) <= i_b_max
+    params = {"r_pre": None, "t_pre": None, "ramp_rate": None}
+    if ok_pre.any():
+        idx_pre = int(np.argmax(ok_pre))
+        params["r_pre"] = float(r_pre_range[idx_pre])
+        params["t_pre"] = 5 * params["r_pre"] * design["c_o"]
+        params["e_pre"] = float(worst["e_pre"][idx_pre].max())
+
+        ok_rate = (worst["i_l_ramp_pk"][idx_pre] <= i_l_max) & (
+            worst["v_in_pk"][idx_pre] <= v_ci_max
+        )
+        if ok_rate.any():
+            idx_rate = int(np.nonzero(ok_rate)[0].max())
+            params["ramp_rate"] = float(ramp_rate_range[idx_rate])
+            params["t_ready"] = float(worst["t_ready"][idx_pre, idx_rate])
+            params["i_l_pk"] = float(worst["i_l_ramp_pk"][idx_pre, idx_rate])
+
+    return (params, results)
+
+
+def get_startup_map(results, r_pre_range, ramp_rate_range, i_l_max, i_b_max):
+    """_summary_
+    Plot the worst case start-up stress against the pre-charge resistance and
+    ramp rate.
+
+    Args:
+        results (dict): See design_soft_start
+        r_pre_range ([float]): Pre-charge resistances
+        ramp_rate_range ([float]): Ramp rates (1/s)
+        i_l_max (float): Maximum inductor current
+        i_b_max (float): Maximum contactor inrush current
+    """
+    worst = {key: np.nanmax(val, axis=(0, 1, 2)) for key, val in results.items()}
+
+    fig, axs = plt.subplots(1, 3, figsize=(18, 5))
+    fig.suptitle("Worst case start-up stress over initial conditions")
+    axs[0].loglog(np.maximum(r_pre_range, 0.1), worst["i_b_pk"].max(axis=-1), "o-")
+    axs[0].axhline(i_b_max, color="r", linestyle="--")
+    axs[0].set_xlabel("R_PRE (Ohm), 0 plotted at 0.1")
+    axs[0].set_ylabel("Peak contactor current (A)")
+    axs[0].grid(True, which="both")
+
+    for idx, r_pre in enumerate(r_pre_range):
+        axs[1].semilogx(
+            ramp_rate_range, worst["i_l_ramp_pk"][idx], label=f"R_PRE={r_pre}"
+        )
+        axs[2].semilogx(ramp_rate_range, worst["t_ready"][idx] * 1e3)
+    axs[1].axhline(i_l_max, color="r", linestyle="--")
+    axs[1].set_xlabel("Ramp rate (1/s)")
+    axs[1].set_ylabel("Peak |I_L| while switching (A)")
+    axs[1].legend()
+    axs[1].grid(True, which="both")
+    axs[2].set_xlabel("Ramp rate (1/s)")
+    axs[2].set_ylabel("Time to MPP duty (ms)")
+    axs[2].grid(True, which="both")
+    fig.tight_layout()
+    plt.savefig("startup_map.png")
+    plt.show()
+
+
+def export_soft_start(params, path=None):
+    """_summary_
+    Write the soft-start parameters to fw/include/soft_start.h.
+
+    Args:
+        params (dict): See design_soft_start
+        path (str, optional): Output directory. Defaults to fw/include.
+
+    Returns:
+        str: Path of the written header.
+    """
+    constants = [
+        ("SOFT_START_RAMP_RATE", params["ramp_rate"], "Duty cycle per second"),
+        ("SOFT_START_D_MAX", d_max, "Maximum duty cycle"),
+        ("SOFT_START_DELAY", params["t_pre"] + t_delay, "s, after contactor close"),
+    ]
+    return write_c_header(
+        "soft_start.h",
+        "Soft-start duty ramp, see sw/design_procedures/startup_analysis.py.",
+        constants,
+        path=path,
+    )
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    num_cells = 111
+    design = dict(default_boost_design)
+
+    v_b = [80, 107, 134.4]
+    v_co_0 = [0.0, 0.5, 0.95]
+    g = [100, 1000]
+    r_pre_range = [0, 10, 22, 47, 100]
+    ramp_rate_range = np.logspace(1.5, 4.5, 7)
+    i_l_max = (1 + ramp_overshoot) * i_mpp
+    i_b_max = 20  # A, contactor inrush
+
+    start = time.perf_counter()
+    params, results = design_soft_start(
+        design,
+        v_b,
+        v_co_0,
+        g,
+        r_pre_range,
+        ramp_rate_range,
+        num_cells,
+        i_l_max,
+        i_b_max,
+    )
+    elapsed = time.perf_counter() - start
+    print(f"{results['i_b_pk'].size} start-ups in {elapsed:.2f} s")
+    print(
+        f"Without pre-charge: contactor {results['i_b_pk'][..., 0, :].max():.0f} A, "
+        f"SW2 reverse conduction {results['i_sw2_pk'][..., 0, :].max():.1f} A"
+    )
+    if params["r_pre"] is not None:
+        idx = r_pre_range.index(params["r_pre"])
+        print(
+            f"With R_PRE={params['r_pre']} Ohm: "
+            f"C_I into C_O through SW2 {results['i_sw2_pk'][..., idx, :].max():.1f} A, "
+            f"{results['e_sw2_rev'][..., idx, :].max() * 1e3:.1f} mJ"
+        )
+
+    get_startup_map(results, r_pre_range, ramp_rate_range, i_l_max, i_b_max)
+    if params["ramp_rate"] is not None:
+        print(f"Wrote {export_soft_start(params)}")
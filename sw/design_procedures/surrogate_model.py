@@ -0,0 +1,477 @@
+"""_summary_
+@file       surrogate_model.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Gaussian process surrogates of expensive evaluators, with active
+            learning.
+
+            An evaluator maps a design point x in a box of bounds to a scalar,
+            and may take from milliseconds (the enclosure thermal network with
+            its electrothermal passes) to minutes (a tracker simulation, a
+            bench sweep, or an external circuit or field solver). The
+            surrogate is a Gaussian process on the unit cube with an
+            anisotropic Matern 5/2 kernel,
+                K(x, x') = S^2 (1 + sqrt(5) r + 5 r^2 / 3) exp(-sqrt(5) r),
+                r^2 = sum((x_k - x'_k)^2 / L_k^2),
+            and a noise variance N^2. S, L and N are fit by maximizing the log
+            marginal likelihood of the standardized outputs, from a few
+            starts. The prediction returns the mean and standard deviation,
+            so every answer carries its uncertainty.
+
+            Training starts from a scrambled Sobol design and then learns
+            actively. The next points are those of a candidate set with the
+            largest predictive standard deviation. A batch is picked one
+            point at a time; the posterior variance does not depend on the
+            outputs, so it is conditioned on the points already picked
+            without evaluating them.
+
+            Surrogate.query answers from the surrogate while its standard
+            deviation is below a tolerance and escalates to the evaluator
+            otherwise, keeping the new run as training data.
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import sys
+import time
+
+import matplotlib.pyplot as plt
+import numpy as np
+from scipy.linalg import cho_factor, cho_solve, solve_triangular
+from scipy.optimize import minimize
+from scipy.stats import qmc
+
+from design_procedures.converter_model import default_boost_design
+from design_procedures.enclosure_thermal import (
+    get_critical_component,
+    get_enclosure_temperatures,
+)
+from design_procedures.mppt_tuning import get_array_mpp
+
+num_starts = 4  # Hyperparameter fit starts
+jitter = 1e-8  # Relative diagonal added for conditioning
+noise_min = 1e-6  # Lowest noise standard deviation, of the standardized output
+
+
+def get_matern_kernel(a, b, length):
+    """_summary_
+    Get the Matern 5/2 correlation between two sets of points.
+
+    Args:
+        a (np.ndarray): (N, D) points on the unit cube
+        b (np.ndarray): (M, D) points on the unit cube
+        length (np.ndarray): (D,) length scales
+
+    Returns:
+        np.ndarray: (N, M) correlation.
+    """
+    d = (a[:, None, :] - b[None, :, :]) / length
+    r = np.sqrt(5 * np.sum(d**2, axis=-1))
+    return (1 + r + r**2 / 3) * np.exp(-r)
+
+
+class GaussianProcess:
+    """_summary_
+    Gaussian process regression of a scalar on the unit cube, with the
+    hyperparameters fit to the data.
+    """
+
+    def __init__(self, x, y):
+        """_summary_
+        Fit a Gaussian process.
+
+        Args:
+            x (np.ndarray): (N, D) inputs on the unit cube
+            y (np.ndarray): (N,) outputs
+        """
+        self.x = np.asarray(x, dtype=float)
+        y = np.asarray(y, dtype=float)
+        self.y_mean = y.mean()
+        self.y_std = max(y.std(), 1e-12)
+        self.z = (y - self.y_mean) / self.y_std
+        self.fit()
+
+    def get_log_likelihood(self, theta):
+        """_summary_
+        Get the negative log marginal likelihood of the standardized outputs.
+
+        Args:
+            theta (np.ndarray): log S, log L (D), log N
+
+        Returns:
+            float: Negative log marginal likelihood.
+        """
+        dim = self.x.shape[1]
+        s_2, length = np.exp(2 * theta[0]), np.exp(theta[1 : 1 + dim])
+        n_2 = np.exp(2 * theta[-1]) + noise_min**2
+        k = s_2 * get_matern_kernel(self.x, self.x, length)
+        k[np.diag_indices_from(k)] += n_2 + jitter * s_2
+        try:
+            chol, lower = cho_factor(k, lower=True)
+        except np.linalg.LinAlgError:
+            return 1e10
+        alpha = cho_solve((chol, lower), self.z)
+        return (
+            0.5 * self.z @ alpha
+            + np.sum(np.log(np.diag(chol)))
+            + 0.5 * len(self.z) * np.log(2 * np.pi)
+        )
+
+    def fit(self, seed=0):
+        """_summary_
+        Fit S, L and N by maximizing the log marginal likelihood from a few
+        starts, and factor the covariance.
+
+        Args:
+            seed (int, optional): Random seed of the starts. Defaults to 0.
+        """
+        rng = np.random.default_rng(seed)
+        dim = self.x.shape[1]
+        bounds = [(np.log(0.1), np.log(10.0))]
+        bounds += [(np.log(0.02), np.log(20.0))] * dim
+        bounds += [(np.log(noise_min), np.log(0.5))]
+        best = None
+        for k in range(num_starts):
+            if k == 0:
+                start = np.concatenate([[0.0], np.full(dim, np.log(0.3)), [-7.0]])
+            else:
+                start = np.array([rng.uniform(lo, hi) for lo, hi in bounds])
+            result = minimize(
+                self.get_log_likelihood, start, method="L-BFGS-B", bounds=bounds
+            )
+            if best is None or result.fun < best.fun:
+                best = result
+
+        self.theta = best.x
+        self.s_2 = np.exp(2 * best.x[0])
+        self.length = np.exp(best.x[1 : 1 + dim])
+        self.n_2 = np.exp(2 * best.x[-1]) + noise_min**2
+        k = self.s_2 * get_matern_kernel(self.x, self.x, self.length)
+        k[np.diag_indices_from(k)] += self.n_2 + jitter * self.s_2
+        self.chol = np.linalg.cholesky(k)
+        self.alpha = cho_solve((self.chol, True), self.z)
+
+    def predict(self, x):
+        """_summary_
+        Get the posterior mean and standard deviation.
+
+        Args:
+            x (np.ndarray): (M, D) inputs on the unit cube
+
+        Returns:
+            (np.ndarray, np.ndarray): (M,) mean and standard deviation of the
+                latent function, in output units.
+        """
+        k_s = self.s_2 * get_matern_kernel(np.atleast_2d(x), self.x, self.length)
+        v = solve_triangular(self.chol, k_s.T, lower=True)
+        var = np.maximum(self.s_2 - np.sum(v**2, axis=0), 0)
+        return self.y_mean + self.y_std * (k_s @ self.alpha), self.y_std * np.sqrt(var)
+
+    def get_batch(self, candidates, num):
+        """_summary_
+        Pick the candidates of largest predictive standard deviation one at
+        a time, conditioning the variance on every point already picked.
+
+        Args:
+            candidates (np.ndarray): (M, D) candidates on the unit cube
+            num (int): Number of points
+
+        Returns:
+            np.ndarray: Indices into candidates.
+        """
+        x = self.x
+        chol = self.chol
+        picked = []
+        for _ in range(num):
+            k_s = self.s_2 * get_matern_kernel(candidates, x, self.length)
+            v = solve_triangular(chol, k_s.T, lower=True)
+            var = self.s_2 - np.sum(v**2, axis=0)
+            var[picked] = -np.inf
+            k = int(np.argmax(var))
+            picked.append(k)
+
+            # Extend the Cholesky factor by the picked point.
+            x_new = candidates[k : k + 1]
+            c = v[:, k]
+            d = np.sqrt(max(self.s_2 + self.n_2 + jitter * self.s_2 - c @ c, 1e-12))
+            chol = np.block(
+                [[chol, np.zeros((len(c), 1))], [c[None, :], np.full((1, 1), d)]]
+            )
+            x = np.vstack([x, x_new])
+        return np.array(picked)
+
+
+class Surrogate:
+    """_summary_
+    Surrogate of an evaluator over a box of bounds, trained by active
+    learning and queried with escalation to the evaluator.
+    """
+
+    def __init__(self, evaluator, bounds, names=None, seed=0):
+        """_summary_
+        Create an untrained surrogate.
+
+        Args:
+            evaluator (func): f(x) for one point x (D,) in the bounds,
+                returning a float
+            bounds (np.ndarray): (D, 2) lower and upper bound of every input
+            names ([str], optional): Input names. Defaults to x0, x1, ...
+            seed (int, optional): Random seed of the designs. Defaults to 0.
+        """
+        self.evaluator = evaluator
+        self.bounds = np.asarray(bounds, dtype=float)
+        self.names = names or [f"x{k}" for k in range(len(self.bounds))]
+        self.rng = np.random.default_rng(seed)
+        self.sobol = qmc.Sobol(len(self.bounds), seed=seed)
+        self.u = np.zeros((0, len(self.bounds)))
+        self.y = np.zeros(0)
+        self.t_eval = 0.0
+        self.gp = None
+        self.history = []
+
+    def to_unit(self, x):
+        """_summary_
+        Map points in the bounds to the unit cube.
+        """
+        return (np.asarray(x, dtype=float) - self.bounds[:, 0]) / np.ptp(
+            self.bounds, axis=1
+        )
+
+    def from_unit(self, u):
+        """_summary_
+        Map points on the unit cube to the bounds.
+        """
+        return self.bounds[:, 0] + np.asarray(u) * np.ptp(self.bounds, axis=1)
+
+    def evaluate(self, u):
+        """_summary_
+        Run the evaluator on points of the unit cube and keep the results.
+
+        Args:
+            u (np.ndarray): (N, D) points on the unit cube
+
+        Returns:
+            np.ndarray: (N,) results.
+        """
+        start = time.perf_counter()
+        y = np.array([self.evaluator(x) for x in self.from_unit(u)], dtype=float)
+        self.t_eval += time.perf_counter() - start
+        self.u = np.vstack([self.u, u])
+        self.y = np.concatenate([self.y, y])
+        return y
+
+    def train(self, num_initial, num_total, batch=4, num_candidates=2048, test=None):
+        """_summary_
+        Train on a Sobol design, then add batches of the most uncertain
+        candidates until num_total evaluations.
+
+        Args:
+            num_initial (int): Size of the initial design
+            num_total (int): Evaluation budget
+            batch (int, optional): Points per active learning round. Defaults
+                to 4.
+            num_candidates (int, optional): Random candidates per round.
+                Defaults to 2048.
+            test ((np.ndarray, np.ndarray), optional): Held out points (in the
+                bounds) and results to score every round. Defaults to None.
+
+        Returns:
+            list: Per round a dict of "n", "max_std" over the candidates and,
+                with test, "rmse" and "coverage" of the 95 % interval.
+        """
+        self.evaluate(self.sobol.random(num_initial))
+        while True:
+            self.gp = GaussianProcess(self.u, self.y)
+            candidates = self.rng.random((num_candidates, len(self.bounds)))
+            _, std = self.gp.predict(candidates)
+            record = {"n": len(self.y), "max_std": std.max()}
+            if test is not None:
+                record.update(self.score(*test))
+            self.history.append(record)
+            if len(self.y) >= num_total:
+                return self.history
+            num = min(batch, num_total - len(self.y))
+            self.evaluate(candidates[self.gp.get_batch(candidates, num)])
+
+    def predict(self, x):
+        """_summary_
+        Get the surrogate mean and standard deviation at points in the bounds.
+
+        Args:
+            x (np.ndarray): (M, D) or (D,) points
+
+        Returns:
+            (np.ndarray, np.ndarray): Mean and standard deviation.
+        """
+        return self.gp.predict(np.atleast_2d(self.to_unit(x)))
+
+    def score(self, x, y):
+        """_summary_
+        Score the surrogate against held out results.
+
+        Args:
+            x (np.ndarray): (M, D) points
+            y (np.ndarray): (M,) results
+
+        Returns:
+            dict: "rmse" and "coverage", the share of results within the 95 %
+                interval.
+        """
+        mean, std = self.predict(x)
+        std = np.sqrt(std**2 + self.gp.n_2 * self.gp.y_std**2)
+        return {
+            "rmse": np.sqrt(np.mean((mean - y) ** 2)),
+            "coverage": np.mean(np.abs(mean - y) <= 1.96 * std),
+        }
+
+    def query(self, x, tol, refit=True):
+        """_summary_
+        Answer from the surrogate if its standard deviation is within tol,
+        otherwise run the evaluator and learn from it.
+
+        Args:
+            x (np.ndarray): (D,) point
+            tol (float): Largest acceptable standard deviation
+            refit (bool, optional): Refit the surrogate after an escalation.
+                Defaults to True.
+
+        Returns:
+            (float, float, bool): Value, its standard deviation (0 when
+                evaluated), and whether the evaluator ran.
+        """
+        mean, std = self.predict(x)
+        if std[0] <= tol:
+            return mean[0], std[0], False
+        y = self.evaluate(self.to_unit(x)[None, :])[0]
+        if refit:
+            self.gp = GaussianProcess(self.u, self.y)
+        return y, 0.0, True
+
+
+def get_enclosure_evaluator():
+    """_summary_
+    Get an example evaluator: the hottest component margin to its limit of
+    the enclosure thermal network, at the array MPP, one point per call.
+
+    Returns:
+        (func, np.ndarray, [str]): Evaluator of (F_SW (kHz), T_AMB (C), V_CAR
+            (m/s), G (W/m^2)), its bounds and input names.
+    """
+
+    def evaluator(x):
+        f_sw, t_amb, v_car, g = x
+        v_mpp, p_mpp = get_array_mpp(111, np.array([g]))
+        t, _ = get_enclosure_temperatures(
+            default_boost_design,
+            v_mpp,
+            p_mpp / v_mpp,
+            105.0,
+            f_sw * 1e3,
+            t_amb,
+            v_car,
+        )
+        return float(get_critical_component(t)[1][0])
+
+    bounds = np.array([[50.0, 300.0], [20.0, 80.0], [0.0, 25.0], [100.0, 1000.0]])
+    return evaluator, bounds, ["F_SW (kHz)", "T_AMB (C)", "V_CAR (m/s)", "G (W/m^2)"]
+
+
+def get_surrogate_map(surrogate, history, x_test, y_test):
+    """_summary_
+    Plot the learning curve, the surrogate against held out runs, and a
+    slice of the mean and standard deviation over the first two inputs.
+
+    Args:
+        surrogate (Surrogate): Trained surrogate
+        history (list): Learning curve, see Surrogate.train
+        x_test (np.ndarray): Held out points
+        y_test (np.ndarray): Held out results
+    """
+    fig, axs = plt.subplots(1, 4, figsize=(22, 5.5))
+    n = [h["n"] for h in history]
+    axs[0].semilogy(n, [h["rmse"] for h in history], label="Held out RMSE")
+    axs[0].semilogy(n, [h["max_std"] for h in history], label="Max predicted std")
+    axs[0].set_title("Active learning")
+    axs[0].set_xlabel("Evaluator runs")
+    axs[0].legend()
+    axs[0].grid(which="both")
+
+    mean, std = surrogate.predict(x_test)
+    axs[1].errorbar(y_test, mean, yerr=1.96 * std, fmt=".", ms=3, alpha=0.6)
+    lim = [y_test.min(), y_test.max()]
+    axs[1].plot(lim, lim, "k--")
+    axs[1].set_title("Surrogate vs evaluator, 95 % interval")
+    axs[1].set_xlabel("Evaluator")
+    axs[1].set_ylabel("Surrogate")
+    axs[1].grid()
+
+    # Slice over the first two inputs, the others at their midpoint.
+    a, b = np.meshgrid(np.linspace(0, 1, 60), np.linspace(0, 1, 60))
+    u = np.full((a.size, len(surrogate.bounds)), 0.5)
+    u[:, 0], u[:, 1] = a.ravel(), b.ravel()
+    mean, std = surrogate.gp.predict(u)
+    x = surrogate.from_unit(u)
+    for ax, z, title in ((axs[2], mean, "Mean"), (axs[3], std, "Std")):
+        mesh = ax.pcolormesh(
+            x[:, 0].reshape(a.shape), x[:, 1].reshape(a.shape), z.reshape(a.shape)
+        )
+        fig.colorbar(mesh, ax=ax)
+        ax.set_title(f"{title}, other inputs at mid range")
+        ax.set_xlabel(surrogate.names[0])
+        ax.set_ylabel(surrogate.names[1])
+    x_train = surrogate.from_unit(surrogate.u)
+    axs[3].scatter(x_train[:, 0], x_train[:, 1], c="w", s=6)
+
+    fig.tight_layout()
+    plt.savefig("surrogate_map.png")
+    plt.show()
+
+
+if __name__ == "__main__":
+    if sys.version_info[0] < 3:
+        raise Exception("This program only supports Python 3.")
+
+    try:
+        import pretty_traceback
+
+        pretty_traceback.install()
+    except ImportError:
+        pass  # no need to fail because of missing dev dependency
+
+    evaluator, bounds, names = get_enclosure_evaluator()
+    surrogate = Surrogate(evaluator, bounds, names)
+
+    rng = np.random.default_rng(1)
+    x_test = bounds[:, 0] + rng.random((200, len(bounds))) * np.ptp(bounds, axis=1)
+    start = time.perf_counter()
+    y_test = np.array([evaluator(x) for x in x_test])
+    t_run = (time.perf_counter() - start) / len(x_test)
+
+    start = time.perf_counter()
+    history = surrogate.train(16, 80, batch=8, test=(x_test, y_test))
+    elapsed = time.perf_counter() - start
+    for h in history:
+        print(
+            f"{h['n'] :4d} runs: RMSE {h['rmse'] :.3f} C, max std "
+            f"{h['max_std'] :.3f} C, 95 % coverage {h['coverage'] * 100 :.0f} %"
+        )
+    print(
+        f"Trained in {elapsed :.1f} s, {surrogate.t_eval :.1f} s of it in the "
+        f"evaluator"
+    )
+
+    start = time.perf_counter()
+    for x in x_test:
+        surrogate.predict(x)
+    t_query = (time.perf_counter() - start) / len(x_test)
+    print(
+        f"Evaluator {t_run * 1e3 :.2f} ms per point, surrogate query "
+        f"{t_query * 1e6 :.0f} us"
+    )
+
+    # Escalate whenever the surrogate is less sure than 0.25 C.
+    escalated = 0
+    for x in bounds[:, 0] + rng.random((200, len(bounds))) * np.ptp(bounds, axis=1):
+        escalated += surrogate.query(x, 0.25, refit=False)[2]
+    print(f"{escalated} of 200 new queries escalated to the evaluator at 0.25 C")
+
+    get_surrogate_map(surrogate, history, x_test, y_test)
@@ -11,6 +11,31 @@ import math as m
 import matplotlib.pyplot as plt
 import numpy as np
 
+from design_procedures.calibration import get_calibration
+from design_procedures.component_stress import get_component_stress
+
+# Dynamic R_DS_ON (current collapse) model for the EPC2307 GaN FET. Off-state
+# drain stress traps charge that raises the on-resistance at the next turn on.
+# The trapped fraction grows with blocking voltage and logarithmically with the
+# off-time, and detraps faster at higher temperature.
+#
+#   R_DYN = R_DS_ON(T) * (1 + K * (V / V_REF)^A * F(T_OFF) * (1 - K_T (T - 25)))
+#   F     = ln(1 + T_OFF / TAU) / ln(1 + T_OFF_REF / TAU)
+#
+# The EPC2307 datasheet (docs/datasheets/EPC2307_datasheet.pdf) does not
+# characterize dynamic R_DS_ON, so K, A, TAU and K_T are NOT sourced: they are
+# placeholders that only set the shape of the model. Fit them to double pulse
+# measurements (R_DS_ON at turn on against the preceding V_DS and off-time)
+# before trusting the dynamic loss. Pass dynamic=False to
+# get_switch_losses_batch for the datasheet only model.
+dyn_r_k = 0.18  # Fractional R_DS_ON increase at v_ref, t_off_ref, 25 C
+dyn_r_v_ref = 100  # V
+dyn_r_v_exp = 2.0
+dyn_r_t_off_ref = 10e-6  # s
+dyn_r_tau = 1e-6  # s, trapping time constant
+dyn_r_k_t = 0.002  # 1/C, reduction of trapping with temperature
+r_ds_on_tc = 0.0065  # 1/C, static R_DS_ON temperature coefficient from 25 C
+
 
 def get_switch_requirements(max_v_out, max_i_in, max_p, sf=0.25, eff_dist=0.01):
     """_summary_
@@ -41,7 +66,8 @@ def get_switch_requirements(max_v_out, max_i_in, max_p, sf=0.25, eff_dist=0.01):
 
 def get_switch_losses(v_in, i_in, v_out, f_sw, r_ds_on, c_oss, r_l):
     """_summary_
-    Get switch losses (conduction, switching, total).
+    Get switch losses (conduction, switching, total). R_DS_ON and the C_OSS
+    switching energy are scaled by the calibrated correction factors.
 
     Args:
         v_in (float): Input voltage
@@ -58,28 +84,15 @@ def get_switch_losses(v_in, i_in, v_out, f_sw, r_ds_on, c_oss, r_l):
             Switching loss
             Total loss
     """
-    duty = 1 - v_in / v_out
     tau = c_oss * r_ds_on
+    calibration = get_calibration()
 
-    sw1_a = (2 * i_in * r_l * f_sw) / duty
-    sw1_b = i_in * (1 - r_l)
-
-    sw2_a = -(2 * i_in * r_l * f_sw) / (1 - duty)
-    sw2_b = i_in * (1 + (2 / (1 - duty) * r_l) - r_l)
-
-    i_sw1_rms = m.sqrt(
-        (sw1_a**2 * duty**3) / (3 * f_sw**2)
-        + (sw1_a * sw1_b * duty**2) / f_sw
-        + sw1_b**2 * duty
-    )
-    i_sw2_rms = m.sqrt(
-        (sw2_a**2 * (1 - duty) ** 3) / (3 * f_sw**2)
-        + (sw2_a * sw2_b * (1 - duty) ** 2) / f_sw
-        + sw2_b**2 * (1 - duty)
-    )
+    stress = get_component_stress(v_in, i_in, v_out, f_sw, 2 * i_in * r_l)
+    i_sw1_rms = stress["sw1"]["i_rms"]
+    i_sw2_rms = stress["sw2"]["i_rms"]
 
-    loss_con = (i_sw1_rms**2 + i_sw2_rms**2) * r_ds_on
-    loss_swi = (2 * v_out**2 * f_sw * tau) / r_ds_on
+    loss_con = (i_sw1_rms**2 + i_sw2_rms**2) * r_ds_on * calibration["k_r_ds_on"]
+    loss_swi = (2 * v_out**2 * f_sw * tau) / r_ds_on * calibration["k_e_oss"]
     loss_tot = loss_con + loss_swi
 
     return (loss_con, loss_swi, loss_tot)
@@ -87,7 +100,10 @@ def get_switch_losses(v_in, i_in, v_out, f_sw, r_ds_on, c_oss, r_l):
 
 def maximize_f_sw(v_in, i_in, v_out, r_ds_on, c_oss, p_sw_bud, r_l):
     """_summary_
-    Maximize possible switching frequency for a set of parameters.
+    Maximize possible switching frequency for a set of parameters. The
+    candidates rise from 1 Hz in 1 % steps up to 1 GHz and are evaluated in
+    one pass; the switch loss rises with F_SW, so the best candidate is the
+    one below the first over budget.
 
     Args:
         v_in (float): Input voltage
@@ -106,17 +122,20 @@ def maximize_f_sw(v_in, i_in, v_out, r_ds_on, c_oss, p_sw_bud, r_l):
             Total loss
     """
 
-    best_f_sw = 1
-    while True:
-        new_f_sw = best_f_sw * 1.01
-        p_conduction, p_switching, p_total = get_switch_losses(
-            v_in, i_in, v_out, new_f_sw, r_ds_on, c_oss, r_l
-        )
-        if p_total > p_sw_bud:
-            break
-        else:
-            best_f_sw = new_f_sw
-    return (best_f_sw, p_conduction, p_switching, p_total)
+    num = m.ceil(m.log(1e9) / m.log(1.01))
+    f_sw = np.cumprod(np.r_[1.0, np.full(num, 1.01)])
+    p_conduction, p_switching, p_total = (
+        np.broadcast_to(p, f_sw.shape)
+        for p in get_switch_losses(v_in, i_in, v_out, f_sw, r_ds_on, c_oss, r_l)
+    )
+    over = p_total[1:] > p_sw_bud
+    best = int(np.argmax(over)) if over.any() else num
+    return (
+        float(f_sw[best]),
+        float(p_conduction[best]),
+        float(p_switching[best]),
+        float(p_total[best]),
+    )
 
 
 def get_switch_op_fs(tau, operating_points, p_sw_bud, r_l):
@@ -279,3 +298,147 @@ def get_switch_duty_cycle_map(v_in_range, v_out_range, eff):
     max_duty = np.max(z_duty)
 
     return (min_duty, max_duty)
+
+
+def get_dynamic_r_ds_on(r_ds_on, v_block, t_off, t_j=25):
+    """_summary_
+    Get the dynamic on-resistance of a GaN switch after an off-state interval.
+
+    Args:
+        r_ds_on (float|np.ndarray): Datasheet R_DS_ON at 25 C
+        v_block (float|np.ndarray): Voltage blocked during the off-state
+        t_off (float|np.ndarray): Duration of the off-state
+        t_j (float|np.ndarray, optional): Junction temperature, in C.
+            Defaults to 25.
+
+    Returns:
+        float|np.ndarray: Effective R_DS_ON at the next on-state.
+    """
+    t_j = np.asarray(t_j, dtype=float)
+    r_static = r_ds_on * (1 + r_ds_on_tc * (t_j - 25))
+    f_t_off = np.log1p(np.asarray(t_off) / dyn_r_tau) / m.log1p(
+        dyn_r_t_off_ref / dyn_r_tau
+    )
+    f_temp = np.clip(1 - dyn_r_k_t * (t_j - 25), 0, None)
+    trap = dyn_r_k * (np.asarray(v_block) / dyn_r_v_ref) ** dyn_r_v_exp
+    return r_static * (1 + trap * f_t_off * f_temp)
+
+
+def get_switch_losses_batch(
+    v_in,
+    i_in,
+    v_out,
+    f_sw,
+    r_ds_on,
+    c_oss,
+    r_l,
+    t_j=25,
+    dynamic=True,
+    calibration=None,
+):
+    """_summary_
+    Vectorized form of get_switch_losses. All arguments broadcast against each
+    other, so a whole V_IN x V_OUT grid (or a set of candidate switches) is
+    evaluated in one call. Optionally includes the dynamic R_DS_ON of each
+    switch: SW1 blocks V_OUT for (1 - D) / F_SW before turning on, and SW2
+    blocks V_OUT for D / F_SW.
+
+    Args:
+        v_in (float|np.ndarray): Input voltage
+        i_in (float|np.ndarray): Input current
+        v_out (float|np.ndarray): Output voltage
+        f_sw (float|np.ndarray): Switching frequency
+        r_ds_on (float|np.ndarray): Switch on resistance between drain and
+            source, at 25 C
+        c_oss (float|np.ndarray): Switch output capacitance
+        r_l (float|np.ndarray): Inductor current ripple
+        t_j (float|np.ndarray, optional): Junction temperature, in C. Defaults
+            to 25.
+        dynamic (bool, optional): Whether to apply the dynamic R_DS_ON model.
+            Defaults to True.
+        calibration (dict, optional): Loss model parameters, see
+            calibration.default_calibration. Defaults to get_calibration().
+
+    Returns:
+        (np.ndarray, ...): Set of arrays consisting of:
+            Conduction loss
+            Switching loss
+            Total loss
+            Conduction loss attributable to dynamic R_DS_ON
+    """
+    v_in, i_in, v_out, f_sw = np.broadcast_arrays(
+        *[np.asarray(x, dtype=float) for x in (v_in, i_in, v_out, f_sw)]
+    )
+    duty = 1 - v_in / v_out
+    tau = c_oss * r_ds_on
+    if calibration is None:
+        calibration = get_calibration()
+    k_r = calibration["k_r_ds_on"]
+
+    stress = get_component_stress(v_in, i_in, v_out, f_sw, 2 * i_in * r_l)
+    i_sw1_rms_2 = stress["sw1"]["i_rms"] ** 2
+    i_sw2_rms_2 = stress["sw2"]["i_rms"] ** 2
+
+    r_static = r_ds_on * (1 + r_ds_on_tc * (np.asarray(t_j) - 25))
+    if dynamic:
+        r_sw1 = get_dynamic_r_ds_on(r_ds_on, v_out, (1 - duty) / f_sw, t_j)
+        r_sw2 = get_dynamic_r_ds_on(r_ds_on, v_out, duty / f_sw, t_j)
+    else:
+        r_sw1 = r_sw2 = r_static
+
+    loss_con = (i_sw1_rms_2 * r_sw1 + i_sw2_rms_2 * r_sw2) * k_r
+    loss_dyn = loss_con - (i_sw1_rms_2 + i_sw2_rms_2) * r_static * k_r
+    loss_swi = (2 * v_out**2 * f_sw * tau) / r_ds_on * calibration["k_e_oss"]
+    loss_tot = loss_con + loss_swi
+
+    return (loss_con, loss_swi, loss_tot, loss_dyn)
+
+
+def get_dynamic_r_ds_on_map(
+    v_in_range, v_out_range, f_sw, r_ds_on, c_oss, r_l, model, num_cells, t_j=25
+):
+    """_summary_
+    Generate a map across all operating points of the extra conduction loss
+    caused by dynamic R_DS_ON.
+
+    Args:
+        v_in_range ([float]]): Input voltage range in format [min, best, max]
+        v_out_range ([float]): Output voltage range in format [min, avg, max]
+        f_sw (float): Switching frequency
+        r_ds_on (float): Switch on resistance between drain and source
+        c_oss (float): Switch output capacitance
+        r_l (float): Inductor current ripple
+        model (func): Solar cell model
+        num_cells (int): Number of solar cells
+        t_j (float, optional): Junction temperature, in C. Defaults to 25.
+
+    Returns:
+        (float, float, float): Worst case extra conduction loss and the
+            (V_IN, V_OUT) it occurs at.
+    """
+    v_in_combos = np.linspace(v_in_range[0], v_in_range[2], num=35, endpoint=True)
+    v_out_combos = np.linspace(v_out_range[0], v_out_range[2], num=35, endpoint=True)
+    i_in_combos = np.array(
+        [model(1000, 298.15, 0, 100, v_in / num_cells) for v_in in v_in_combos]
+    )
+    v_in, v_out = np.meshgrid(v_in_combos, v_out_combos, indexing="ij")
+    i_in = np.broadcast_to(i_in_combos[:, None], v_in.shape)
+
+    _, _, _, loss_dyn = get_switch_losses_batch(
+        v_in, i_in, v_out, f_sw, r_ds_on, c_oss, r_l, t_j
+    )
+
+    fig = plt.figure()
+    ax = fig.add_subplot(projection="3d")
+    ax.scatter(v_in, v_out, loss_dyn, c=loss_dyn)
+    ax.set_title(f"Dynamic R_DS_ON Conduction Loss at T_J={t_j} C")
+    ax.set_xlabel("V_IN (V)")
+    ax.set_ylabel("V_OUT (V)")
+    ax.set_zlabel("Extra Loss (W)")
+
+    plt.tight_layout()
+    plt.savefig("dynamic_r_ds_on_map.png")
+    plt.show()
+
+    idx = np.unravel_index(np.argmax(loss_dyn), loss_dyn.shape)
+    return (loss_dyn[idx], v_in[idx], v_out[idx])
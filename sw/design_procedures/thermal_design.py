@@ -6,9 +6,17 @@
 @date       2023-03-02
 """
 
+import warnings
+
 import matplotlib.pyplot as plt
 import numpy as np
 
+from design_procedures.heatsink_design import (
+    get_base_area,
+    get_r_sa,
+    heatsink_catalogue,
+)
+
 # Assume via size are 0.4|0.2 mm,
 # Board insulator is FR4
 # Four layer board, all with copper pours
@@ -18,7 +26,56 @@ r_fr4 = 10  # C/W
 r_via = 83.3  # C/W/VIA
 r_fcu = 0.081  # C m^2/W
 r_bcu = 0.081  # C m^2/W
-r_epo = 7.14  # C m^2/W
+r_epo = 7.14e-5  # C m^2/W, 0.1 mm of 1.4 W/m/K thermal epoxy
+k_4_layer = 0.7  # Given 4 layer board, improve result by 30%
+
+
+def get_r_ja(area_fcu, area_bcu, r_jb, r_jc, r_sa, area_hs, num_vias):
+    """_summary_
+    Get the junction to ambient thermal resistance of a switch through the
+    board copper in parallel with a heatsink on the case. Arguments broadcast
+    against each other.
+
+    Args:
+        area_fcu (float|np.ndarray): Exposed top copper area, in m^2
+        area_bcu (float|np.ndarray): Exposed bottom copper area, in m^2
+        r_jb (float): Thermal resistance of the junction to board
+        r_jc (float): Thermal resistance of the junction to case
+        r_sa (float|np.ndarray): Thermal resistance from sink to ambient
+        area_hs (float|np.ndarray): Area of the heatsink, in m^2
+        num_vias (int): Number of vias
+
+    Returns:
+        float|np.ndarray: R_JA, in C/W, for a two layer board.
+    """
+    # Vias in parallel to each other
+    r_vias = r_via / num_vias
+
+    # FR4 in parallel to vias
+    r_a = (r_fr4 * r_vias) / (r_fr4 + r_vias)
+
+    # BCU is a function of exposed area
+    r_bcu_ = r_bcu / area_bcu
+
+    # BCU in series with A
+    r_b = r_bcu_ + r_a
+
+    # FCU is a function of exposed area
+    r_fcu_ = r_fcu / area_fcu
+
+    # FCU in parallel with B
+    r_c = (r_fcu_ * r_b) / (r_fcu_ + r_b)
+
+    # R_JB in series with C
+    r_jd = r_jb + r_c
+
+    # R_JH is a function of exposed area
+    r_jh = r_sa + r_jc + r_epo / area_hs
+
+    # HS in parallel with D
+    r_je = (r_jh * r_jd) / (r_jh + r_jd)
+
+    return r_je
 
 
 def get_switch_thermals(t_a, t_j, p_sw_bud, r_jb, r_jc, r_sa, area_hs, num_vias):
@@ -43,36 +100,6 @@ def get_switch_thermals(t_a, t_j, p_sw_bud, r_jb, r_jc, r_sa, area_hs, num_vias)
     # Maximum resistance to meet t_j heating
     target_r_ja = (t_j - t_a) / p_sw_bud
 
-    def get_r_ja(area_fcu, area_bcu, r_jb_, r_jc_, r_sa_, area_hs_, num_vias_):
-        # Vias in parallel to each other
-        r_vias = r_via / num_vias_
-
-        # FR4 in parallel to vias
-        r_a = (r_fr4 * r_vias) / (r_fr4 + r_vias)
-
-        # BCU is a function of exposed area
-        r_bcu_ = r_bcu / area_bcu
-
-        # BCU in series with A
-        r_b = r_bcu_ + r_a
-
-        # FCU is a function of exposed area
-        r_fcu_ = r_fcu / area_fcu
-
-        # FCU in parallel with B
-        r_c = (r_fcu_ * r_b) / (r_fcu_ + r_b)
-
-        # R_JB in series with C
-        r_jd = r_jb_ + r_c
-
-        # R_JH is a function of exposed area
-        r_jh = r_sa_ + r_jc_ + r_epo / area_hs_
-
-        # HS in parallel with D
-        r_je = (r_jh * r_jd) / (r_jh + r_jd)
-
-        return r_je
-
     # For a given area of top and bottom copper:
     x = []
     y = []
@@ -84,7 +111,7 @@ def get_switch_thermals(t_a, t_j, p_sw_bud, r_jb, r_jc, r_sa, area_hs, num_vias)
             expected_r_ja = get_r_ja(i, j, r_jb, r_jc, r_sa, area_hs, num_vias)
 
             # Given 4 layer board, improve result by 30%
-            expected_r_ja *= 0.7
+            expected_r_ja *= k_4_layer
 
             if expected_r_ja <= target_r_ja:
                 x.append(i)
@@ -106,3 +133,98 @@ def get_switch_thermals(t_a, t_j, p_sw_bud, r_jb, r_jc, r_sa, area_hs, num_vias)
     plt.show()
 
     return np.min(a)
+
+
+def get_heatsink_search(
+    t_a,
+    t_j,
+    p_sw_bud,
+    r_jb,
+    r_jc,
+    num_vias,
+    v_air=0.0,
+    orientation="horizontal_up",
+    catalogue=heatsink_catalogue,
+    dt_tol=0.05,
+    max_iter=20,
+):
+    """_summary_
+    Search the heatsink catalogue for the part needing the least board copper
+    to hold a switch at t_j. R_SA depends on the rise of the sink, which
+    depends on the share of the loss the heatsink carries, so each part is
+    iterated to a consistent sink temperature, warning about any part whose
+    sink rise still moves by more than dt_tol on the last pass.
+
+    Args:
+        t_a (float): Ambient temperature
+        t_j (float): Target temperature
+        p_sw_bud (float): The maximum power dissipation per switch
+        r_jb (float): Thermal resistance of the junction to board
+        r_jc (float): Thermal resistance of the junction to case
+        num_vias (int): Number of vias
+        v_air (float, optional): Air speed over the heatsink, in m/s.
+            Defaults to 0.0.
+        orientation (str, optional): See heatsink_design.orientation_factor.
+            Defaults to "horizontal_up".
+        catalogue (dict, optional): Heatsinks to search. Defaults to
+            heatsink_catalogue.
+        dt_tol (float, optional): Change of the sink rise that ends the
+            iteration, in K. Defaults to 0.05.
+        max_iter (int, optional): Most passes per heatsink. Defaults to 20.
+
+    Returns:
+        [dict]: Per heatsink, "name", "r_sa", "area_hs", "volume", and the
+            minimum board copper "area" (NaN when the target cannot be met)
+            with its "area_fcu", "area_bcu" and "r_ja", and whether the sink
+            rise "converged"; the smallest area first, then the smallest
+            heatsink.
+    """
+    target_r_ja = (t_j - t_a) / p_sw_bud
+    area = np.linspace(1e-5, 0.005, 100)
+    area_fcu, area_bcu = np.meshgrid(area, area, indexing="ij")
+    area_fcu, area_bcu = area_fcu.ravel(), area_bcu.ravel()
+
+    results = []
+    for name, heatsink in catalogue.items():
+        area_hs = get_base_area(heatsink)
+        dt = (t_j - t_a) / 2
+        for _ in range(max_iter):
+            r_sa = float(get_r_sa(heatsink, v_air, orientation, dt, t_a))
+            r_ja = (
+                get_r_ja(area_fcu, area_bcu, r_jb, r_jc, r_sa, area_hs, num_vias)
+                * k_4_layer
+            )
+            feasible = r_ja <= target_r_ja
+            total = np.where(feasible, area_fcu + area_bcu, np.inf)
+            best = np.argmin(total) if feasible.any() else len(total) - 1
+
+            # Share of the loss through the heatsink branch, at the best point.
+            r_jh = r_sa + r_jc + r_epo / area_hs
+            p_hs = p_sw_bud * r_ja[best] / k_4_layer / r_jh
+            dt, dt_prev = max(p_hs * r_sa, 1.0), dt
+            if abs(dt - dt_prev) < dt_tol:
+                break
+        converged = abs(dt - dt_prev) < dt_tol
+        if not converged:
+            warnings.warn(
+                f"{name}: sink rise still moved {abs(dt - dt_prev):.2f} K on "
+                f"pass {max_iter}"
+            )
+        results.append(
+            {
+                "name": name,
+                "r_sa": r_sa,
+                "area_hs": area_hs,
+                "volume": area_hs * (heatsink["t_b"] + heatsink["h"]),
+                "area": total[best] if feasible.any() else np.nan,
+                "area_fcu": area_fcu[best],
+                "area_bcu": area_bcu[best],
+                "r_ja": r_ja[best],
+                "converged": converged,
+            }
+        )
+
+    return sorted(
+        results,
+        key=lambda r: (np.inf if np.isnan(r["area"]) else r["area"], r["volume"]),
+    )
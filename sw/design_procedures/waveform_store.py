@@ -0,0 +1,351 @@
+"""_summary_
+@file       waveform_store.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Chunked, compressed store for simulated and measured waveforms.
+
+            Waveforms are indexed by (design ID, operating point, channel).
+            Each waveform is split into fixed size chunks that are compressed
+            independently, so reading a window only touches the chunks that
+            overlap it:
+
+            - Lossless: the float64 samples are delta encoded on their integer
+              representation, byte shuffled and deflated. Decoding is exact.
+            - Lossy: the samples are quantized to a step of 2 * TOL, delta and
+              zigzag encoded, byte shuffled and deflated. Every decoded sample
+              is within TOL of the original.
+
+            On disk a store is a directory holding:
+            - data.bin   - concatenated compressed chunks, memory mapped on read
+            - index.npy  - one record per waveform
+            - chunks.npy - (offset, length) of every chunk in data.bin
+@version    0.0.0
+@date       2026-10-18
+"""
+
+import mmap
+import os
+import zlib
+
+import numpy as np
+
+# Number of floats in the operating point key, e.g. [V_IN, I_IN, V_OUT, F_SW].
+NUM_OP = 4
+# Maximum characters in a design ID and a channel name.
+MAX_DESIGN_ID = 32
+MAX_CHANNEL = 16
+
+index_dtype = np.dtype(
+    [
+        ("design_id", f"U{MAX_DESIGN_ID}"),
+        ("op", "f8", (NUM_OP,)),
+        ("channel", f"U{MAX_CHANNEL}"),
+        ("t_0", "f8"),
+        ("dt", "f8"),
+        ("num_samples", "i8"),
+        ("tol", "f8"),  # 0 for lossless
+        ("chunk_size", "i8"),
+        ("chunk_start", "i8"),
+        ("chunk_count", "i8"),
+    ]
+)
+
+
+def encode_chunk(x, tol=0.0):
+    """_summary_
+    Compress a chunk of samples.
+
+    Args:
+        x (np.ndarray): Samples
+        tol (float, optional): Maximum absolute error. Defaults to 0.0
+            (lossless).
+
+    Returns:
+        bytes: Compressed chunk.
+    """
+    x = np.ascontiguousarray(x, dtype=np.float64)
+    if tol > 0:
+        q = np.round(x / (2 * tol)).astype(np.int64)
+        d = np.diff(q, prepend=np.int64(0))
+        u = ((d << 1) ^ (d >> 63)).view(np.uint64)
+    else:
+        u = np.diff(x.view(np.uint64), prepend=np.uint64(0))
+    shuffled = u.view(np.uint8).reshape(-1, 8).T.tobytes()
+    return zlib.compress(shuffled, 6)
+
+
+def decode_chunk(buf, num_samples, tol=0.0):
+    """_summary_
+    Decompress a chunk of samples.
+
+    Args:
+        buf (bytes|memoryview): Compressed chunk
+        num_samples (int): Number of samples in the chunk
+        tol (float, optional): Tolerance the chunk was encoded with. Defaults
+            to 0.0 (lossless).
+
+    Returns:
+        np.ndarray: Samples.
+    """
+    raw = np.frombuffer(zlib.decompress(buf), dtype=np.uint8)
+    u = raw.reshape(8, num_samples).T.copy().view(np.uint64).ravel()
+    if tol > 0:
+        d = (u >> np.uint64(1)).view(np.int64) ^ -(u & np.uint64(1)).view(np.int64)
+        return np.cumsum(d) * (2 * tol)
+    return np.cumsum(u, dtype=np.uint64).view(np.float64)
+
+
+def get_op_key(op):
+    """_summary_
+    Normalize an operating point into a hashable key.
+
+    Args:
+        op ([float]): Operating point, up to NUM_OP values
+
+    Returns:
+        tuple: Key, rounded so that equal points compare equal.
+    """
+    op_arr = np.full((1, NUM_OP), np.nan)
+    op_arr[0, : len(op)] = op
+    return get_op_keys(op_arr)[0]
+
+
+def get_op_keys(ops):
+    """_summary_
+    Normalize a batch of operating points into hashable keys. The index is
+    keyed through here both on put and on open, so the rounding always
+    matches.
+
+    Args:
+        ops (np.ndarray): Operating points, shape (n, NUM_OP), NaN padded
+
+    Returns:
+        [tuple]: Keys, rounded so that equal points compare equal.
+    """
+    ops = np.round(np.asarray(ops, dtype=np.float64), 6).tolist()
+    return [tuple(None if v != v else v for v in op) for op in ops]
+
+
+class WaveformStore:
+    """_summary_
+    A directory of compressed waveforms with random window access.
+
+    Example:
+        with WaveformStore("runs/pss", "a") as store:
+            store.put("rev_b", [v_in, i_in, v_out], "i_l", i_l, dt=1e-8)
+        with WaveformStore("runs/pss") as store:
+            i_l = store.get("rev_b", [v_in, i_in, v_out], "i_l", 100, 200)
+    """
+
+    def __init__(self, path, mode="r", chunk_size=4096):
+        """_summary_
+        Open or create a store.
+
+        Args:
+            path (str): Store directory
+            mode (str, optional): "r" to read, "a" to read and append.
+                Defaults to "r".
+            chunk_size (int, optional): Samples per chunk for new waveforms.
+                Defaults to 4096.
+        """
+        self.path = path
+        self.mode = mode
+        self.chunk_size = chunk_size
+        self._data_path = os.path.join(path, "data.bin")
+        self._index_path = os.path.join(path, "index.npy")
+        self._chunks_path = os.path.join(path, "chunks.npy")
+
+        if mode == "a":
+            os.makedirs(path, exist_ok=True)
+            open(self._data_path, "ab").close()
+
+        self._lookup = {}
+        if os.path.exists(self._index_path):
+            index = np.load(self._index_path)
+            self._index = list(index)
+            self._chunks = np.load(self._chunks_path)
+
+            # Build the keys column-wise; this dominates opening large stores.
+            ops = get_op_keys(index["op"])
+            keys = zip(index["design_id"].tolist(), ops, index["channel"].tolist())
+            self._lookup = {key: row for row, key in enumerate(keys)}
+        else:
+            self._index = []
+            self._chunks = np.zeros((0, 2), dtype=np.int64)
+        self._new_chunks = []
+
+        self._writer = open(self._data_path, "ab") if mode == "a" else None
+        self._map = None
+        self._map_size = 0
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __len__(self):
+        return len(self._index)
+
+    def keys(self):
+        """_summary_
+        Get the keys of all waveforms in the store.
+
+        Returns:
+            [(str, tuple, str)]: (design ID, operating point, channel).
+        """
+        return list(self._lookup.keys())
+
+    def put(self, design_id, op, channel, x, dt=1.0, t_0=0.0, tol=0.0):
+        """_summary_
+        Append a waveform. An existing waveform with the same key is replaced
+        in the index (its chunks stay in data.bin).
+
+        Args:
+            design_id (str): Design identifier
+            op ([float]): Operating point, up to NUM_OP values
+            channel (str): Channel name, e.g. "i_l" or "v_out"
+            x (np.ndarray): Samples
+            dt (float, optional): Sample period. Defaults to 1.0.
+            t_0 (float, optional): Time of the first sample. Defaults to 0.0.
+            tol (float, optional): Maximum absolute error for lossy storage.
+                Defaults to 0.0 (lossless).
+        """
+        if self._writer is None:
+            raise Exception("Store was opened read only.")
+        # The index holds fixed width strings, which numpy truncates silently.
+        if len(design_id) > MAX_DESIGN_ID:
+            raise Exception(f"Design ID is longer than {MAX_DESIGN_ID} characters.")
+        if len(channel) > MAX_CHANNEL:
+            raise Exception(f"Channel name is longer than {MAX_CHANNEL} characters.")
+        if len(op) > NUM_OP:
+            raise Exception(f"Operating point has more than {NUM_OP} values.")
+
+        x = np.asarray(x, dtype=np.float64).ravel()
+        offset = self._writer.tell()
+        chunk_start = len(self._chunks) + len(self._new_chunks)
+        for start in range(0, len(x), self.chunk_size):
+            buf = encode_chunk(x[start : start + self.chunk_size], tol)
+            self._writer.write(buf)
+            self._new_chunks.append((offset, len(buf)))
+            offset += len(buf)
+
+        op_arr = np.full(NUM_OP, np.nan)
+        op_arr[: len(op)] = op
+        rec = np.array(
+            (
+                design_id,
+                op_arr,
+                channel,
+                t_0,
+                dt,
+                len(x),
+                tol,
+                self.chunk_size,
+                chunk_start,
+                len(self._new_chunks) + len(self._chunks) - chunk_start,
+            ),
+            dtype=index_dtype,
+        )
+        key = (design_id, get_op_key(op), channel)
+        if key in self._lookup:
+            self._index[self._lookup[key]] = rec
+        else:
+            self._lookup[key] = len(self._index)
+            self._index.append(rec)
+
+    def get(self, design_id, op, channel, start=0, stop=None):
+        """_summary_
+        Read a window of a waveform, decompressing only the chunks it spans.
+
+        Args:
+            design_id (str): Design identifier
+            op ([float]): Operating point
+            channel (str): Channel name
+            start (int, optional): First sample. Defaults to 0.
+            stop (int, optional): One past the last sample. Defaults to the
+                end of the waveform.
+
+        Returns:
+            np.ndarray: Samples [start, stop).
+        """
+        rec = self._index[self._lookup[(design_id, get_op_key(op), channel)]]
+        num_samples = int(rec["num_samples"])
+        stop = num_samples if stop is None else min(stop, num_samples)
+        if stop <= start:
+            return np.zeros(0)
+
+        self._flush_chunks()
+        data = self._get_map()
+        chunk_size = int(rec["chunk_size"])
+        first = start // chunk_size
+        last = (stop - 1) // chunk_size
+        out = []
+        for k in range(first, last + 1):
+            offset, length = self._chunks[rec["chunk_start"] + k]
+            n = min(chunk_size, num_samples - k * chunk_size)
+            out.append(decode_chunk(data[offset : offset + length], n, rec["tol"]))
+        x = np.concatenate(out)
+        return x[start - first * chunk_size : stop - first * chunk_size]
+
+    def get_time(self, design_id, op, channel, start=0, stop=None):
+        """_summary_
+        Get the sample times of a window of a waveform.
+
+        Args:
+            design_id (str): Design identifier
+            op ([float]): Operating point
+            channel (str): Channel name
+            start (int, optional): First sample. Defaults to 0.
+            stop (int, optional): One past the last sample. Defaults to the
+                end of the waveform.
+
+        Returns:
+            np.ndarray: Sample times.
+        """
+        rec = self._index[self._lookup[(design_id, get_op_key(op), channel)]]
+        stop = int(rec["num_samples"]) if stop is None else stop
+        return rec["t_0"] + rec["dt"] * np.arange(start, stop)
+
+    def flush(self):
+        """_summary_
+        Write the index and chunk table to disk.
+        """
+        if self._writer is None:
+            return
+        self._writer.flush()
+        self._flush_chunks()
+        np.save(self._index_path, np.array(self._index, dtype=index_dtype))
+        np.save(self._chunks_path, self._chunks)
+
+    def close(self):
+        """_summary_
+        Flush and release file handles.
+        """
+        self.flush()
+        if self._writer is not None:
+            self._writer.close()
+            self._writer = None
+        if self._map is not None:
+            self._map.close()
+            self._map = None
+
+    def _flush_chunks(self):
+        if self._new_chunks:
+            new = np.array(self._new_chunks, dtype=np.int64).reshape(-1, 2)
+            self._chunks = np.concatenate([self._chunks, new])
+            self._new_chunks = []
+            if self._writer is not None:
+                self._writer.flush()
+
+    def _get_map(self):
+        size = os.path.getsize(self._data_path)
+        if size == 0:
+            # mmap rejects empty files; there are no chunks to read anyway.
+            return b""
+        if self._map is None or size != self._map_size:
+            if self._map is not None:
+                self._map.close()
+            with open(self._data_path, "rb") as f:
+                self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+            self._map_size = size
+        return self._map
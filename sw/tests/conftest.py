@@ -0,0 +1,16 @@
+"""_summary_
+@file       conftest.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the design procedures. Run from sw/ with
+            python -m pytest tests.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import os
+import sys
+
+import matplotlib
+
+matplotlib.use("Agg")
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), ".."))
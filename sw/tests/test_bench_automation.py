@@ -0,0 +1,47 @@
+"""_summary_
+@file       test_bench_automation.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the pipelined sweep settle detection.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+
+from design_procedures.bench_automation import (
+    get_simulated_bench,
+    i_mp_ratio,
+    min_dwell,
+    settle_tol,
+    v_mp_ratio,
+    wait_settled,
+)
+
+
+def get_running_bench(v_in, i_in, v_out, f_sw):
+    """_summary_
+    Get a simulated bench settled at an operating point.
+    """
+    bench = get_simulated_bench()
+    bench["load"].set_voltage(v_out)
+    bench["load"].set_input(True)
+    bench["sas"].set_curve(i_in / i_mp_ratio, v_in / v_mp_ratio, i_in, v_in)
+    bench["sas"].set_output(True)
+    bench["dut"].set_operating_point(v_in, f_sw)
+    bench["dut"].set_output(True)
+    bench["clock"].sleep(1.0)
+    return bench
+
+
+def test_output_voltage_only_change_is_waited_for():
+    bench = get_running_bench(50.0, 5.0, 85.0, 100e3)
+    bench["load"].set_voltage(125.0)
+    wait_settled(bench, 50.0, 5.0, 125.0)
+    v_out = bench["sim"].get_actual(np.array([bench["clock"].now()]))[0, 2]
+    assert abs(v_out - 125.0) < settle_tol[0]
+
+
+def test_switching_frequency_only_change_dwells():
+    bench = get_running_bench(50.0, 5.0, 85.0, 100e3)
+    bench["dut"].set_operating_point(50.0, 200e3)
+    assert wait_settled(bench, 50.0, 5.0, 85.0) >= min_dwell
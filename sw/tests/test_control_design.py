@@ -0,0 +1,28 @@
+"""_summary_
+@file       test_control_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the loop margins.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+
+from design_procedures.control_design import get_crossings, get_loop_margins
+
+
+def test_crossing_on_a_sample_counts_once():
+    # Integrator with |L| = 1 exactly at the third grid point.
+    w = np.array([0.25, 0.5, 1.0, 2.0, 4.0])
+    loop = 1 / (1j * w)
+    assert np.abs(loop[2]) == 1
+    assert get_crossings(np.abs(loop), 1).sum() == 1
+    pm, gm, num_cross = get_loop_margins(loop)
+    assert num_cross == 1
+    assert np.isclose(pm, 90)
+    assert np.isinf(gm)
+
+
+def test_crossings_between_samples():
+    x = np.array([[2.0, 0.5, 0.5, 2.0], [0.5, 1.0, 1.0, 0.5]])
+    assert get_crossings(x, 1).sum(axis=-1).tolist() == [2, 2]
@@ -0,0 +1,62 @@
+"""_summary_
+@file       test_converter_model.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the switched converter steady state.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+
+from design_procedures import calibration
+from design_procedures.converter_model import (
+    default_boost_design,
+    default_num_cells,
+    default_v_in_range,
+    default_v_out_range,
+    get_periodic_steady_state,
+    get_periodic_steady_state_map,
+    get_steady_state_cross_check_map,
+)
+from design_procedures.nonideal_model import model_nonideal_cell
+from design_procedures.switch_design import get_dynamic_r_ds_on
+
+
+def test_steady_state_reports_convergence():
+    design = dict(default_boost_design)
+    args = (design, 68.9, 5.84, 105.0, 1 - 68.9 / 105, 104e3, 111)
+    x, iterations, converged = get_periodic_steady_state(*args)
+    assert converged and iterations >= 1
+    x_0, iterations, converged = get_periodic_steady_state(*args, max_iter=0)
+    assert iterations == 0 and not converged
+    assert np.all(np.isfinite(x_0))
+
+
+def test_map_uses_the_corrected_duty_for_dynamic_r_ds_on():
+    design = dict(default_boost_design)
+    f_sw, t_j = 104e3, 100
+    v_in, i_in, v_out = np.array([30.0, 68.9]), 5.84, 125.0
+    pss = get_periodic_steady_state_map(
+        design, v_in, i_in, v_out, f_sw, 111, get_dynamic_r_ds_on, t_j, samples=16
+    )
+    duty = pss["duty"]
+    r_sw1 = get_dynamic_r_ds_on(design["r_ds_on"], v_out, (1 - duty) / f_sw, t_j)
+    r_sw2 = get_dynamic_r_ds_on(design["r_ds_on"], v_out, duty / f_sw, t_j)
+    p_cond = pss["i_sw1_rms"] ** 2 * r_sw1 + pss["i_sw2_rms"] ** 2 * r_sw2
+    assert np.allclose(pss["p_cond"], p_cond, rtol=1e-9)
+
+
+def test_cross_check_ignores_the_calibration(monkeypatch, tmp_path):
+    calibrated = dict(calibration.default_calibration, k_r_ds_on=1.35)
+    monkeypatch.setitem(calibration._cache, calibration.calibration_file, calibrated)
+    monkeypatch.chdir(tmp_path)
+    _, error = get_steady_state_cross_check_map(
+        default_boost_design,
+        default_v_in_range,
+        default_v_out_range,
+        default_boost_design["f_sw"],
+        model_nonideal_cell,
+        default_num_cells,
+        num=3,
+    )
+    assert np.abs(error["p_cond"]).max() < 0.05
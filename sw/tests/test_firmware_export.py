@@ -0,0 +1,19 @@
+"""_summary_
+@file       test_firmware_export.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the C header export.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+import pytest
+
+from design_procedures.firmware_export import get_c_literal
+
+
+def test_literal_refuses_non_finite_floats():
+    assert get_c_literal(np.float32(1.5)) == "1.5f"
+    for value in (np.nan, np.inf, -np.inf):
+        with pytest.raises(ValueError):
+            get_c_literal(value)
@@ -0,0 +1,56 @@
+"""_summary_
+@file       test_fixed_point_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the fixed point PI simulation.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+
+from design_procedures.fixed_point_design import (
+    get_counts_scale,
+    get_min_timer_clock,
+    simulate_fixed_point_loop,
+)
+
+
+def get_loops(b0):
+    """_summary_
+    Get a batch of loops around a static plant with a given B0.
+    """
+    batch = len(b0)
+    plant = (
+        np.ones((batch, 1, 1)) * 0.5,
+        np.zeros((batch, 1)),
+        np.zeros((batch, 1)),
+        np.zeros((batch, 1)),
+        np.zeros(batch, dtype=np.int64),
+    )
+    return dict(
+        plant=plant,
+        b0=np.asarray(b0, dtype=np.int64),
+        b1=np.zeros(batch, dtype=np.int64),
+        w=np.full(batch, 16),
+        f=np.full(batch, 4),
+        counts=100,
+        v_lsb=0.0244,
+        v_in_0=np.full(batch, 50.0),
+        duty_0=np.full(batch, 0.5),
+        r_step=1,
+        num_steps=4,
+        num_tail=2,
+    )
+
+
+def test_accumulator_overflow_is_flagged():
+    # B0 e leaves the 32 bit accumulator of a 16 bit word only for the
+    # second loop.
+    sim = simulate_fixed_point_loop(**get_loops([2**20, 2**31]))
+    assert np.array_equal(sim["overflow"], [False, True])
+
+
+def test_min_timer_clock_matches_one_adc_count():
+    f_clk = get_min_timer_clock(104e3, 125.0)
+    counts, v_lsb, _ = get_counts_scale(104e3, f_clk)
+    assert np.isclose(125.0 / counts, v_lsb, rtol=2e-3)
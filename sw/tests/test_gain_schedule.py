@@ -0,0 +1,68 @@
+"""_summary_
+@file       test_gain_schedule.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Check the firmware gain schedule lookup against its reference.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import math as m
+import os
+import shutil
+import subprocess
+
+import numpy as np
+import pytest
+
+from design_procedures.firmware_export import fw_include_dir
+from design_procedures.gain_schedule import export_gain_schedule, lookup_gain_schedule
+
+lookup_main = """#include <stdio.h>
+#include "gain_schedule_lookup.h"
+
+int main(void)
+{
+    long x, y;
+    while (scanf("%ld %ld", &x, &y) == 2) {
+        printf("%ld\\n", (long)gain_schedule_lookup((int32_t)x, (int32_t)y));
+    }
+    return 0;
+}
+"""
+
+
+@pytest.mark.skipif(shutil.which("cc") is None, reason="no C compiler")
+def test_lookup_matches_reference(tmp_path):
+    rng = np.random.default_rng(0)
+    schedule = {
+        "base_in": 705,
+        "base_out": 2321,
+        "shift_in": 6,
+        "shift_out": 7,
+        "b": rng.integers(-(2**15), 2**15, (5, 4)),
+        "frac": 21,
+        "counts": 769,
+        "w_t": 2 * m.pi * 50,
+    }
+    export_gain_schedule(schedule, str(tmp_path))
+    shutil.copy(os.path.join(fw_include_dir, "gain_schedule_lookup.h"), tmp_path)
+    (tmp_path / "main.c").write_text(lookup_main)
+    exe = str(tmp_path / "lookup")
+    subprocess.run(
+        ["cc", "-std=c11", "-Wall", "-Werror", "-o", exe, str(tmp_path / "main.c")],
+        check=True,
+    )
+
+    # Readings below, inside and past the table, including the breakpoints.
+    x = np.concatenate([rng.integers(-100, 1300, 500), 705 + 64 * np.arange(6)])
+    y = np.concatenate([rng.integers(2000, 3000, 500), 2321 + 128 * np.arange(6)])
+    out = subprocess.run(
+        [exe],
+        input="\n".join(f"{a} {b}" for a, b in zip(x, y)),
+        capture_output=True,
+        text=True,
+        check=True,
+    ).stdout
+    assert np.array_equal(
+        np.array(out.split(), dtype=np.int64), lookup_gain_schedule(schedule, x, y)
+    )
@@ -0,0 +1,39 @@
+"""_summary_
+@file       test_irradiance_model.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the synthetic irradiance stream.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+
+from design_procedures.irradiance_model import (
+    BROKEN,
+    CLEAR,
+    OVERCAST,
+    climate_classes,
+    edge_width,
+    get_episode,
+    stream_irradiance,
+)
+
+
+def test_episode_breakpoints_never_decrease():
+    rng = np.random.default_rng(0)
+    params = climate_classes["temperate"]
+    ramp = edge_width / params["wind"]
+    for regime in (CLEAR, BROKEN, OVERCAST):
+        # Dwells shorter and longer than the edge ramp.
+        for dwell in (0.1 * ramp, 0.5 * ramp, 2 * ramp, 3600.0):
+            times, values = get_episode(rng, params, regime, 100.0, 100.0 + dwell)
+            assert len(times) == len(values)
+            assert (np.diff(times) >= 0).all()
+            assert (times <= 100.0 + dwell).all()
+
+
+def test_stream_clear_sky_index_in_range():
+    for climate in climate_classes:
+        for chunk in stream_irradiance(climate, seed=4, duration=2 * 86400.0, dt=1.0):
+            assert (chunk["k"] > 0).all()
+            assert chunk["k"].max() <= 2
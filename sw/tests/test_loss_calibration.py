@@ -0,0 +1,58 @@
+"""_summary_
+@file       test_loss_calibration.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the loss model calibration.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+import pytest
+
+from design_procedures.calibration import default_calibration
+from design_procedures.converter_model import default_boost_design
+from design_procedures.loss_calibration import (
+    fit_loss_calibration,
+    get_core_reference_loss,
+    get_efficiency_residual,
+    get_loss_breakdown,
+    get_synthetic_points,
+)
+
+
+def test_residual_is_model_minus_measured():
+    points = {
+        "v_in": np.array([50.0]),
+        "i_in": np.array([4.0]),
+        "v_out": np.array([105.0]),
+        "f_sw": np.array([100e3]),
+        "p_in": np.array([200.0]),
+    }
+    design = default_boost_design
+    loss = get_loss_breakdown(design, 50.0, 4.0, 105.0, 100e3, default_calibration)[
+        "total"
+    ]
+    # The converter measures 1 W worse than the model.
+    points["p_out"] = points["p_in"] - loss - 1.0
+    residual = get_efficiency_residual(points, design, default_calibration)
+    assert np.allclose(residual, 1.0 / 200.0)
+
+
+def test_fit_recovers_core_loss_at_reference():
+    truth = dict(default_calibration, k_core=3.2, alpha=1.5, beta=2.7)
+    points = get_synthetic_points(truth)
+    params, errors, summary = fit_loss_calibration(points)
+    assert summary["identified"]
+    f_ref, b_ref = summary["f_ref"], summary["b_ref"]
+    fit = get_core_reference_loss(params, f_ref, b_ref)
+    true = get_core_reference_loss(truth, f_ref, b_ref)
+    assert abs(fit - true) < 3 * errors["k_core"] / params["k_core"] * fit
+
+
+def test_fit_flags_unidentified_calibration():
+    # A single switching frequency leaves the core loss exponents free.
+    points = get_synthetic_points(default_calibration, num=300)
+    points = {key: value[points["f_sw"] == 100e3] for key, value in points.items()}
+    with pytest.warns(UserWarning):
+        _, _, summary = fit_loss_calibration(points)
+    assert not summary["identified"]
@@ -0,0 +1,33 @@
+"""_summary_
+@file       test_mppt_tuning.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the perturb and observe tracker simulation.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+
+from design_procedures.control_design import v_step
+from design_procedures.mppt_tuning import simulate_mppt_batch
+
+
+def simulate(g, t):
+    profiles = np.full((1, 5000), float(g))
+    return simulate_mppt_batch(
+        profiles,
+        np.zeros(1, dtype=int),
+        np.array([v_step]),
+        np.array([10e-3]),
+        np.array([0.0]),
+        111,
+        t=t,
+        dt=2e-3,
+    )
+
+
+def test_tracks_at_low_irradiance():
+    # About 1.4 W at the MPP. The tracker starts at the array V_OC, where the
+    # power is flat at zero: it must neither stall at V_REF_MAX nor be walked
+    # to V_REF_MIN by a power floor.
+    assert simulate(5, 298.15)["efficiency"][0] > 0.9
@@ -0,0 +1,42 @@
+"""_summary_
+@file       test_passives_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the capacitor loss over the ripple spectrum.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+
+from design_procedures.capacitor_lifetime import (
+    capacitor_catalogue,
+    get_capacitor_ripple_esr,
+)
+from design_procedures.component_stress import get_component_stress
+from design_procedures.passives_design import fit_capacitor_esr, get_capacitor_loss
+
+
+def test_loss_broadcasts_temperature_per_point():
+    names = ["A759MS186M2CAAE090", "RA4505K100"]
+    models = np.array(
+        [fit_capacitor_esr(*zip(*capacitor_catalogue[n]["esr_curve"])) for n in names]
+    )
+    # Give the models a temperature coefficient so T matters.
+    models[:, 3] = [0.01, -0.002]
+    v_in = np.array([40.0, 55.0, 68.9])
+    spectrum = get_component_stress(v_in, 5.84, 105, 104e3, 2.75, num_harmonics=20)
+    spectrum = spectrum["co"]["i_spectrum"]
+    t = np.array([20.0, 60.0, 100.0])
+    loss = get_capacitor_loss(models, spectrum, 104e3, t, np.array([3, 1]))
+    assert loss.shape == (2, 3)
+    for k, model in enumerate(models):
+        single = get_capacitor_loss(model, spectrum, 104e3, t, [3, 1][k])
+        assert np.allclose(loss[k], single)
+
+
+def test_ripple_esr_weights_the_harmonics():
+    part = capacitor_catalogue["A759MS186M2CAAE090"]
+    spectrum = 1.0 / np.arange(1, 40) ** 2
+    esr = get_capacitor_ripple_esr(part, spectrum, 104e3)
+    # The fundamental dominates the ripple, so the ESR sits near ESR(F_SW).
+    assert abs(esr / part["esr"] - 1) < 0.2
@@ -0,0 +1,27 @@
+"""_summary_
+@file       test_shading_model.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the roadside object culling.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+
+from design_procedures.shading_model import get_array_layout, get_cell_irradiance
+
+
+def test_low_sun_shadow_of_a_distant_building_is_kept():
+    cells, normals = get_array_layout(12)
+    route = {"x": np.zeros(1), "y": np.zeros(1), "heading": np.zeros(1)}
+    # 30 m tall, 100 m east of the route, with the sun 10 deg above the
+    # east horizon: its shadow reaches 170 m.
+    building = (np.array([[100.0, -10.0, 0.0]]), np.array([[120.0, 10.0, 30.0]]))
+    azimuth, elevation = np.array([np.pi / 2]), np.radians([10.0])
+    dni, dhi = np.array([500.0]), np.array([50.0])
+    _, lit = get_cell_irradiance(
+        cells, normals, route, azimuth, elevation, dni, dhi, boxes=building
+    )
+    assert not lit.any()
+    _, lit = get_cell_irradiance(cells, normals, route, azimuth, elevation, dni, dhi)
+    assert lit.all()
@@ -0,0 +1,56 @@
+"""_summary_
+@file       test_startup_analysis.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the start-up simulation.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+import pytest
+
+from design_procedures.converter_model import default_boost_design
+from design_procedures.startup_analysis import (
+    design_soft_start,
+    get_duty_ramp,
+    simulate_startup_batch,
+)
+
+
+def test_ramp_reaches_its_end_despite_rounding():
+    # duty_0 + (duty_final - duty_0) rounds to a neighbour of duty_final.
+    duty_0, duty_final = 0.49463431890575354, 0.18310971660853467
+    duty, reached = get_duty_ramp(duty_0, duty_final, 1.0)
+    assert duty != duty_final
+    assert reached
+    _, reached = get_duty_ramp(duty_0, duty_final, 0.3)
+    assert not reached
+
+
+def test_every_ramp_reports_ready():
+    v_b = np.array([80, 107, 134.4])[:, None, None, None]
+    v_co_0 = v_b * np.array([0.0, 0.5, 0.95])[None, :, None, None]
+    g = np.array([100, 1000])[None, None, :, None]
+    ramp_rate = np.logspace(1.5, 4.5, 7)[None, None, None, :]
+    results = simulate_startup_batch(
+        dict(default_boost_design), v_b, v_co_0, g, 10, ramp_rate, 111
+    )
+    assert not np.isnan(results["t_ready"]).any()
+    # The ramp cannot finish before the duty distance over the rate.
+    t_ramp = np.abs(results["duty_final"] - results["duty_0"]) / ramp_rate
+    assert (results["t_ready"] - results["t_start"] >= t_ramp - 2e-6).all()
+
+
+def test_candidates_must_ascend():
+    with pytest.raises(Exception):
+        design_soft_start(
+            dict(default_boost_design),
+            [107],
+            [0.5],
+            [1000],
+            [22, 10],
+            [100],
+            111,
+            7,
+            20,
+        )
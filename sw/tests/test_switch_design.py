@@ -0,0 +1,55 @@
+"""_summary_
+@file       test_switch_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the batched switch loss model.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+
+from design_procedures.calibration import default_calibration
+from design_procedures.switch_design import (
+    get_switch_losses,
+    get_switch_losses_batch,
+)
+
+
+def test_batch_matches_scalar_losses_without_dynamic_r_ds_on():
+    v_in = np.array([20.3, 68.9, 74.5])
+    i_in, v_out, f_sw, r_ds_on, c_oss, r_l = 5.84, 105.0, 104e3, 3e-3, 1e-9, 0.1
+    batch = get_switch_losses_batch(
+        v_in, i_in, v_out, f_sw, r_ds_on, c_oss, r_l, dynamic=False
+    )
+    for k, v in enumerate(v_in):
+        scalar = get_switch_losses(v, i_in, v_out, f_sw, r_ds_on, c_oss, r_l)
+        assert np.allclose([x[k] for x in batch[:3]], scalar, rtol=1e-12)
+    assert np.allclose(batch[3], 0)
+
+
+def test_conduction_loss_matches_sampled_switch_currents():
+    v_in, i_in, v_out, f_sw, r_ds_on, r_l = 30.0, 5.84, 105.0, 104e3, 3e-3, 0.3
+    calibration = dict(default_calibration)
+    loss_con, _, _, _ = get_switch_losses_batch(
+        v_in,
+        i_in,
+        v_out,
+        f_sw,
+        r_ds_on,
+        1e-9,
+        r_l,
+        dynamic=False,
+        calibration=calibration,
+    )
+
+    # Sample the triangular inductor current over one period.
+    duty, i_l_pp = 1 - v_in / v_out, 2 * i_in * r_l
+    t = (np.arange(200000) + 0.5) / 200000
+    i_l = np.where(
+        t < duty,
+        i_in - i_l_pp / 2 + i_l_pp * t / duty,
+        i_in + i_l_pp / 2 - i_l_pp * (t - duty) / (1 - duty),
+    )
+    i_sw1_2 = np.mean(np.where(t < duty, i_l, 0) ** 2)
+    i_sw2_2 = np.mean(np.where(t < duty, 0, i_l) ** 2)
+    assert np.isclose(loss_con, (i_sw1_2 + i_sw2_2) * r_ds_on, rtol=1e-6)
@@ -0,0 +1,26 @@
+"""_summary_
+@file       test_thermal_design.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the heatsink search iteration.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import warnings
+
+import pytest
+
+from design_procedures.thermal_design import get_heatsink_search
+
+
+def test_heatsink_search_converges():
+    with warnings.catch_warnings():
+        warnings.simplefilter("error")
+        results = get_heatsink_search(60, 100, 1.0, 0.5, 0.3, 250)
+    assert all(r["converged"] for r in results)
+
+
+def test_heatsink_search_warns_when_cut_short():
+    with pytest.warns(UserWarning):
+        results = get_heatsink_search(60, 100, 1.0, 0.5, 0.3, 250, max_iter=1)
+    assert not all(r["converged"] for r in results)
@@ -0,0 +1,36 @@
+"""_summary_
+@file       test_waveform_store.py
+@author     Matthew Yu (matthewjkyu@gmail.com)
+@brief      Regression checks of the waveform store index.
+@version    0.0.0
+@date       2026-10-19
+"""
+
+import numpy as np
+import pytest
+
+from design_procedures.waveform_store import MAX_DESIGN_ID, WaveformStore
+
+
+def test_reopened_store_finds_points_that_round_differently(tmp_path):
+    # round(3.5e-6, 6) and np.round(3.5e-6, 6) disagree.
+    op = [68.9, 5.84, 3.5e-6]
+    x = np.linspace(0, 1, 1000)
+    with WaveformStore(tmp_path, "a") as store:
+        store.put("rev_b", op, "i_l", x)
+    with WaveformStore(tmp_path) as store:
+        assert np.array_equal(store.get("rev_b", op, "i_l"), x)
+
+
+def test_long_design_id_is_rejected(tmp_path):
+    with WaveformStore(tmp_path, "a") as store:
+        with pytest.raises(Exception):
+            store.put("x" * (MAX_DESIGN_ID + 1), [68.9], "i_l", np.zeros(8))
+
+
+def test_empty_data_file_reads(tmp_path):
+    with WaveformStore(tmp_path, "a") as store:
+        store.put("rev_b", [68.9], "i_l", np.zeros(0))
+    with WaveformStore(tmp_path) as store:
+        assert len(store.get("rev_b", [68.9], "i_l", 0, 1)) == 0
+        assert store._get_map() == b""